@@ -0,0 +1,107 @@
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "lexer.h"
+#include "PowerPCParser.h"
+
+// Replaces the global operator new and delete with counting versions and
+// checks that lexing and parsing make a fixed number of heap allocations per
+// file, however long it is: Lexer::tokenize() allocates its token vector,
+// and the parser, pulling tokens from a Lexer and handing instructions to a
+// sink, allocates only its tables. The generated files use the same eight
+// labels at every size, so the symbol table does not grow with them.
+
+namespace {
+
+size_t allocations = 0;
+
+void* allocate(size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+constexpr size_t LABELS = 8;
+
+const char* const BODY[] = {
+        "    addi r3, r3, 1",
+        "    lwz r4, 8(r1)",
+        "    add. r5, r3, r4   # sum",
+        "    stw r5, -12(r1)",
+        "    cmpwi cr1, r5, 0x100",
+        "    rlwinm r6, r5, 2, 0, 29",
+        "    ori r7, r7, 65535",
+};
+
+std::string generate(size_t lines) {
+    std::string text;
+    for (size_t line = 0; line < lines; line++) {
+        if (line < LABELS) {
+            text += "l" + std::to_string(line) + ":\n";
+        } else if (line % 8 == 0) {
+            text += "    bne cr1, l" + std::to_string(line / 8 % LABELS) + "\n";
+        } else {
+            text += BODY[line % 8 - 1];
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+template<typename F>
+size_t count(F&& f) {
+    const size_t before = allocations;
+    f();
+    return allocations - before;
+}
+
+}
+
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+
+
+int main() {
+    size_t expected[2] = {};
+    bool failed = false;
+    for (size_t lines : {10000, 100000, 1000000}) {
+        const std::string source = generate(lines);
+
+        const size_t tokenizing = count([&] {
+            Lexer lexer(source);
+            std::vector<Token> tokens = lexer.tokenize();
+        });
+
+        size_t instructions = 0;
+        size_t errors = 0;
+        const size_t parsing = count([&] {
+            Lexer lexer(source);
+            SymbolTable symbols;
+            DiagnosticBuffer diagnostics;
+            PowerPCParser parser(lexer, symbols, diagnostics);
+            parser.parse([&](const InstructionRecord&) { instructions++; });
+            errors = diagnostics.getErrorCount();
+        });
+
+        std::cout << lines << " lines, " << source.size() << " bytes: tokenize() " << tokenizing
+                  << " allocations, parse " << parsing << " allocations (" << instructions << " instructions, "
+                  << errors << " errors)" << std::endl;
+        if (expected[0] == 0) {
+            expected[0] = tokenizing;
+            expected[1] = parsing;
+        }
+        if (tokenizing != expected[0] || parsing != expected[1]) {
+            std::cout << "allocations grow with the input" << std::endl;
+            failed = true;
+        }
+        failed = failed || errors != 0;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstring>
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize == 0 ? DEFAULT_BLOCK_SIZE : blockSize) {}
+
+// Starts a new block; requests larger than a block get one of their own.
+void* Arena::allocateSlow(size_t size, size_t alignment) {
+    used += static_cast<size_t>(cursor - blockStart);
+    size_t capacity = std::max(blockSize, size + alignment);
+    blocks.push_back(std::make_unique<char[]>(capacity));
+    reserved += capacity;
+    blockStart = blocks.back().get();
+    cursor = blockStart;
+    limit = blockStart + capacity;
+    return allocate(size, alignment);
+}
+
+std::string_view Arena::copy(std::string_view text) {
+    if (text.empty()) return {};
+    char* storage = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(storage, text.data(), text.size());
+    return std::string_view(storage, text.size());
+}
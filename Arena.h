@@ -0,0 +1,71 @@
+#ifndef PPCASM_ARENA_H
+#define PPCASM_ARENA_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for data that lives as long as the file being assembled.
+// Memory comes from large blocks and is released all at once; objects
+// placed in it are never destroyed, so only trivially destructible types
+// belong here.
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+        if (size + padding > static_cast<size_t>(limit - cursor)) {
+            return allocateSlow(size, alignment);
+        }
+        char* result = cursor + padding;
+        cursor = result + size;
+        return result;
+    }
+
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    std::string_view copy(std::string_view text);
+
+    template <class T>
+    T* copy(const T* items, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "Arena copies are bytewise");
+        if (count == 0) return nullptr;
+        T* storage = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        std::memcpy(storage, items, count * sizeof(T));
+        return storage;
+    }
+
+    // Bytes handed out plus alignment padding, not counting unused block tails.
+    size_t bytesUsed() const { return used + static_cast<size_t>(cursor - blockStart); }
+    size_t bytesReserved() const { return reserved; }
+
+private:
+    void* allocateSlow(size_t size, size_t alignment);
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockSize;
+    char* blockStart = nullptr;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t used = 0;
+    size_t reserved = 0;
+};
+
+
+#endif //PPCASM_ARENA_H
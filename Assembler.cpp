@@ -0,0 +1,132 @@
+#include "Assembler.h"
+#include <cstring>
+#include "PowerPCParser.h"
+
+using FieldKind = PowerPCInstruction::Encoding::FieldKind;
+
+
+size_t Assembler::assemble(const std::vector<Token>& tokens, std::string_view source) {
+    TokenVector replay(tokens, source);
+    return assemble(replay);
+}
+
+
+// Without the peephole stage each instruction is encoded before the next one
+// is parsed, so the parser needs no arena and memory use is the output plus
+// the symbol table.
+size_t Assembler::assemble(TokenSource& tokens) {
+    const size_t errorsBefore = diagnostics.getErrorCount();
+    PowerPCParser parser(tokens, symbols, diagnostics, &sections);
+
+    if (peephole) {
+        assembleWhole(parser);
+    } else {
+        InstructionRecord record{};
+        while (parser.next(record)) {
+            emit(record);
+        }
+    }
+    resolve();
+
+    return diagnostics.getErrorCount() - errorsBefore;
+}
+
+
+// Collects the records with their addresses, then either runs the peephole
+// pass and emits what is left or, if the parser put data in .text, emits
+// every record back into the gap it left between the data.
+void Assembler::assembleWhole(PowerPCParser& parser) {
+    SectionBuffer& text = sections[SectionId::Text];
+    const size_t textBefore = text.size();
+    std::vector<InstructionRecord> records;
+    std::vector<uint32_t> addresses;
+    InstructionRecord record{};
+    while (parser.next(record)) {
+        records.push_back(record);
+        addresses.push_back(parser.getAddress() - 4);
+    }
+
+    if (text.size() == textBefore) {
+        peepholeStats = PeepholeOptimizer(symbols).run(records);
+        for (const InstructionRecord& r : records) emit(r);
+        return;
+    }
+
+    // `written` holds everything but the instructions, in order.
+    peepholeStats = PeepholeStats{};
+    peepholeStats.skipped = true;
+    SectionBuffer written = std::move(text);
+    text = SectionBuffer();
+    size_t taken = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        const size_t gap = textBefore + addresses[i] - text.size();
+        if (gap != 0) text.append(written.data() + taken, gap);
+        taken += gap;
+        emit(records[i]);
+    }
+    if (taken < written.size()) text.append(written.data() + taken, written.size() - taken);
+}
+
+
+// Words come from the parser already encoded; only label operands are left,
+// with their addend in the branch field. A word that did not encode is
+// zero but still takes its slot, so that later labels match the code.
+// Labels in .data are left to the linker.
+void Assembler::emit(const InstructionRecord& record) {
+    SectionBuffer& text = sections[SectionId::Text];
+    const uint32_t address = static_cast<uint32_t>(text.size());
+    uint32_t word = record.word;
+    if (record.symbol != SymbolTable::NONE && (record.flags & RECORD_INVALID) == 0) {
+        const auto& fields = record.definition().encoding.fields;
+        size_t index = 0;
+        while (fields[index].kind != FieldKind::BranchOffset) index++;
+
+        const Symbol& target = symbols.at(record.symbol);
+        const bool absolute = (record.flags & RECORD_AA) != 0;
+        const int32_t addend = PowerPCEncoder::readOperand(fields[index], word);
+        word &= ~fields[index].mask;
+        if (target.defined && target.section == SectionId::Text) {
+            const auto value = static_cast<int32_t>(target.address + addend - (absolute ? 0 : address));
+            if (PowerPCEncoder::fits(fields[index], value)) {
+                word |= PowerPCEncoder::placeOperand(fields[index], value);
+            } else {
+                diagnostics.report(diagnosticAtLine(DiagnosticCode::OperandOutOfRange, record.line, value, 0, 0,
+                                                    fields[index].name));
+                word = 0;
+            }
+        } else {
+            fixups.push_back(Fixup{address, record.symbol, addend, record.line, &fields[index], absolute});
+        }
+    }
+
+    encoder.store(word, text.extend(4));
+}
+
+
+// Second pass: patches forward branches now that every label has an address.
+void Assembler::resolve() {
+    for (const Fixup& fixup : fixups) {
+        const Symbol& target = symbols.at(fixup.symbol);
+        if (!target.defined || target.section != SectionId::Text) {
+            unresolved.push_back(fixup);
+            continue;
+        }
+        const auto value = static_cast<int32_t>(target.address + fixup.addend - (fixup.absolute ? 0 : fixup.offset));
+        if (!PowerPCEncoder::fits(*fixup.field, value)) {
+            diagnostics.report(diagnosticAtLine(DiagnosticCode::OperandOutOfRange, fixup.line, value, 0, 0,
+                                                fixup.field->name));
+            continue;
+        }
+        patch(fixup, value);
+    }
+    fixups.clear();
+}
+
+
+void Assembler::patch(const Fixup& fixup, int32_t value) {
+    uint8_t* at = sections[SectionId::Text].data() + fixup.offset;
+    uint32_t word;
+    std::memcpy(&word, at, sizeof(word));
+    word = encoder.toTarget(word) | PowerPCEncoder::placeOperand(*fixup.field, value);
+    encoder.store(word, at);
+}
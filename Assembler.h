@@ -0,0 +1,89 @@
+#ifndef PPCASM_ASSEMBLER_H
+#define PPCASM_ASSEMBLER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "token.h"
+#include "TokenSource.h"
+#include "PowerPCInstruction.h"
+#include "InstructionRecord.h"
+#include "PowerPCEncoder.h"
+#include "Sections.h"
+#include "SymbolTable.h"
+#include "Diagnostics.h"
+#include "PeepholeOptimizer.h"
+
+
+class PowerPCParser;
+
+
+// A branch whose target label was not yet defined when it was encoded. The
+// word at `offset` holds zero in the target field until resolve() patches it.
+struct Fixup {
+    uint32_t offset;
+    uint32_t symbol;
+    int32_t addend;
+    uint32_t line;
+    const PowerPCInstruction::Encoding::Field* field;
+    bool absolute;
+};
+
+
+// Assembles a token stream into .text and .data. Instructions are encoded
+// as the parser produces them: branches to labels defined earlier are
+// resolved on the spot and the others are recorded as fixups, so the second
+// pass only visits the fixups instead of the whole program. Data directives
+// are stored by the parser itself.
+//
+// With the peephole stage on, .text is parsed whole before anything is
+// encoded, since a removed instruction moves every label after it; see
+// PeepholeOptimizer.h. The stage steps aside when .text holds data or
+// padding, whose offsets the parser has already fixed.
+class Assembler {
+public:
+    explicit Assembler(Endian endian = Endian::Big) : encoder(endian), sections(endian) {}
+
+    Assembler(const Assembler&) = delete;
+    Assembler& operator=(const Assembler&) = delete;
+
+    // Returns the number of errors; they and any warnings are collected in
+    // getDiagnostics().
+    size_t assemble(TokenSource& tokens);
+    size_t assemble(const std::vector<Token>& tokens, std::string_view source);
+
+    void setPeephole(bool enabled) { peephole = enabled; }
+    const PeepholeStats& getPeepholeStats() const { return peepholeStats; }
+
+    Endian getEndian() const { return encoder.getEndian(); }
+    // Machine code, and any data placed in .text, in target byte order.
+    const SectionBuffer& code() const { return sections[SectionId::Text]; }
+    const SectionBuffer& data() const { return sections[SectionId::Data]; }
+    const SymbolTable& getSymbols() const { return symbols; }
+    const DiagnosticBuffer& getDiagnostics() const { return diagnostics; }
+    // Branches to labels never defined in this source or defined outside
+    // .text, for the object writer to turn into relocations.
+    const std::vector<Fixup>& getUnresolved() const { return unresolved; }
+    // .long and .quad values naming a symbol, which always need relocations.
+    const std::vector<DataRelocation>& getDataRelocations() const { return sections.getRelocations(); }
+
+private:
+    void assembleWhole(PowerPCParser& parser);
+    void emit(const InstructionRecord& record);
+    void resolve();
+    void patch(const Fixup& fixup, int32_t value);
+
+    PowerPCEncoder encoder;
+    SymbolTable symbols;
+    DiagnosticBuffer diagnostics;
+    Sections sections;
+    std::vector<Fixup> fixups;
+    std::vector<Fixup> unresolved;
+    bool peephole = false;
+    PeepholeStats peepholeStats;
+};
+
+
+#endif //PPCASM_ASSEMBLER_H
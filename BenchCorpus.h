@@ -0,0 +1,104 @@
+#ifndef PPCASM_BENCHCORPUS_H
+#define PPCASM_BENCHCORPUS_H
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+
+// What the benchmark drivers share: generated assembly, the same text for
+// the same arguments since the generator is always seeded alike, and
+// timing.
+namespace bench {
+
+inline constexpr int RUNS = 5;
+
+// Seconds since `start`.
+inline double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// How long one call of `f` takes.
+template<typename F>
+double seconds(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return seconds(start);
+}
+
+template<typename F>
+double microseconds(F&& f) {
+    return seconds(f) * 1e6;
+}
+
+// The fastest of `runs` calls of `f`, in seconds.
+template<typename F>
+double best(F&& f, int runs = RUNS) {
+    double fastest = 0;
+    for (int run = 0; run < runs; run++) {
+        const double time = seconds(f);
+        fastest = run == 0 ? time : std::min(fastest, time);
+    }
+    return fastest;
+}
+
+// Lines that lex and parse cleanly, some with a trailing comment.
+inline constexpr const char* LINES[] = {
+        "    addi r3, r3, 1",
+        "    lwz r4, 8(r1)            # reload",
+        "    add. r5, r3, r4",
+        "    stw r5, -12(r1)",
+        "    cmpwi cr1, r5, 0x100",
+        "    rlwinm r6, r5, 2, 0, 29   # scale",
+        "    bne cr1, loop",
+        "    xor r7, r7, r6",
+};
+
+inline constexpr size_t LABEL_EVERY = 40;
+
+// Line i is the label "loopI:" when `labelEvery` divides i (never if it is
+// 0) and pick(rng) otherwise. Stops after `lines` lines or once the text
+// holds `bytes` bytes, whichever comes first.
+template<typename Pick>
+std::string generate(size_t lines, size_t bytes, size_t labelEvery, Pick&& pick) {
+    std::mt19937 rng(42);
+    std::string text;
+    for (size_t line = 0; line < lines && text.size() < bytes; line++) {
+        if (labelEvery != 0 && line % labelEvery == 0) {
+            text += "loop" + std::to_string(line) + ":\n";
+        } else {
+            text += pick(rng);
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+// About `bytes` bytes of lines drawn from `lines`.
+template<size_t N>
+std::string generateBytes(size_t bytes, const char* const (&lines)[N], size_t labelEvery = LABEL_EVERY) {
+    return generate(SIZE_MAX, bytes, labelEvery, [&](std::mt19937& rng) { return lines[rng() % N]; });
+}
+
+inline std::string generateBytes(size_t bytes) {
+    return generateBytes(bytes, LINES);
+}
+
+// `count` lines, labels included, drawn from `lines`.
+template<size_t N>
+std::string generateLines(size_t count, const char* const (&lines)[N], size_t labelEvery = LABEL_EVERY) {
+    return generate(count, SIZE_MAX, labelEvery, [&](std::mt19937& rng) { return lines[rng() % N]; });
+}
+
+inline std::string generateLines(size_t count) {
+    return generateLines(count, LINES);
+}
+
+}
+
+
+#endif //PPCASM_BENCHCORPUS_H
@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "BenchCorpus.h"
+#include "MappedFile.h"
+#include "PowerPCDecoder.h"
+#include "PowerPCEncoder.h"
+
+// Measures the decoder in millions of instructions per second: identify()
+// alone, decode() into a ParsedInstruction, and decodeAll() over a whole
+// block of code. The code is the big-endian .text image named by the
+// argument, or 8M random words the decoder accepts. Every decoded word is
+// also encoded again and checked against the original.
+
+namespace {
+
+std::vector<uint32_t> generate(size_t count) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> words;
+    words.reserve(count);
+    ParsedInstruction parsed;
+    while (words.size() < count) {
+        const uint32_t word = static_cast<uint32_t>(rng());
+        if (PowerPCDecoder::decode(word, parsed)) words.push_back(word);
+    }
+    return words;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    const PowerPCDecoder decoder(Endian::Big);
+    const PowerPCEncoder encoder(Endian::Big);
+
+    MappedFile file;
+    std::vector<uint32_t> words;
+    if (argc > 1) {
+        try {
+            file = MappedFile(argv[1]);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        const std::string_view image = file.view();
+        words.resize(image.size() / 4);
+        for (size_t i = 0; i < words.size(); i++) {
+            words[i] = decoder.load(reinterpret_cast<const uint8_t*>(image.data()) + i * 4);
+        }
+    } else {
+        words = generate(8 << 20);
+    }
+    const size_t count = words.size();
+    if (count == 0) return 0;
+
+    size_t known = 0;
+    const double identifyTime = bench::best([&] {
+        known = 0;
+        for (uint32_t word : words) known += PowerPCDecoder::identify(word) != nullptr;
+    });
+
+    size_t valid = 0;
+    bool roundTrip = true;
+    ParsedInstruction parsed;
+    const double decodeTime = bench::best([&] {
+        valid = 0;
+        for (uint32_t word : words) valid += PowerPCDecoder::decode(word, parsed);
+    });
+    for (uint32_t word : words) {
+        if (PowerPCDecoder::decode(word, parsed) && encoder.encode(parsed) != word) roundTrip = false;
+    }
+
+    // decodeAll() takes the code in target byte order.
+    std::vector<uint8_t> image(count * 4);
+    for (size_t i = 0; i < count; i++) encoder.store(words[i], image.data() + i * 4);
+    const std::string_view code(reinterpret_cast<const char*>(image.data()), image.size());
+    std::vector<ParsedInstruction> out;
+    out.reserve(count);
+    size_t invalid = 0;
+    const double decodeAllTime = bench::best([&] {
+        out.clear();
+        invalid = decoder.decodeAll(code, out);
+    });
+
+    std::cout << count << " words, " << known << " known, " << valid << " valid" << std::endl;
+    std::cout << "identify():  " << count / identifyTime / 1e6 << " Minstr/s" << std::endl;
+    std::cout << "decode():    " << count / decodeTime / 1e6 << " Minstr/s" << std::endl;
+    std::cout << "decodeAll(): " << count / decodeAllTime / 1e6 << " Minstr/s, " << invalid << " invalid" << std::endl;
+    if (!roundTrip) std::cout << "some words do not encode back to themselves" << std::endl;
+    return roundTrip && invalid == count - valid ? 0 : 1;
+}
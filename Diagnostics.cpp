@@ -0,0 +1,76 @@
+#include "Diagnostics.h"
+#include "PowerPCOperand.h"
+
+Diagnostic diagnosticAt(DiagnosticCode code, const Token& token, int32_t arg0, int32_t arg1, int32_t arg2,
+                        std::string_view detail) {
+    return Diagnostic{code, Severity::Error, static_cast<uint16_t>(token.getColumn()),
+                      static_cast<uint16_t>(token.getLength()), static_cast<uint32_t>(token.getLine()),
+                      static_cast<uint32_t>(token.getOffset()), arg0, arg1, arg2, detail};
+}
+
+Diagnostic diagnosticAtLine(DiagnosticCode code, uint32_t line, int32_t arg0, int32_t arg1, int32_t arg2,
+                            std::string_view detail) {
+    return Diagnostic{code, Severity::Error, 0, 0, line, 0, arg0, arg1, arg2, detail};
+}
+
+
+static const char* kindName(int32_t kind) {
+    return operandKindName(static_cast<OperandKind>(kind));
+}
+
+std::string describe(const Diagnostic& d) {
+    switch (d.code) {
+        case DiagnosticCode::UnknownToken:
+            return "Unknown token";
+        case DiagnosticCode::ExpectedEndOfLine:
+            return "Expected end of line";
+        case DiagnosticCode::UnsupportedForm:
+            return "Unsupported form: " + std::string(d.detail);
+        case DiagnosticCode::TooManyOperands:
+            return "Too many operands";
+        case DiagnosticCode::ExpectedOperand:
+            return "Expected operand";
+        case DiagnosticCode::ExpectedNumber:
+            return "Expected number";
+        case DiagnosticCode::NumberOutOfRange:
+            return "Number out of range";
+        case DiagnosticCode::ExpectedBaseRegister:
+            return "Expected base register in displacement";
+        case DiagnosticCode::ExpectedRightParen:
+            return "Expected ')' after base register";
+        case DiagnosticCode::OperandCount:
+            return "Expected " + std::to_string(d.arg0) + " operands, got " + std::to_string(d.arg1);
+        case DiagnosticCode::OperandKind:
+            return "Expected " + std::string(kindName(d.arg1)) + " as operand " + std::to_string(d.arg0 + 1) +
+                   ", got " + kindName(d.arg2);
+        case DiagnosticCode::OperandOutOfRange:
+            if (d.detail.empty()) return "Operand " + std::to_string(static_cast<uint32_t>(d.arg0)) + " out of range";
+            return "Operand " + std::to_string(d.arg0) + " out of range for field " + std::string(d.detail);
+        case DiagnosticCode::DuplicateSymbol:
+            return "Symbol '" + std::string(d.detail) + "' already defined at line " + std::to_string(d.arg0);
+        case DiagnosticCode::UnknownDirective:
+            return "Unknown directive";
+        case DiagnosticCode::UnknownSection:
+            return "Unknown section";
+        case DiagnosticCode::ExpectedSymbol:
+            return "Expected symbol name";
+        case DiagnosticCode::BadAlignment:
+            return "Bad alignment " + std::to_string(d.arg0) + ": must give a power of two up to 65536";
+        case DiagnosticCode::InstructionOutsideText:
+            return "Instruction outside .text";
+        case DiagnosticCode::BadOctalDigit:
+            return "Digit 8 or 9 in octal number";
+    }
+    return "Unknown error";
+}
+
+
+void DiagnosticBuffer::print(std::ostream& os) const {
+    for (const Diagnostic& d : records) {
+        os << (d.severity == Severity::Error ? "Error" : "Warning") << " at line " << d.line << ": "
+           << describe(d) << '\n';
+    }
+    if (dropped > 0) {
+        os << dropped << " more diagnostics not shown\n";
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef PPCASM_DIAGNOSTICS_H
+#define PPCASM_DIAGNOSTICS_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "token.h"
+
+
+enum class DiagnosticCode : uint8_t {
+    UnknownToken,
+    ExpectedEndOfLine,
+    UnsupportedForm,
+    TooManyOperands,
+    ExpectedOperand,
+    ExpectedNumber,
+    NumberOutOfRange,
+    ExpectedBaseRegister,
+    ExpectedRightParen,
+    OperandCount,           // arg0 expected, arg1 written
+    OperandKind,            // arg0 operand index, arg1 expected kind, arg2 written kind
+    OperandOutOfRange,      // arg0 value, detail the field
+    DuplicateSymbol,        // arg0 line of the first definition, detail the name
+    UnknownDirective,
+    UnknownSection,
+    ExpectedSymbol,
+    BadAlignment,           // arg0 the alignment asked for
+    InstructionOutsideText,
+    BadOctalDigit,
+};
+
+enum class Severity : uint8_t {
+    Warning,
+    Error
+};
+
+
+// A problem found in the source, kept as plain data: the message is only
+// built by describe() when someone prints it. The span is the offending
+// token, or zero-length when only the line is known. `detail` points into
+// the keyword or instruction tables or the symbol table, never into the
+// source, which a streaming lexer does not keep.
+struct Diagnostic {
+    DiagnosticCode code;
+    Severity severity;
+    uint16_t column;
+    uint16_t length;
+    uint32_t line;
+    uint32_t offset;
+    int32_t arg0;
+    int32_t arg1;
+    int32_t arg2;
+    std::string_view detail;
+};
+
+Diagnostic diagnosticAt(DiagnosticCode code, const Token& token, int32_t arg0 = 0, int32_t arg1 = 0,
+                        int32_t arg2 = 0, std::string_view detail = {});
+Diagnostic diagnosticAtLine(DiagnosticCode code, uint32_t line, int32_t arg0 = 0, int32_t arg1 = 0,
+                            int32_t arg2 = 0, std::string_view detail = {});
+
+std::string describe(const Diagnostic& diagnostic);
+
+
+// Fixed-capacity store for diagnostics. Records past the capacity are
+// counted but not kept, so a file with an error on every line costs no more
+// memory than the first `capacity` of them.
+class DiagnosticBuffer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit DiagnosticBuffer(size_t capacity = DEFAULT_CAPACITY) : capacity(capacity) {
+        records.reserve(capacity);
+    }
+
+    void report(const Diagnostic& diagnostic) {
+        if (diagnostic.severity == Severity::Error) errors++;
+        if (records.size() < capacity) {
+            records.push_back(diagnostic);
+        } else {
+            dropped++;
+        }
+    }
+
+    void clear() {
+        records.clear();
+        errors = 0;
+        dropped = 0;
+    }
+
+    const std::vector<Diagnostic>& getRecords() const { return records; }
+    size_t getErrorCount() const { return errors; }
+    size_t getDroppedCount() const { return dropped; }
+
+    // One "Error at line N: ..." line per kept record, then a count of the
+    // dropped ones.
+    void print(std::ostream& os) const;
+
+private:
+    std::vector<Diagnostic> records;
+    size_t capacity;
+    size_t errors = 0;
+    size_t dropped = 0;
+};
+
+
+// Error half of an Expected.
+struct Unexpected {
+    Diagnostic diagnostic;
+};
+
+// Value or diagnostic, after std::expected (C++23). Only meant for the small
+// trivially copyable results of the parser, which share storage with the
+// diagnostic.
+template <class T>
+class Expected {
+    static_assert(std::is_trivially_copyable_v<T>, "Expected holds plain data only");
+
+public:
+    Expected(const T& value) : ok(true), value(value) {}
+    Expected(const Unexpected& unexpected) : ok(false), diagnostic(unexpected.diagnostic) {}
+
+    bool has_value() const { return ok; }
+    // Failures are the rare path; keep the checks out of the hot code.
+    explicit operator bool() const { return __builtin_expect(ok, true); }
+    const T& operator*() const { return value; }
+    const T* operator->() const { return &value; }
+    const Diagnostic& error() const { return diagnostic; }
+
+private:
+    bool ok;
+    union {
+        T value;
+        Diagnostic diagnostic;
+    };
+};
+
+template <>
+class Expected<void> {
+public:
+    Expected() : ok(true), diagnostic() {}
+    Expected(const Unexpected& unexpected) : ok(false), diagnostic(unexpected.diagnostic) {}
+
+    bool has_value() const { return ok; }
+    explicit operator bool() const { return __builtin_expect(ok, true); }
+    const Diagnostic& error() const { return diagnostic; }
+
+private:
+    bool ok;
+    Diagnostic diagnostic;
+};
+
+
+#endif //PPCASM_DIAGNOSTICS_H
@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include "BenchCorpus.h"
+#include "lexer.h"
+#include "PowerPCParser.h"
+
+// Times lexing and parsing 300k generated lines (the optional argument
+// changes the count) with 0%, 1% and 20% of them malformed, to show that
+// bad lines cost about as much as good ones now that errors are recorded
+// as Diagnostic records instead of thrown. The bad lines cover operand
+// kind and count errors, an out-of-range value, a stray character and a
+// missing parenthesis.
+
+namespace {
+
+const char* const BAD[] = {
+        "    add r3, r4, 5",
+        "    ori r3, r3, -1",
+        "    stw r3, r1",
+        "    addi r3, r3",
+        "    addi r3, r3, 1, 2",
+        "    lwz r4, 8(r1",
+        "    li r3, 0x10000",
+        "    addi r3, @, 1",
+};
+
+// bench::LINES with `badPercent` of the lines replaced by BAD ones.
+std::string generate(size_t lines, unsigned badPercent) {
+    return bench::generate(lines, SIZE_MAX, bench::LABEL_EVERY, [&](std::mt19937& rng) {
+        return rng() % 100 < badPercent ? BAD[rng() % std::size(BAD)] : bench::LINES[rng() % std::size(bench::LINES)];
+    });
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    const size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 300000;
+
+    for (unsigned badPercent : {0, 1, 20}) {
+        const std::string source = generate(lines, badPercent);
+        size_t instructions = 0;
+        size_t errors = 0;
+        const double fastest = bench::best([&] {
+            Lexer lexer(source);
+            SymbolTable symbols;
+            DiagnosticBuffer diagnostics;
+            PowerPCParser parser(lexer, symbols, diagnostics);
+            instructions = parser.parse().size();
+            errors = diagnostics.getErrorCount();
+        });
+        std::cout << badPercent << "% bad lines: " << fastest * 1000 << " ms, " << instructions << " instructions, "
+                  << errors << " errors" << std::endl;
+        if (badPercent == 0 && errors != 0) return 1;
+    }
+    return 0;
+}
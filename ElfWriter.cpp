@@ -0,0 +1,280 @@
+#include "ElfWriter.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+
+namespace {
+
+enum Section : uint16_t {
+    NULL_SECTION,
+    TEXT,
+    DATA,
+    RELA_TEXT,
+    RELA_DATA,
+    SYMTAB,
+    STRTAB,
+    SHSTRTAB,
+    ELF_SECTION_COUNT
+};
+
+const char* const SECTION_NAMES[ELF_SECTION_COUNT] = {"", ".text", ".data", ".rela.text", ".rela.data",
+                                                      ".symtab", ".strtab", ".shstrtab"};
+
+// Appends header fields in the target byte order. The 32- and 64-bit
+// layouts differ in the width of addresses and offsets (`addr`) and in the
+// order of some fields, which the callers spell out.
+class Emitter {
+public:
+    Emitter(SectionBuffer& out, bool is64, bool bigEndian) : out(out), is64(is64), swap(bigEndian != HOST_BIG_ENDIAN) {}
+
+    void byte(uint8_t value) { out.append(&value, 1); }
+    void half(uint16_t value) { put(swap ? __builtin_bswap16(value) : value); }
+    void word(uint32_t value) { put(swap ? __builtin_bswap32(value) : value); }
+    void xword(uint64_t value) { put(swap ? __builtin_bswap64(value) : value); }
+    void addr(uint64_t value) { is64 ? xword(value) : word(static_cast<uint32_t>(value)); }
+
+private:
+    template <class T>
+    void put(T value) { out.append(&value, sizeof(value)); }
+
+    SectionBuffer& out;
+    bool is64;
+    bool swap;
+};
+
+uint32_t addString(SectionBuffer& table, std::string_view name) {
+    const auto offset = static_cast<uint32_t>(table.size());
+    table.append(name.data(), name.size());
+    table.extend(1);
+    return offset;
+}
+
+struct Piece {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t align;
+    uint64_t entrySize;
+};
+
+}
+
+
+void ElfWriter::write(const Assembler& assembler, const std::string& path) const {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    try {
+        write(assembler, fd);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+    }
+}
+
+
+void ElfWriter::write(const Assembler& assembler, int fd) const {
+    const bool is64 = elfClass == ElfClass::Elf64;
+    const bool bigEndian = assembler.getEndian() == Endian::Big;
+    const uint64_t wordAlign = is64 ? 8 : 4;
+    const SymbolTable& symbols = assembler.getSymbols();
+    const std::vector<Fixup>& unresolved = assembler.getUnresolved();
+    const std::vector<DataRelocation>& dataRelocations = assembler.getDataRelocations();
+
+    SectionBuffer header, symtab, strtab, rela, relaData, shstrtab, sectionHeaders;
+    Emitter symbolOut(symtab, is64, bigEndian);
+    Emitter relaTextOut(rela, is64, bigEndian);
+    Emitter relaDataOut(relaData, is64, bigEndian);
+
+    // Locals must come first; sh_info of .symtab is the first global. The
+    // st_info encoding is the same in both classes.
+    auto addSymbol = [&](uint32_t name, uint64_t value, uint8_t info, uint16_t section) {
+        if (is64) {
+            symbolOut.word(name);
+            symbolOut.byte(info);
+            symbolOut.byte(STV_DEFAULT);
+            symbolOut.half(section);
+            symbolOut.xword(value);
+            symbolOut.xword(0);
+        } else {
+            symbolOut.word(name);
+            symbolOut.word(static_cast<uint32_t>(value));
+            symbolOut.word(0);
+            symbolOut.byte(info);
+            symbolOut.byte(STV_DEFAULT);
+            symbolOut.half(section);
+        }
+    };
+
+    std::vector<bool> referenced(symbols.size());
+    for (const Fixup& fixup : unresolved) referenced[fixup.symbol] = true;
+    for (const DataRelocation& relocation : dataRelocations) referenced[relocation.symbol] = true;
+    auto sectionOf = [](const Symbol& symbol) -> uint16_t {
+        return symbol.section == SectionId::Data ? DATA : TEXT;
+    };
+
+    strtab.extend(1);
+    addSymbol(0, 0, 0, SHN_UNDEF);
+    addSymbol(0, 0, ELF32_ST_INFO(STB_LOCAL, STT_SECTION), TEXT);
+    addSymbol(0, 0, ELF32_ST_INFO(STB_LOCAL, STT_SECTION), DATA);
+    uint32_t count = 3;
+    std::vector<uint32_t> index(symbols.size(), 0);
+    for (uint32_t id = 0; id < symbols.size(); id++) {
+        const Symbol& symbol = symbols.at(id);
+        if (!symbol.defined || symbol.global) continue;
+        addSymbol(addString(strtab, symbols.name(id)), symbol.address, ELF32_ST_INFO(STB_LOCAL, STT_NOTYPE),
+                  sectionOf(symbol));
+        index[id] = count++;
+    }
+    const uint32_t firstGlobal = count;
+    for (uint32_t id = 0; id < symbols.size(); id++) {
+        const Symbol& symbol = symbols.at(id);
+        if (!symbol.global && (symbol.defined || !referenced[id])) continue;
+        addSymbol(addString(strtab, symbols.name(id)), symbol.defined ? symbol.address : 0,
+                  ELF32_ST_INFO(STB_GLOBAL, STT_NOTYPE), symbol.defined ? sectionOf(symbol) : SHN_UNDEF);
+        index[id] = count++;
+    }
+
+    auto addRelocation = [&](Emitter& out, uint64_t offset, uint32_t symbol, uint32_t type, int32_t addend) {
+        out.addr(offset);
+        if (is64) {
+            out.xword(ELF64_R_INFO(index[symbol], type));
+            out.xword(static_cast<uint64_t>(static_cast<int64_t>(addend)));
+        } else {
+            out.word(ELF32_R_INFO(index[symbol], type));
+            out.word(static_cast<uint32_t>(addend));
+        }
+    };
+
+    // The R_PPC_ and R_PPC64_ numbers of these four, and of ADDR32, agree.
+    for (const Fixup& fixup : unresolved) {
+        const bool wide = fixup.field->width() == 24;
+        const uint32_t type = fixup.absolute ? (wide ? R_PPC_ADDR24 : R_PPC_ADDR14)
+                                             : (wide ? R_PPC_REL24 : R_PPC_REL14);
+        addRelocation(relaTextOut, fixup.offset, fixup.symbol, type, fixup.addend);
+    }
+    for (const DataRelocation& relocation : dataRelocations) {
+        if (relocation.size == 8 && !is64) {
+            throw std::runtime_error(".quad of symbol '" + std::string(symbols.name(relocation.symbol)) +
+                                     "' needs a 64-bit object");
+        }
+        const uint32_t type = relocation.size == 8 ? R_PPC64_ADDR64 : R_PPC_ADDR32;
+        addRelocation(relocation.section == SectionId::Data ? relaDataOut : relaTextOut, relocation.offset,
+                      relocation.symbol, type, relocation.addend);
+    }
+
+    uint32_t names[ELF_SECTION_COUNT];
+    for (size_t i = 0; i < ELF_SECTION_COUNT; i++) names[i] = addString(shstrtab, SECTION_NAMES[i]);
+
+    // File layout: ELF header, then the sections in index order, each at
+    // its alignment, then the section header table.
+    const uint64_t headerSize = is64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr);
+    const SectionBuffer* contents[ELF_SECTION_COUNT] = {nullptr, &assembler.code(), &assembler.data(), &rela,
+                                                        &relaData, &symtab, &strtab, &shstrtab};
+    Piece pieces[ELF_SECTION_COUNT] = {
+            {0, 0, 0, 0},
+            {0, assembler.code().size(), 4, 0},
+            {0, assembler.data().size(), wordAlign, 0},
+            {0, rela.size(), wordAlign, is64 ? sizeof(Elf64_Rela) : sizeof(Elf32_Rela)},
+            {0, relaData.size(), wordAlign, is64 ? sizeof(Elf64_Rela) : sizeof(Elf32_Rela)},
+            {0, symtab.size(), wordAlign, is64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym)},
+            {0, strtab.size(), 1, 0},
+            {0, shstrtab.size(), 1, 0},
+    };
+    uint64_t offset = headerSize;
+    for (size_t i = 1; i < ELF_SECTION_COUNT; i++) {
+        offset = (offset + pieces[i].align - 1) / pieces[i].align * pieces[i].align;
+        pieces[i].offset = offset;
+        offset += pieces[i].size;
+    }
+    const uint64_t sectionHeaderOffset = (offset + wordAlign - 1) / wordAlign * wordAlign;
+
+    Emitter headerOut(header, is64, bigEndian);
+    const uint8_t ident[EI_NIDENT] = {ELFMAG0, ELFMAG1, ELFMAG2, ELFMAG3,
+                                      static_cast<uint8_t>(is64 ? ELFCLASS64 : ELFCLASS32),
+                                      static_cast<uint8_t>(bigEndian ? ELFDATA2MSB : ELFDATA2LSB),
+                                      EV_CURRENT, ELFOSABI_NONE};
+    header.append(ident, sizeof(ident));
+    headerOut.half(ET_REL);
+    headerOut.half(is64 ? EM_PPC64 : EM_PPC);
+    headerOut.word(EV_CURRENT);
+    headerOut.addr(0);
+    headerOut.addr(0);
+    headerOut.addr(sectionHeaderOffset);
+    headerOut.word(0);
+    headerOut.half(static_cast<uint16_t>(headerSize));
+    headerOut.half(0);
+    headerOut.half(0);
+    headerOut.half(is64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr));
+    headerOut.half(ELF_SECTION_COUNT);
+    headerOut.half(SHSTRTAB);
+
+    Emitter sectionOut(sectionHeaders, is64, bigEndian);
+    auto addSection = [&](size_t i, uint32_t type, uint64_t flags, uint32_t link, uint32_t info) {
+        sectionOut.word(names[i]);
+        sectionOut.word(type);
+        sectionOut.addr(flags);
+        sectionOut.addr(0);
+        sectionOut.addr(pieces[i].offset);
+        sectionOut.addr(pieces[i].size);
+        sectionOut.word(link);
+        sectionOut.word(info);
+        sectionOut.addr(pieces[i].align);
+        sectionOut.addr(pieces[i].entrySize);
+    };
+    addSection(NULL_SECTION, SHT_NULL, 0, 0, 0);
+    addSection(TEXT, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 0, 0);
+    addSection(DATA, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE, 0, 0);
+    addSection(RELA_TEXT, SHT_RELA, SHF_INFO_LINK, SYMTAB, TEXT);
+    addSection(RELA_DATA, SHT_RELA, SHF_INFO_LINK, SYMTAB, DATA);
+    addSection(SYMTAB, SHT_SYMTAB, 0, STRTAB, firstGlobal);
+    addSection(STRTAB, SHT_STRTAB, 0, 0, 0);
+    addSection(SHSTRTAB, SHT_STRTAB, 0, 0, 0);
+
+    static const uint8_t padding[8] = {};
+    std::vector<iovec> pieceList;
+    uint64_t written = 0;
+    auto push = [&](const void* base, uint64_t size, uint64_t at) {
+        if (at > written) pieceList.push_back({const_cast<uint8_t*>(padding), at - written});
+        if (size != 0) pieceList.push_back({const_cast<void*>(base), size});
+        written = at + size;
+    };
+    push(header.data(), header.size(), 0);
+    for (size_t i = 1; i < ELF_SECTION_COUNT; i++) {
+        push(contents[i]->data(), pieces[i].size, pieces[i].offset);
+    }
+    push(sectionHeaders.data(), sectionHeaders.size(), sectionHeaderOffset);
+
+    // writev() may stop short, e.g. on a signal; carry on from there.
+    iovec* next = pieceList.data();
+    size_t left = pieceList.size();
+    while (left != 0) {
+        ssize_t n = ::writev(fd, next, static_cast<int>(left));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Cannot write object file: ") + std::strerror(errno));
+        }
+        auto done = static_cast<size_t>(n);
+        while (left != 0 && done >= next->iov_len) {
+            done -= next->iov_len;
+            next++;
+            left--;
+        }
+        if (left != 0) {
+            next->iov_base = static_cast<uint8_t*>(next->iov_base) + done;
+            next->iov_len -= done;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef PPCASM_ELFWRITER_H
+#define PPCASM_ELFWRITER_H
+
+
+#include <cstdint>
+#include <string>
+#include "Assembler.h"
+
+
+enum class ElfClass : uint8_t {
+    Elf32,
+    Elf64
+};
+
+
+// Writes what an Assembler produced as a relocatable PowerPC object: .text,
+// .data, .rela.text and .rela.data, .symtab and the string tables. Only the headers and tables are built
+// here, into their own SectionBuffers; the section contents are not copied,
+// and the whole file goes out in a single writev().
+//
+// Labels become local symbols in their section unless marked global.
+// Undefined labels that a branch refers to or that .global names become
+// undefined globals. Each unresolved branch gets an R_PPC_REL24/REL14
+// (ADDR24/ADDR14 for absolute branches) relocation, or the R_PPC64_
+// equivalent, with its addend. A .long naming a symbol gets R_PPC_ADDR32
+// and a .quad R_PPC64_ADDR64; the latter only exists in ELF64, so write()
+// refuses it in an ELF32 object.
+class ElfWriter {
+public:
+    explicit ElfWriter(ElfClass elfClass = ElfClass::Elf32) : elfClass(elfClass) {}
+
+    // The byte order is the assembler's. Throws std::runtime_error if the
+    // file cannot be written.
+    void write(const Assembler& assembler, const std::string& path) const;
+    void write(const Assembler& assembler, int fd) const;
+
+private:
+    ElfClass elfClass;
+};
+
+
+#endif //PPCASM_ELFWRITER_H
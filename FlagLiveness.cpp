@@ -0,0 +1,94 @@
+#include "FlagLiveness.h"
+#include "PowerPCInstructionTable.h"
+
+using Effects = PowerPCInstruction::RegisterEffects;
+
+
+namespace {
+
+// Operand fields at their architected positions. Simplified mnemonics fix
+// some of them in the base opcode, so they are read from the word rather
+// than looked up in the encoding.
+constexpr unsigned crfD(uint32_t word) { return word >> 23 & 7; }
+constexpr unsigned crfS(uint32_t word) { return word >> 18 & 7; }
+constexpr unsigned crbD(uint32_t word) { return word >> 21 & 31; }
+constexpr unsigned crbA(uint32_t word) { return word >> 16 & 31; }
+constexpr unsigned crbB(uint32_t word) { return word >> 11 & 31; }
+constexpr unsigned bo(uint32_t word) { return word >> 21 & 31; }
+constexpr unsigned bi(uint32_t word) { return word >> 16 & 31; }
+constexpr unsigned crm(uint32_t word) { return word >> 12 & 0xff; }
+constexpr unsigned spr(uint32_t word) { return (word >> 16 & 31) | (word >> 11 & 31) << 5; }
+
+constexpr unsigned SPR_XER = 1;
+
+constexpr const PowerPCInstruction& MTSPR = instructionAt(instructionId("mtspr"));
+constexpr const PowerPCInstruction& MFSPR = instructionAt(instructionId("mfspr"));
+
+FlagSet fieldsSelected(unsigned mask) {
+    FlagSet set = 0;
+    for (unsigned field = 0; field < 8; field++) {
+        if ((mask & 0x80u >> field) != 0) set |= flags::crField(field);
+    }
+    return set;
+}
+
+// The XER bits and the fixed CR fields; CR_FIELD, CR_BIT and CR need the
+// word.
+FlagSet fixed(uint16_t locations) {
+    FlagSet set = 0;
+    if ((locations & Effects::FLAG_CR0) != 0) set |= flags::crField(0);
+    if ((locations & Effects::FLAG_CR1) != 0) set |= flags::crField(1);
+    if ((locations & Effects::FLAG_XER_SO) != 0) set |= flags::SO;
+    if ((locations & Effects::FLAG_XER_OV) != 0) set |= flags::OV;
+    if ((locations & Effects::FLAG_XER_CA) != 0) set |= flags::CA;
+    return set;
+}
+
+}
+
+
+FlagEffects flagEffects(const PowerPCInstruction& instruction, const PowerPCInstruction::SyntaxVariant& variant,
+                        uint32_t word) {
+    const Effects& effects = instruction.effects;
+    uint16_t defines = effects.defines;
+    uint16_t uses = effects.uses;
+
+    // CR0/CR1 and the XER[SO] they copy only come with Rc=1, and XER[SO,OV]
+    // only with OE=1, where the instruction has those bits at all.
+    const bool hasRc = instruction.encoding.fieldIndex("Rc") >= 0;
+    const bool hasOe = instruction.encoding.fieldIndex("OE") >= 0;
+    const bool rc = !hasRc || variant.rc;
+    const bool oe = !hasOe || variant.oe;
+    if (!rc) defines &= ~(Effects::FLAG_CR0 | Effects::FLAG_CR1);
+    if (!oe) defines &= ~(Effects::FLAG_XER_SO | Effects::FLAG_XER_OV);
+    if (hasRc && !rc && !(hasOe && oe)) uses &= ~Effects::FLAG_XER_SO;
+
+    FlagEffects result{fixed(defines), fixed(uses)};
+    if ((defines & Effects::FLAG_CR_FIELD) != 0) result.defines |= flags::crField(crfD(word));
+    if ((uses & Effects::FLAG_CR_FIELD) != 0) result.uses |= flags::crField(crfS(word));
+    if ((defines & Effects::FLAG_CR_BIT) != 0) result.defines |= flags::crBit(crbD(word));
+    if ((uses & Effects::FLAG_CR_BIT) != 0) {
+        if (instruction.encoding.fieldIndex("crbA") >= 0) {
+            result.uses |= flags::crBit(crbA(word)) | flags::crBit(crbB(word));
+        } else if ((bo(word) & 16) == 0) {
+            result.uses |= flags::crBit(bi(word));
+        }
+    }
+    if ((defines & Effects::FLAG_CR) != 0) result.defines |= fieldsSelected(crm(word));
+    if ((uses & Effects::FLAG_CR) != 0) result.uses |= flags::CR;
+
+    if (&instruction == &MTSPR && spr(word) == SPR_XER) result.defines |= flags::XER;
+    if (&instruction == &MFSPR && spr(word) == SPR_XER) result.uses |= flags::XER;
+    return result;
+}
+
+
+std::vector<FlagSet> liveFlags(const std::vector<FlagEffects>& block, FlagSet liveOut) {
+    std::vector<FlagSet> live(block.size());
+    FlagSet current = liveOut;
+    for (size_t i = block.size(); i-- > 0;) {
+        live[i] = current;
+        current = (current & ~block[i].defines) | block[i].uses;
+    }
+    return live;
+}
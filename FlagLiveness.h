@@ -0,0 +1,57 @@
+#ifndef PPCASM_FLAGLIVENESS_H
+#define PPCASM_FLAGLIVENESS_H
+
+
+#include <cstdint>
+#include <vector>
+#include "InstructionRecord.h"
+#include "PowerPCInstruction.h"
+
+
+// Condition state as a bit set. CR bit i (architected numbering, 0 is CR0[LT])
+// is bit 31 - i, as in the CR itself; XER[SO], XER[OV] and XER[CA] sit above.
+using FlagSet = uint64_t;
+
+namespace flags {
+inline constexpr FlagSet CR = 0xffffffff;
+inline constexpr FlagSet SO = FlagSet(1) << 32;
+inline constexpr FlagSet OV = FlagSet(1) << 33;
+inline constexpr FlagSet CA = FlagSet(1) << 34;
+inline constexpr FlagSet XER = SO | OV | CA;
+inline constexpr FlagSet ALL = CR | XER;
+
+constexpr FlagSet crField(unsigned field) {
+    return FlagSet(0xf) << (28 - 4 * field);
+}
+
+constexpr FlagSet crBit(unsigned bit) {
+    return FlagSet(1) << (31 - bit);
+}
+}
+
+
+// What one instruction word defines and uses: the RegisterEffects of its
+// table entry with the CR locations resolved from its operands (crfD, BI,
+// CRM, ...) and the Rc/OE parts dropped when its variant does not set them.
+// A conditional branch whose BO ignores the condition uses no CR bit.
+struct FlagEffects {
+    FlagSet defines = 0;
+    FlagSet uses = 0;
+};
+
+// `word` is the encoded instruction in host order.
+FlagEffects flagEffects(const PowerPCInstruction& instruction, const PowerPCInstruction::SyntaxVariant& variant,
+                        uint32_t word);
+
+inline FlagEffects flagEffects(const InstructionRecord& record) {
+    return flagEffects(record.definition(), record.syntax(), record.word);
+}
+
+
+// Backward liveness over a straight-line block: entry i of the result is the
+// state live after instruction i, given what is live at the end of the
+// block. A definition whose bits are not live after it is dead.
+std::vector<FlagSet> liveFlags(const std::vector<FlagEffects>& block, FlagSet liveOut = flags::ALL);
+
+
+#endif //PPCASM_FLAGLIVENESS_H
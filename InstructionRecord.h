@@ -0,0 +1,60 @@
+#ifndef PPCASM_INSTRUCTIONRECORD_H
+#define PPCASM_INSTRUCTIONRECORD_H
+
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "PowerPCInstruction.h"
+#include "PowerPCInstructionTable.h"
+#include "PowerPCKeywords.h"
+#include "SymbolTable.h"
+
+
+// One instruction with its operand values spread out by encoding field, the
+// form the encoder takes and the decoder produces. The instruction
+// definition points into the static instruction table and is never copied.
+struct ParsedInstruction {
+    const PowerPCInstruction* instruction;
+    const PowerPCInstruction::SyntaxVariant* variant;
+    uint32_t line;
+    // Operand values, indexed like instruction->encoding.fields.
+    std::array<int32_t, PowerPCInstruction::Encoding::MAX_FIELDS> operands{};
+};
+
+
+// The OE/Rc/LK/AA bits share their values with the keyword flags.
+enum RecordFlags : uint8_t {
+    RECORD_OE = KW_OE,
+    RECORD_RC = KW_RC,
+    RECORD_LK = KW_LK,
+    RECORD_AA = KW_AA,
+    // Some operand did not fit its field; the error has been reported and
+    // the word is zero, but the instruction still takes its four bytes.
+    RECORD_INVALID = 1 << 7
+};
+
+
+// What the parser hands out per instruction: 16 bytes of plain data, with
+// the operands already encoded. Names, syntax strings and field layouts stay
+// in the instruction table, found by `id`. The address is implied by the
+// position of the record in its section.
+struct InstructionRecord {
+    uint32_t word;
+    uint32_t line;
+    // Label used as the branch target, or SymbolTable::NONE. The branch
+    // field of `word` then holds the label's addend.
+    uint32_t symbol;
+    InstructionId id;
+    uint8_t variant;
+    uint8_t flags;
+
+    const PowerPCInstruction& definition() const { return instructionAt(id); }
+    const PowerPCInstruction::SyntaxVariant& syntax() const { return instructionAt(id).syntax_variants[variant]; }
+};
+
+static_assert(sizeof(InstructionRecord) == 16, "InstructionRecord should stay 16 bytes");
+static_assert(std::is_trivially_copyable_v<InstructionRecord>, "InstructionRecord should stay plain data");
+
+
+#endif //PPCASM_INSTRUCTIONRECORD_H
@@ -0,0 +1,62 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(err));
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    if (length != 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path + ": " + std::strerror(err));
+        }
+        ::madvise(mapped, length, MADV_SEQUENTIAL);
+        address = static_cast<const char*>(mapped);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+        : address(std::exchange(other.address, nullptr)),
+          length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        address = std::exchange(other.address, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if (address != nullptr) {
+        ::munmap(const_cast<char*>(address), length);
+        address = nullptr;
+        length = 0;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef PPCASM_MAPPEDFILE_H
+#define PPCASM_MAPPEDFILE_H
+
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only private mapping of a whole file. Move-only; the mapping is
+// released when the object is destroyed, so views into it must not outlive it.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return address; }
+    size_t size() const { return length; }
+    std::string_view view() const { return {address, length}; }
+
+private:
+    void release();
+
+    const char* address = nullptr;
+    size_t length = 0;
+};
+
+
+#endif //PPCASM_MAPPEDFILE_H
@@ -1,12 +1,17 @@
 
 
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <set>
+#include <map>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include "BenchCorpus.h"
+#include "TriviaScan.h"
 
 
 enum class TokenType {
@@ -122,52 +127,210 @@ public:
         transitions.emplace_back(from, to, c);
     }
 
+};
 
-    bool accepts(const std::string& input, TokenType& token_type) {
-        std::set<int> current_states = epsilon_closure(start_state);
 
-        for (char c : input) {
-            current_states = epsilon_closure(move(current_states, c));
-            if (current_states.empty()) break;
-        }
+class DFA {
+    static constexpr int DEAD = 0;
+    static constexpr int ALPHABET = 256;
+
+    int start = DEAD;
+    int state_count = 1;
+    std::vector<uint16_t> table;
+    std::vector<uint8_t> accept;
 
-        for (int id : current_states) {
-            if (states[id]->is_accepting) {
-                token_type = states[id]->accepting_type;
-                return true;
+    static uint8_t accept_code(const NFA& nfa, const std::set<int>& state_ids) {
+        for (int id : state_ids) {
+            if (nfa.states[id]->is_accepting) {
+                return static_cast<uint8_t>(nfa.states[id]->accepting_type) + 1;
             }
         }
+        return 0;
+    }
+
 
-        return false;
+    void subset_construct(NFA& nfa) {
+        std::map<std::set<int>, int> ids;
+        std::vector<std::set<int>> pending;
+
+        auto intern = [&](std::set<int> state_ids) {
+            if (state_ids.empty()) return DEAD;
+            auto it = ids.find(state_ids);
+            if (it != ids.end()) return it->second;
+            int id = state_count++;
+            if (id > UINT16_MAX) throw std::runtime_error("DFA too large");
+            ids.emplace(state_ids, id);
+            table.resize(static_cast<size_t>(state_count) * ALPHABET, DEAD);
+            accept.push_back(accept_code(nfa, state_ids));
+            pending.push_back(std::move(state_ids));
+            return id;
+        };
+
+        table.assign(ALPHABET, DEAD);
+        accept.assign(1, 0);
+        start = intern(nfa.epsilon_closure(nfa.start_state));
+        if (start == DEAD) return;
+
+        for (size_t next = 0; next < pending.size(); next++) {
+            std::set<int> state_ids = pending[next];
+            int from = ids[state_ids];
+            for (int c = 0; c < ALPHABET; c++) {
+                int to = intern(nfa.epsilon_closure(nfa.move(state_ids, static_cast<char>(c))));
+                table[static_cast<size_t>(from) * ALPHABET + c] = static_cast<uint16_t>(to);
+            }
+        }
     }
 
 
-    std::pair<std::string, TokenType> longest_match(const std::string& input, size_t start_pos) {
-        std::set<int> current_states = epsilon_closure(start_state);
-        size_t last_accept_pos = start_pos;
-        TokenType last_accept_type = TokenType::UNKNOWN;
+    // Hopcroft's partition refinement. The initial partition groups states by
+    // accepted token type, so merged states always accept the same token.
+    void minimize() {
+        std::vector<std::vector<int>> inverse(static_cast<size_t>(state_count) * ALPHABET);
+        for (int s = 0; s < state_count; s++) {
+            for (int c = 0; c < ALPHABET; c++) {
+                int t = table[static_cast<size_t>(s) * ALPHABET + c];
+                inverse[static_cast<size_t>(t) * ALPHABET + c].push_back(s);
+            }
+        }
 
-        for (size_t pos = start_pos; pos < input.size(); pos++) {
-            char c = input[pos];
-            current_states = epsilon_closure(move(current_states, c));
+        std::vector<std::vector<int>> blocks;
+        std::vector<int> block_of(state_count);
+        std::map<uint8_t, int> initial;
+        for (int s = 0; s < state_count; s++) {
+            auto it = initial.emplace(accept[s], static_cast<int>(blocks.size())).first;
+            if (it->second == static_cast<int>(blocks.size())) blocks.emplace_back();
+            blocks[it->second].push_back(s);
+            block_of[s] = it->second;
+        }
 
-            if (current_states.empty()) break;
+        std::vector<int> worklist;
+        std::vector<bool> in_worklist(blocks.size(), true);
+        for (int b = 0; b < static_cast<int>(blocks.size()); b++) worklist.push_back(b);
+
+        std::vector<int> hits(state_count, 0);
+        std::vector<bool> marked(state_count, false);
+        while (!worklist.empty()) {
+            int splitter = worklist.back();
+            worklist.pop_back();
+            in_worklist[splitter] = false;
+            std::vector<int> splitter_states = blocks[splitter];
+
+            for (int c = 0; c < ALPHABET; c++) {
+                std::vector<int> predecessors;
+                for (int t : splitter_states) {
+                    for (int s : inverse[static_cast<size_t>(t) * ALPHABET + c]) {
+                        if (!marked[s]) {
+                            marked[s] = true;
+                            predecessors.push_back(s);
+                        }
+                    }
+                }
 
+                std::vector<int> touched;
+                for (int s : predecessors) {
+                    if (hits[block_of[s]]++ == 0) touched.push_back(block_of[s]);
+                }
 
-            for (int id : current_states) {
-                if (states[id]->is_accepting) {
-                    last_accept_pos = pos + 1;
-                    last_accept_type = states[id]->accepting_type;
-                    break;
+                for (int b : touched) {
+                    if (hits[b] < static_cast<int>(blocks[b].size())) {
+                        std::vector<int> inside, outside;
+                        for (int s : blocks[b]) (marked[s] ? inside : outside).push_back(s);
+
+                        int nb = static_cast<int>(blocks.size());
+                        blocks[b] = std::move(inside);
+                        blocks.push_back(std::move(outside));
+                        for (int s : blocks[nb]) block_of[s] = nb;
+
+                        in_worklist.push_back(false);
+                        if (in_worklist[b]) {
+                            worklist.push_back(nb);
+                            in_worklist[nb] = true;
+                        } else {
+                            int smaller = blocks[b].size() <= blocks[nb].size() ? b : nb;
+                            worklist.push_back(smaller);
+                            in_worklist[smaller] = true;
+                        }
+                    }
+                    hits[b] = 0;
                 }
+
+                for (int s : predecessors) marked[s] = false;
+            }
+        }
+
+        // Renumber so that the block holding the dead state stays state 0.
+        std::vector<int> renumber(blocks.size(), -1);
+        renumber[block_of[DEAD]] = DEAD;
+        int count = 1;
+        for (int b = 0; b < static_cast<int>(blocks.size()); b++) {
+            if (renumber[b] < 0) renumber[b] = count++;
+        }
+
+        std::vector<uint16_t> min_table(static_cast<size_t>(count) * ALPHABET, DEAD);
+        std::vector<uint8_t> min_accept(count, 0);
+        for (int b = 0; b < static_cast<int>(blocks.size()); b++) {
+            int rep = blocks[b].front();
+            int id = renumber[b];
+            min_accept[id] = accept[rep];
+            for (int c = 0; c < ALPHABET; c++) {
+                int t = table[static_cast<size_t>(rep) * ALPHABET + c];
+                min_table[static_cast<size_t>(id) * ALPHABET + c] = static_cast<uint16_t>(renumber[block_of[t]]);
+            }
+        }
+
+        start = renumber[block_of[start]];
+        state_count = count;
+        table = std::move(min_table);
+        accept = std::move(min_accept);
+    }
+
+public:
+    DFA() : table(ALPHABET, DEAD), accept(1, 0) {}
+
+    explicit DFA(NFA& nfa) {
+        subset_construct(nfa);
+        minimize();
+    }
+
+    int size() const { return state_count; }
+
+
+    bool accepts(const std::string& input, TokenType& token_type) const {
+        int state = start;
+        for (char c : input) {
+            state = table[static_cast<size_t>(state) * ALPHABET + static_cast<unsigned char>(c)];
+            if (state == DEAD) return false;
+        }
+
+        if (accept[state] == 0) return false;
+        token_type = static_cast<TokenType>(accept[state] - 1);
+        return true;
+    }
+
+
+    std::pair<size_t, TokenType> longest_match(const std::string& input, size_t start_pos) const {
+        const uint16_t* delta = table.data();
+        const uint8_t* accepting = accept.data();
+        const unsigned char* text = reinterpret_cast<const unsigned char*>(input.data());
+        const size_t size = input.size();
+
+        int state = start;
+        size_t last_accept_pos = start_pos;
+        uint8_t last_accept = 0;
+
+        for (size_t pos = start_pos; pos < size && state != DEAD; pos++) {
+            state = delta[static_cast<size_t>(state) * ALPHABET + text[pos]];
+            if (accepting[state] != 0) {
+                last_accept_pos = pos + 1;
+                last_accept = accepting[state];
             }
         }
 
         if (last_accept_pos > start_pos) {
-            return {input.substr(start_pos, last_accept_pos - start_pos), last_accept_type};
+            return {last_accept_pos - start_pos, static_cast<TokenType>(last_accept - 1)};
         }
 
-        return {"", TokenType::UNKNOWN};
+        return {0, TokenType::UNKNOWN};
     }
 };
 
@@ -177,8 +340,10 @@ class Lexer {
     int position;
     int line;
     int column;
+    trivia::Scanner scanner;
 
     NFA nfa;
+    DFA dfa;
 
     void build_nfa() {
 
@@ -259,32 +424,29 @@ class Lexer {
         auto eol = std::make_shared<NFAState>(16, true, TokenType::END_OF_LINE);
         nfa.add_state(eol);
         nfa.add_transition(nfa.start_state, eol, '\n');
+
+        dfa = DFA(nfa);
     }
 
     void skip_whitespace() {
-        while (position < input.size()) {
-            char c = input[position];
-            if (c == ' ' || c == '\t') {
-                position++;
-                column++;
-            } else if (c == '#') {
-
-                while (position < input.size() && input[position] != '\n') {
-                    position++;
-                }
-                column = 1;
-            } else {
-                break;
-            }
-        }
+        const size_t stop = scanner.skip(static_cast<size_t>(position));
+        column += static_cast<int>(stop - position);
+        position = static_cast<int>(stop);
     }
 
 public:
     Lexer(const std::string& src)
-            : input(src), position(0), line(1), column(1) {
+            : input(src), position(0), line(1), column(1), scanner(input) {
         build_nfa();
     }
 
+    // Back to the start of the input, keeping the DFA.
+    void rewind() {
+        position = 0;
+        line = 1;
+        column = 1;
+    }
+
     Token next_token() {
         skip_whitespace();
 
@@ -292,12 +454,13 @@ public:
             return Token(TokenType::END_OF_FILE, "", line, column);
         }
 
-        auto [value, type] = nfa.longest_match(input, position);
+        auto [length, type] = dfa.longest_match(input, position);
 
         if (type != TokenType::UNKNOWN) {
+            std::string value = input.substr(position, length);
             int start_column = column;
-            position += value.size();
-            column += value.size();
+            position += length;
+            column += length;
 
             if (type == TokenType::END_OF_LINE) {
                 line++;
@@ -317,7 +480,31 @@ public:
 };
 
 
-int main() {
+// Throughput of next_token() over `megabytes` of generated assembly, best of
+// five runs. Each call walks the DFA table from the start state. The lexer,
+// with its DFA and its copy of the source, is built once before timing.
+int benchmark(size_t megabytes) {
+    const char* lines[] = {"    add r3, r1, r2\n", "    addi r4, r0, 0x10\n", "loop:\n",
+                           "    stw r5, 8(r1)   # spill\n", "    b loop\n"};
+    std::string source;
+    for (size_t i = 0; source.size() < (megabytes << 20); i++) source += lines[i % 5];
+
+    Lexer lexer(source);
+    size_t tokens = 0;
+    const double fastest = bench::best([&] {
+        lexer.rewind();
+        tokens = 0;
+        while (lexer.next_token().type != TokenType::END_OF_FILE) tokens++;
+    });
+    std::cout << source.size() << " bytes, " << tokens << " tokens: " << fastest * 1000 << " ms, "
+              << source.size() / fastest / 1e6 << " MB/s\n";
+    return 0;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc > 1) return benchmark(std::strtoul(argv[1], nullptr, 0));
+
     std::string test_code = R"(
         add r3, r1, r2
         addi r4, r0, 0x10
@@ -341,4 +528,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
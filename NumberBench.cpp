@@ -0,0 +1,123 @@
+#include <charconv>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BenchCorpus.h"
+#include "NumberLiteral.h"
+
+// Compares number::scan with std::strtoull and std::from_chars on 1M
+// literals of each kind, stored back to back in one buffer. Each converter
+// is called out of line per literal with the rest of the buffer, as the
+// lexer calls scan, and stops at the ',' after the literal. The best of
+// seven runs is reported in ns per literal. The three must agree on every
+// value.
+
+namespace {
+
+constexpr size_t COUNT = 1000000;
+constexpr int RUNS = 7;
+
+struct Literals {
+    std::string text;
+    std::vector<std::string_view> items;
+};
+
+std::string decimal(std::mt19937_64& rng, unsigned minDigits, unsigned maxDigits) {
+    const unsigned digits = minDigits + rng() % (maxDigits - minDigits + 1);
+    std::string literal(1, char('1' + rng() % 9));
+    while (literal.size() < digits) literal += char('0' + rng() % 10);
+    return literal;
+}
+
+std::string hex(std::mt19937_64& rng, unsigned digits) {
+    static const char DIGITS[] = "0123456789abcdefABCDEF";
+    std::string literal = "0x";
+    for (unsigned i = 0; i < digits; i++) literal += DIGITS[rng() % 22];
+    return literal;
+}
+
+template<typename F>
+Literals generate(F&& next) {
+    Literals literals;
+    std::vector<size_t> ends;
+    for (size_t i = 0; i < COUNT; i++) {
+        literals.text += next();
+        ends.push_back(literals.text.size());
+        literals.text += ',';
+    }
+    size_t start = 0;
+    const std::string_view all = literals.text;
+    for (size_t end : ends) {
+        literals.items.push_back(all.substr(start));
+        start = end + 1;
+    }
+    return literals;
+}
+
+__attribute__((noinline)) uint64_t bySwar(std::string_view text) {
+    NumberValue value{};
+    NumberStatus status;
+    number::scan(text, value, status);
+    return value.magnitude;
+}
+
+// strtoull needs a terminator after the literal, which the ',' provides.
+__attribute__((noinline)) uint64_t byStrtoull(std::string_view text) {
+    return std::strtoull(text.data(), nullptr, 0);
+}
+
+__attribute__((noinline)) uint64_t byFromChars(std::string_view text) {
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    uint64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value, base);
+    return value;
+}
+
+// Best time in ns per literal; `sum` gets the sum of the values.
+double measure(uint64_t (*convert)(std::string_view), const Literals& literals, uint64_t& sum) {
+    const double fastest = bench::best([&] {
+        sum = 0;
+        for (std::string_view item : literals.items) sum += convert(item);
+    }, RUNS);
+    return fastest * 1e9 / double(literals.items.size());
+}
+
+}
+
+
+int main() {
+    std::mt19937_64 rng(42);
+    const struct {
+        const char* name;
+        Literals literals;
+    } KINDS[] = {
+            {"decimal 1-5 digits", generate([&] { return decimal(rng, 1, 5); })},
+            {"decimal 10-19", generate([&] { return decimal(rng, 10, 19); })},
+            {"hex 8 digits", generate([&] { return hex(rng, 8); })},
+            {"hex 16 digits", generate([&] { return hex(rng, 16); })},
+            {"70/30 mix", generate([&] { return rng() % 10 < 7 ? decimal(rng, 1, 5) : hex(rng, 8); })},
+    };
+
+    bool agree = true;
+    std::cout << "ns per literal        swar  strtoull  from_chars" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& kind : KINDS) {
+        uint64_t sums[3];
+        const double swar = measure(bySwar, kind.literals, sums[0]);
+        const double strtoull = measure(byStrtoull, kind.literals, sums[1]);
+        const double fromChars = measure(byFromChars, kind.literals, sums[2]);
+        const bool same = sums[0] == sums[1] && sums[1] == sums[2];
+        agree = agree && same;
+        std::cout << std::left << std::setw(20) << kind.name << std::right << std::setw(6) << swar << std::setw(10)
+                  << strtoull << std::setw(12) << fromChars << (same ? "" : "  VALUES DIFFER") << std::endl;
+    }
+    return agree ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include "NumberLiteral.h"
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t ONES = 0x0101010101010101ull;
+constexpr uint64_t HIGH = 0x8080808080808080ull;
+
+// Eight bytes of text with the first one in the low byte, padded with
+// zeros, which are no digit in any radix.
+inline uint64_t load(const char* p, size_t n) {
+    uint64_t lanes = 0;
+    if (n >= 8) {
+        std::memcpy(&lanes, p, 8);
+    } else {
+        for (size_t i = 0; i < n; i++) lanes |= uint64_t(static_cast<uint8_t>(p[i])) << (8 * i);
+        return lanes;
+    }
+    if constexpr (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) lanes = __builtin_bswap64(lanes);
+    return lanes;
+}
+
+// High bit of each byte in [lo, hi]. A byte of 0x80 or more is out of
+// range, and may corrupt the bytes after it, which are never looked at.
+inline uint64_t inRange(uint64_t lanes, uint8_t lo, uint8_t hi) {
+    const uint64_t atLeastLo = lanes + ONES * (0x80 - lo);
+    const uint64_t aboveHi = lanes + ONES * (0x7f - hi);
+    return atLeastLo & ~aboveHi & ~lanes & HIGH;
+}
+
+// Digit values of up to eight digits, the first in the low byte and
+// leading zeros before it, folded into one number: pairs, then quads, then
+// all eight. The largest result, 16^8 - 1, still fits the top half.
+inline uint64_t fold(uint64_t digits, uint64_t radix) {
+    digits = digits * radix + (digits >> 8);
+    const uint64_t mask = 0x000000ff000000ffull;
+    const uint64_t r2 = radix * radix;
+    const uint64_t r4 = r2 * r2;
+    const uint64_t r6 = r4 * r2;
+    return ((digits & mask) * (r2 + (r6 << 32)) + ((digits >> 16) & mask) * (1 + (r4 << 32))) >> 32;
+}
+
+// Without branches: whether a hex digit is a letter is a coin toss.
+inline bool isDigitOf(char c, unsigned radix) {
+    const auto byte = static_cast<uint8_t>(c);
+    const bool digit = static_cast<uint8_t>(byte - '0') < (radix < 10 ? radix : 10);
+    const bool letter = radix == 16 && static_cast<uint8_t>((byte | 0x20) - 'a') < 6;
+    return digit | letter;
+}
+
+template <unsigned RADIX>
+constexpr std::array<uint64_t, 9> powers() {
+    std::array<uint64_t, 9> result{};
+    result[0] = 1;
+    for (size_t i = 1; i < result.size(); i++) result[i] = result[i - 1] * RADIX;
+    return result;
+}
+
+// Reads the run of digits at `p`; returns its length.
+template <unsigned RADIX>
+size_t digits(const char* p, size_t n, uint64_t& value, bool& overflow) {
+    static constexpr std::array<uint64_t, 9> SCALE = powers<RADIX>();
+    value = 0;
+    overflow = false;
+    size_t length = 0;
+    while (true) {
+        const uint64_t lanes = load(p + length, n - length);
+        uint64_t valid;
+        uint64_t values = lanes & (ONES * 0x0f);
+        if constexpr (RADIX == 16) {
+            // Letters are the lanes with 0x40 set; their low nibble is 1-6.
+            valid = inRange(lanes, '0', '9') | inRange(lanes | ONES * 0x20, 'a', 'f');
+            values += ((lanes >> 6) & ONES) * 9;
+        } else {
+            valid = inRange(lanes, '0', '0' + RADIX - 1);
+        }
+
+        const uint64_t invalid = ~valid & HIGH;
+        const size_t count = invalid == 0 ? 8 : static_cast<size_t>(__builtin_ctzll(invalid)) / 8;
+        if (count == 0) break;
+        if (count < 8) values <<= 8 * (8 - count);
+
+        overflow |= __builtin_mul_overflow(value, SCALE[count], &value);
+        overflow |= __builtin_add_overflow(value, fold(values, RADIX), &value);
+        length += count;
+        if (count < 8 || length == n) break;
+    }
+    return length;
+}
+
+
+}
+
+
+size_t number::scan(std::string_view text, NumberValue& value, NumberStatus& status) {
+    const char* p = text.data();
+    const size_t n = text.size();
+    size_t start = 0;
+    if (n != 0 && (p[0] == '+' || p[0] == '-')) start = 1;
+    if (start >= n || p[start] < '0' || p[start] > '9') return 0;
+
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    size_t length;
+    const char prefix = start + 2 < n && p[start] == '0' ? static_cast<char>(p[start + 1] | 0x20) : '\0';
+    if (prefix == 'x' && isDigitOf(p[start + 2], 16)) {
+        length = 2 + digits<16>(p + start + 2, n - start - 2, magnitude, overflow);
+    } else if (prefix == 'b' && isDigitOf(p[start + 2], 2)) {
+        length = 2 + digits<2>(p + start + 2, n - start - 2, magnitude, overflow);
+    } else {
+        length = digits<10>(p + start, n - start, magnitude, overflow);
+        if (p[start] == '0' && length > 1) {
+            // Octal, where 8 and 9 are errors rather than the end.
+            if (digits<8>(p + start, length, magnitude, overflow) != length) {
+                value = NumberValue{0, p[0] == '-'};
+                status = NumberStatus::BadDigit;
+                return start + length;
+            }
+        }
+    }
+
+    value = NumberValue{magnitude, p[0] == '-'};
+    status = overflow ? NumberStatus::Overflow : NumberStatus::Ok;
+    return start + length;
+}
+
+
+NumberStatus number::parse(std::string_view text, NumberValue& value) {
+    NumberStatus status = NumberStatus::Ok;
+    if (number::scan(text, value, status) != text.size()) return NumberStatus::BadDigit;
+    return status;
+}
@@ -0,0 +1,41 @@
+#ifndef PPCASM_NUMBERLITERAL_H
+#define PPCASM_NUMBERLITERAL_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+enum class NumberStatus : uint8_t {
+    Ok,
+    Overflow,       // more than 64 bits
+    BadDigit        // 8 or 9 in an octal number
+};
+
+struct NumberValue {
+    uint64_t magnitude;
+    bool negative;
+};
+
+
+// Integer literals as in GNU as: an optional sign, then 0x hex, 0b binary,
+// 0 followed by octal digits, or decimal. Digits are read eight at a time
+// from one 64-bit load (SWAR): the run of valid digits is found with
+// bytewise range checks and its value folded together with three
+// multiplies, so a literal costs about one step per eight characters.
+namespace number {
+
+// Length of the literal at the start of `text`, or 0 if there is none. A
+// 0x or 0b prefix without a digit after it is not part of the literal, so
+// "0x" scans as "0". `value` and `status` are set whenever the length is
+// not 0.
+size_t scan(std::string_view text, NumberValue& value, NumberStatus& status);
+
+// The whole of `text` must be one literal; anything else is BadDigit.
+NumberStatus parse(std::string_view text, NumberValue& value);
+
+}
+
+
+#endif //PPCASM_NUMBERLITERAL_H
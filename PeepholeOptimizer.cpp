@@ -0,0 +1,234 @@
+#include "PeepholeOptimizer.h"
+#include "FlagLiveness.h"
+#include "PowerPCEncoder.h"
+
+using FieldKind = PowerPCInstruction::Encoding::FieldKind;
+using Field = PowerPCInstruction::Encoding::Field;
+
+
+namespace {
+
+// Issue cost of a simple integer instruction, and the load-to-use latency of
+// an L1 hit on the 32-bit cores (750, 74xx, e500). Only the estimate in the
+// report depends on them.
+constexpr unsigned ALU_CYCLES = 1;
+constexpr unsigned LOAD_CYCLES = 3;
+
+constexpr InstructionId OR = instructionId("or");
+constexpr InstructionId ADDI = instructionId("addi");
+constexpr InstructionId STW = instructionId("stw");
+constexpr InstructionId LWZ = instructionId("lwz");
+constexpr InstructionId MR = instructionId("mr");
+
+// Operand fields at their architected positions, read from the word so that
+// simplified mnemonics (mr, la, ...) look like their base instruction.
+constexpr unsigned rD(uint32_t word) { return word >> 21 & 31; }
+constexpr unsigned rA(uint32_t word) { return word >> 16 & 31; }
+constexpr unsigned rB(uint32_t word) { return word >> 11 & 31; }
+constexpr int16_t d(uint32_t word) { return static_cast<int16_t>(word & 0xffff); }
+
+bool is(const InstructionRecord& record, InstructionId id) {
+    return baseInstruction(record.id) == id && (record.flags & RECORD_INVALID) == 0;
+}
+
+// or rA,rS,rS, with or without Rc.
+bool isMove(const InstructionRecord& record) {
+    return is(record, OR) && rD(record.word) == rB(record.word);
+}
+
+// Whether the instruction writes nothing but its GPR result.
+bool removable(const InstructionRecord& record) {
+    return (record.flags & RECORD_INVALID) == 0 && record.symbol == SymbolTable::NONE &&
+           flagEffects(record).defines == 0;
+}
+
+InstructionRecord move(unsigned to, unsigned from, uint32_t line) {
+    const PowerPCInstruction& mr = instructionAt(MR);
+    InstructionRecord record{};
+    record.word = mr.encoding.base_opcode | from << 21 | to << 16 | from << 11;
+    record.line = line;
+    record.symbol = SymbolTable::NONE;
+    record.id = MR;
+    return record;
+}
+
+const Field* branchField(const InstructionRecord& record) {
+    for (const Field& field : record.definition().encoding.fields) {
+        if (field.kind == FieldKind::BranchOffset) return &field;
+    }
+    return nullptr;
+}
+
+// A branch whose target is a displacement written as a number, not a label.
+const Field* numericBranch(const InstructionRecord& record) {
+    if (record.symbol != SymbolTable::NONE || (record.flags & (RECORD_INVALID | RECORD_AA)) != 0) return nullptr;
+    return branchField(record);
+}
+
+// A branch to a .text label; the branch field holds the addend.
+const Field* labelBranch(const InstructionRecord& record, const SymbolTable& symbols) {
+    if (record.symbol == SymbolTable::NONE || (record.flags & RECORD_INVALID) != 0) return nullptr;
+    const Symbol& target = symbols.at(record.symbol);
+    if (!target.defined || target.section != SectionId::Text) return nullptr;
+    return branchField(record);
+}
+
+}
+
+
+const char* peepholeRuleName(PeepholeRule rule) {
+    switch (rule) {
+        case PeepholeRule::SelfMove: return "mr rX,rX";
+        case PeepholeRule::MoveBack: return "mr rX,rY; mr rY,rX";
+        case PeepholeRule::AddZero: return "addi rX,rX,0";
+        case PeepholeRule::StoreLoad: return "stw; lwz from the same slot";
+    }
+    return "?";
+}
+
+
+void PeepholeStats::print(std::ostream& out) const {
+    if (skipped) {
+        out << "peephole: skipped, .text holds data\n";
+        return;
+    }
+    out << "peephole: " << examined << " instructions, " << removed << " removed, " << rewritten
+        << " rewritten, ~" << cyclesSaved << " cycles saved\n";
+    for (size_t rule = 0; rule < PEEPHOLE_RULE_COUNT; rule++) {
+        if (fired[rule] == 0) continue;
+        out << "  " << peepholeRuleName(static_cast<PeepholeRule>(rule)) << ": " << fired[rule] << "\n";
+    }
+}
+
+
+PeepholeStats PeepholeOptimizer::run(std::vector<InstructionRecord>& code) {
+    const size_t count = code.size();
+    PeepholeStats stats;
+    stats.examined = count;
+
+    // Where control can arrive other than from the instruction before:
+    // .text labels and the targets of branches, label plus addend or
+    // numeric, as prefix counts by index.
+    std::vector<uint32_t> targetsUpTo(count + 1, 0);
+    auto mark = [&](int64_t address) {
+        if (address >= 0 && address < int64_t(count) * 4) targetsUpTo[address / 4 + 1] = 1;
+    };
+    for (uint32_t id = 0; id < symbols.size(); id++) {
+        const Symbol& symbol = symbols.at(id);
+        if (symbol.defined && symbol.section == SectionId::Text) mark(symbol.address);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (const Field* field = numericBranch(code[i])) {
+            mark(int64_t(i) * 4 + PowerPCEncoder::readOperand(*field, code[i].word));
+        } else if (const Field* field = labelBranch(code[i], symbols)) {
+            mark(int64_t(symbols.at(code[i].symbol).address) + PowerPCEncoder::readOperand(*field, code[i].word));
+        }
+    }
+    for (size_t i = 0; i < count; i++) targetsUpTo[i + 1] += targetsUpTo[i];
+
+    std::vector<InstructionRecord> out;
+    std::vector<uint32_t> origin;
+    out.reserve(count);
+    origin.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        out.push_back(code[i]);
+        origin.push_back(static_cast<uint32_t>(i));
+        while (reduce(out, origin, targetsUpTo, stats)) {}
+    }
+    if (out.size() == count) {
+        code = std::move(out);
+        return stats;
+    }
+
+    // New address of an old one: the number of surviving instructions before
+    // it, so that a label on a removed instruction lands on the next one.
+    std::vector<uint32_t> keptBefore(count + 1, 0);
+    for (uint32_t index : origin) keptBefore[index + 1] = 1;
+    for (size_t i = 0; i < count; i++) keptBefore[i + 1] += keptBefore[i];
+    const int64_t shrink = int64_t(count - out.size()) * 4;
+    auto relocate = [&](int64_t address) -> int64_t {
+        if (address < 0) return address;
+        if (address >= int64_t(count) * 4) return address - shrink;
+        return int64_t(keptBefore[address / 4]) * 4 + address % 4;
+    };
+
+    // A label branch keeps aiming at the instruction it aimed at, which
+    // need not move with the label: its addend becomes the distance between
+    // the two after the move.
+    for (InstructionRecord& record : out) {
+        const Field* field = labelBranch(record, symbols);
+        if (field == nullptr) continue;
+        const int64_t label = symbols.at(record.symbol).address;
+        const int64_t target = label + PowerPCEncoder::readOperand(*field, record.word);
+        const auto addend = static_cast<int32_t>(relocate(target) - relocate(label));
+        record.word = (record.word & ~field->mask) | PowerPCEncoder::placeOperand(*field, addend);
+    }
+    for (uint32_t id = 0; id < symbols.size(); id++) {
+        const Symbol& symbol = symbols.at(id);
+        if (symbol.defined && symbol.section == SectionId::Text) {
+            symbols.move(id, static_cast<uint32_t>(relocate(symbol.address)));
+        }
+    }
+    // Displacements and addends only shrink or keep their size, so they
+    // still fit.
+    for (size_t i = 0; i < out.size(); i++) {
+        InstructionRecord& record = out[i];
+        const Field* field = numericBranch(record);
+        if (field == nullptr) continue;
+        const int64_t target = int64_t(origin[i]) * 4 + PowerPCEncoder::readOperand(*field, record.word);
+        const auto displacement = static_cast<int32_t>(relocate(target) - int64_t(i) * 4);
+        record.word = (record.word & ~field->mask) | PowerPCEncoder::placeOperand(*field, displacement);
+    }
+
+    code = std::move(out);
+    return stats;
+}
+
+
+// Applies the first rule that matches the end of `out` and says whether one
+// did. `origin` holds the index each record had in the input.
+bool PeepholeOptimizer::reduce(std::vector<InstructionRecord>& out, std::vector<uint32_t>& origin,
+                               const std::vector<uint32_t>& targetsUpTo, PeepholeStats& stats) {
+    auto drop = [&](PeepholeRule rule, unsigned cycles) {
+        out.pop_back();
+        origin.pop_back();
+        stats.removed++;
+        stats.cyclesSaved += cycles;
+        stats.fired[static_cast<size_t>(rule)]++;
+        return true;
+    };
+
+    if (out.empty()) return false;
+    const InstructionRecord& last = out.back();
+    const uint32_t word = last.word;
+    // Only as spelled "mr": or rX,rX,rX with some registers is a priority
+    // hint on POWER cores.
+    if (last.id == MR && rA(word) == rD(word) && removable(last)) return drop(PeepholeRule::SelfMove, ALU_CYCLES);
+    if (is(last, ADDI) && rA(word) != 0 && rA(word) == rD(word) && d(word) == 0 && removable(last)) {
+        return drop(PeepholeRule::AddZero, ALU_CYCLES);
+    }
+
+    static_assert(WINDOW == 2, "the rules below look at two records");
+    if (out.size() < WINDOW) return false;
+    const size_t at = out.size() - 1;
+    if (targetsUpTo[origin[at] + 1] != targetsUpTo[origin[at - 1] + 1]) return false;
+    const InstructionRecord& before = out[at - 1];
+    const uint32_t previous = before.word;
+
+    if (isMove(before) && isMove(last) && rA(word) == rD(previous) && rD(word) == rA(previous) && removable(last)) {
+        return drop(PeepholeRule::MoveBack, ALU_CYCLES);
+    }
+
+    // The slot was just written, so the load can only see rS. This assumes
+    // ordinary memory: a device register may read back something else.
+    if (is(before, STW) && is(last, LWZ) && rA(word) == rA(previous) && d(word) == d(previous)) {
+        const unsigned stored = rD(previous);
+        if (rD(word) == stored) return drop(PeepholeRule::StoreLoad, LOAD_CYCLES);
+        out[at] = move(rD(word), stored, last.line);
+        stats.rewritten++;
+        stats.cyclesSaved += LOAD_CYCLES - ALU_CYCLES;
+        stats.fired[static_cast<size_t>(PeepholeRule::StoreLoad)]++;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+#ifndef PPCASM_PEEPHOLEOPTIMIZER_H
+#define PPCASM_PEEPHOLEOPTIMIZER_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "InstructionRecord.h"
+#include "SymbolTable.h"
+
+
+enum class PeepholeRule : uint8_t {
+    SelfMove,       // mr rX,rX (the or rX,rX,rX spelling may be a hint and stays)
+    MoveBack,       // mr rX,rY; mr rY,rX: the second copies rX back to itself
+    AddZero,        // addi rX,rX,0 with rX not r0
+    StoreLoad,      // stw rS,d(rA); lwz rD,d(rA): the load becomes mr rD,rS, or goes
+};
+
+inline constexpr size_t PEEPHOLE_RULE_COUNT = 4;
+
+const char* peepholeRuleName(PeepholeRule rule);
+
+
+struct PeepholeStats {
+    size_t examined = 0;
+    size_t removed = 0;
+    size_t rewritten = 0;
+    // Single-issue estimate from fixed per-class costs, not a pipeline model.
+    uint64_t cyclesSaved = 0;
+    std::array<size_t, PEEPHOLE_RULE_COUNT> fired{};
+    // Set by the assembler when .text holds data and the pass did not run.
+    bool skipped = false;
+
+    void print(std::ostream& out) const;
+};
+
+
+// Pattern rewrites over a .text instruction stream as PowerPCParser::parse()
+// returns it, record i at address 4 * i. Each record is pushed onto the
+// output and the rules look at the last WINDOW records there, so a removal
+// can bring a new pair together (stw; addi r1,r1,0; lwz folds too). A pair
+// rule never spans a label, nor the target of a branch (numeric, or label
+// plus addend), since control may enter between the two. An instruction
+// whose flag effects are not empty (mr., addi with Rc, ...) is never
+// removed: RegisterEffects says what it writes besides its GPR.
+//
+// Removing an instruction moves everything after it, so run() gives the
+// .text labels in `symbols` their new addresses and re-aims branches with a
+// numeric displacement. A branch to a label gets the addend that reaches
+// the same instruction from the moved label, and is resolved when emitted.
+class PeepholeOptimizer {
+public:
+    static constexpr size_t WINDOW = 2;
+
+    explicit PeepholeOptimizer(SymbolTable& symbols) : symbols(symbols) {}
+
+    PeepholeStats run(std::vector<InstructionRecord>& code);
+
+private:
+    bool reduce(std::vector<InstructionRecord>& out, std::vector<uint32_t>& origin,
+                const std::vector<uint32_t>& targetsUpTo, PeepholeStats& stats);
+
+    SymbolTable& symbols;
+};
+
+
+#endif //PPCASM_PEEPHOLEOPTIMIZER_H
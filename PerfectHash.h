@@ -0,0 +1,126 @@
+#ifndef PPCASM_PERFECTHASH_H
+#define PPCASM_PERFECTHASH_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace perfect_hash {
+
+constexpr uint64_t hash(std::string_view key) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+constexpr uint32_t slotHash(uint64_t h, uint32_t displacement) {
+    uint64_t x = h + displacement * 0x9e3779b97f4a7c15ull;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return static_cast<uint32_t>(x);
+}
+
+constexpr size_t slotCount(size_t keys) {
+    size_t slots = 1;
+    while (slots < 2 * keys) slots <<= 1;
+    return slots;
+}
+
+}
+
+// Minimal perfect hash over a fixed key set, built at compile time with the
+// hash-and-displace scheme: keys are grouped into buckets by one half of a
+// 64-bit FNV-1a hash, and every bucket gets a displacement that moves all of
+// its keys into free slots. A lookup is one pass over the key's bytes, two
+// table reads and one string compare.
+template <size_t N>
+class PerfectHash {
+public:
+    static constexpr size_t SLOTS = perfect_hash::slotCount(N);
+    static constexpr size_t BUCKETS = N / 2 + 1;
+    static constexpr uint16_t EMPTY = UINT16_MAX;
+    static_assert(N < EMPTY, "PerfectHash indexes keys with 16 bits");
+
+    constexpr explicit PerfectHash(const std::array<std::string_view, N>& keys)
+            : keys(keys), displacement(), slots() {
+        std::array<uint64_t, N> hashes{};
+        std::array<size_t, BUCKETS + 1> bucketStart{};
+        for (size_t i = 0; i < N; i++) {
+            hashes[i] = perfect_hash::hash(keys[i]);
+            bucketStart[bucketOf(hashes[i]) + 1]++;
+        }
+        for (size_t b = 0; b < BUCKETS; b++) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+
+        std::array<uint16_t, N> members{};
+        std::array<size_t, BUCKETS> fill{};
+        for (size_t i = 0; i < N; i++) {
+            size_t b = bucketOf(hashes[i]);
+            members[bucketStart[b] + fill[b]++] = static_cast<uint16_t>(i);
+        }
+
+        for (size_t s = 0; s < SLOTS; s++) slots[s] = EMPTY;
+
+        size_t largest = 0;
+        for (size_t b = 0; b < BUCKETS; b++) {
+            if (fill[b] > largest) largest = fill[b];
+        }
+
+        // Place the largest buckets first, while the table is still empty.
+        std::array<uint32_t, N> placed{};
+        for (size_t size = largest; size > 0; size--) {
+            for (size_t b = 0; b < BUCKETS; b++) {
+                if (fill[b] != size) continue;
+
+                uint32_t d = 0;
+                while (!tryPlace(hashes, members, bucketStart[b], size, d, placed)) {
+                    if (++d == UINT16_MAX) throw std::logic_error("PerfectHash: duplicate keys");
+                }
+                displacement[b] = static_cast<uint16_t>(d);
+                for (size_t k = 0; k < size; k++) {
+                    slots[placed[k]] = members[bucketStart[b] + k];
+                }
+            }
+        }
+    }
+
+    // Index of `key` in the key array, or -1.
+    constexpr int find(std::string_view key) const {
+        uint64_t h = perfect_hash::hash(key);
+        uint16_t index = slots[perfect_hash::slotHash(h, displacement[bucketOf(h)]) & (SLOTS - 1)];
+        return index != EMPTY && keys[index] == key ? index : -1;
+    }
+
+private:
+    static constexpr size_t bucketOf(uint64_t h) {
+        return static_cast<size_t>(h >> 32) % BUCKETS;
+    }
+
+    constexpr bool tryPlace(const std::array<uint64_t, N>& hashes, const std::array<uint16_t, N>& members,
+                            size_t first, size_t count, uint32_t d, std::array<uint32_t, N>& placed) const {
+        for (size_t k = 0; k < count; k++) {
+            uint32_t slot = perfect_hash::slotHash(hashes[members[first + k]], d) & (SLOTS - 1);
+            if (slots[slot] != EMPTY) return false;
+            for (size_t j = 0; j < k; j++) {
+                if (placed[j] == slot) return false;
+            }
+            placed[k] = slot;
+        }
+        return true;
+    }
+
+    std::array<std::string_view, N> keys;
+    std::array<uint16_t, BUCKETS> displacement;
+    std::array<uint16_t, SLOTS> slots;
+};
+
+
+#endif //PPCASM_PERFECTHASH_H
@@ -0,0 +1,393 @@
+#include "PipelineAnalyzer.h"
+#include <algorithm>
+#include <array>
+#include "FlagLiveness.h"
+#include "PowerPCEncoder.h"
+
+using FieldKind = PowerPCInstruction::Encoding::FieldKind;
+using Field = PowerPCInstruction::Encoding::Field;
+
+
+struct PipelineAnalyzer::Step {
+    const ClassTiming* timing;
+    unsigned repeat;            // registers a load or store multiple moves
+    bool serializing;
+    std::vector<uint8_t> reads;
+    std::vector<uint8_t> writes;
+};
+
+
+namespace {
+
+constexpr size_t NO_STEP = SIZE_MAX;
+
+constexpr InstructionId B = instructionId("b");
+constexpr InstructionId BC = instructionId("bc");
+constexpr InstructionId BCLR = instructionId("bclr");
+constexpr InstructionId BCCTR = instructionId("bcctr");
+constexpr InstructionId MTSPR = instructionId("mtspr");
+constexpr InstructionId MFSPR = instructionId("mfspr");
+constexpr InstructionId LMW = instructionId("lmw");
+constexpr InstructionId STMW = instructionId("stmw");
+constexpr InstructionId LSWI = instructionId("lswi");
+constexpr InstructionId STSWI = instructionId("stswi");
+
+constexpr unsigned SPR_LR = 8;
+constexpr unsigned SPR_CTR = 9;
+
+constexpr unsigned bo(uint32_t word) { return word >> 21 & 31; }
+constexpr unsigned spr(uint32_t word) { return (word >> 16 & 31) | (word >> 11 & 31) << 5; }
+
+// Register operand value by syntax name, from the field it occupies.
+int registerOperand(std::string_view name, uint32_t word) {
+    if (name == "rD" || name == "rS" || name == "frD" || name == "frS") return word >> 21 & 31;
+    if (name == "rA" || name == "frA") return word >> 16 & 31;
+    if (name == "rB" || name == "frB") return word >> 11 & 31;
+    if (name == "frC") return word >> 6 & 31;
+    return -1;
+}
+
+void addFlags(FlagSet set, std::vector<uint8_t>& out) {
+    for (unsigned bit = 0; bit < 32; bit++) {
+        if ((set & flags::crBit(bit)) != 0) out.push_back(static_cast<uint8_t>(resource::CR + bit));
+    }
+    if ((set & flags::SO) != 0) out.push_back(resource::SO);
+    if ((set & flags::OV) != 0) out.push_back(resource::OV);
+    if ((set & flags::CA) != 0) out.push_back(resource::CA);
+}
+
+const Field* branchField(const InstructionRecord& record) {
+    for (const Field& field : record.definition().encoding.fields) {
+        if (field.kind == FieldKind::BranchOffset) return &field;
+    }
+    return nullptr;
+}
+
+// Absolute target of a relative branch at `index`, or -1 when it has none
+// or it goes through an undefined or non-.text label.
+int64_t branchTarget(const InstructionRecord& record, size_t index, const SymbolTable* symbols) {
+    if ((record.flags & (RECORD_INVALID | RECORD_AA)) != 0) return -1;
+    const Field* field = branchField(record);
+    if (field == nullptr) return -1;
+    const int32_t value = PowerPCEncoder::readOperand(*field, record.word);
+    if (record.symbol == SymbolTable::NONE) return int64_t(index) * 4 + value;
+    if (symbols == nullptr) return -1;
+    const Symbol& symbol = symbols->at(record.symbol);
+    if (!symbol.defined || symbol.section != SectionId::Text) return -1;
+    return int64_t(symbol.address) + value;
+}
+
+bool endsBlock(const InstructionRecord& record) {
+    const TimingClass timing = record.definition().timing;
+    return timing == TimingClass::Branch || timing == TimingClass::Sync;
+}
+
+// What one instruction reads and writes. Register roles come from the
+// operand names in its syntax and the pseudocode of its base instruction:
+// rA is only a destination where the pseudocode assigns it without reading
+// it, and reads as zero where the pseudocode says so (rA|0, rA = 0, every
+// effective address). Condition state comes from flagEffects().
+void operands(const InstructionRecord& record, std::vector<uint8_t>& reads, std::vector<uint8_t>& writes) {
+    reads.clear();
+    writes.clear();
+    if ((record.flags & RECORD_INVALID) != 0) return;
+
+    const InstructionId base = baseInstruction(record.id);
+    const std::string_view pseudocode = instructionAt(base).pseudocode;
+    auto mentions = [&](std::string_view text) { return pseudocode.find(text) != std::string_view::npos; };
+    const bool memory = mentions("EA");
+    const bool writesA = mentions("rA ←");
+    const bool zeroA = memory || mentions("rA = 0") || mentions("rA|0");
+    const uint32_t word = record.word;
+
+    const std::string_view syntax = record.syntax().syntax;
+    size_t start = 0;
+    while (start < syntax.size()) {
+        size_t end = start;
+        while (end < syntax.size() && !isa::isSyntaxSeparator(syntax[end])) end++;
+        const std::string_view name = syntax.substr(start, end - start);
+        start = end + 1;
+        const int value = registerOperand(name, word);
+        if (value < 0) continue;
+        const auto gpr = static_cast<uint8_t>(resource::GPR + value);
+        const auto fpr = static_cast<uint8_t>(resource::FPR + value);
+
+        if (name == "rD") {
+            const unsigned last = base == LMW ? 31 : static_cast<unsigned>(value);
+            for (unsigned r = value; r <= last; r++) writes.push_back(static_cast<uint8_t>(resource::GPR + r));
+        } else if (name == "rS") {
+            const unsigned last = base == STMW ? 31 : static_cast<unsigned>(value);
+            for (unsigned r = value; r <= last; r++) reads.push_back(static_cast<uint8_t>(resource::GPR + r));
+        } else if (name == "rA") {
+            if ((!writesA || mentions("(rA)") || memory) && !(zeroA && value == 0)) reads.push_back(gpr);
+            if (writesA) writes.push_back(gpr);
+        } else if (name == "rB") {
+            reads.push_back(gpr);
+        } else if (name == "frD") {
+            writes.push_back(fpr);
+        } else {
+            reads.push_back(fpr);
+        }
+    }
+
+    const FlagEffects effects = flagEffects(record);
+    addFlags(effects.uses, reads);
+    addFlags(effects.defines, writes);
+
+    if (base == B || base == BC || base == BCLR || base == BCCTR) {
+        if ((base == BC || base == BCLR) && (bo(word) & 4) == 0) {
+            reads.push_back(resource::CTR);
+            writes.push_back(resource::CTR);
+        }
+        if (base == BCLR) reads.push_back(resource::LR);
+        if (base == BCCTR) reads.push_back(resource::CTR);
+        if ((word & 1) != 0) writes.push_back(resource::LR);
+    } else if (base == MTSPR || base == MFSPR) {
+        const unsigned number = spr(word);
+        if (number == SPR_LR || number == SPR_CTR) {
+            const auto special = static_cast<uint8_t>(number == SPR_LR ? resource::LR : resource::CTR);
+            (base == MTSPR ? writes : reads).push_back(special);
+        }
+    }
+}
+
+unsigned repeatCount(const InstructionRecord& record) {
+    const InstructionId base = baseInstruction(record.id);
+    const unsigned first = record.word >> 21 & 31;
+    if (base == LMW || base == STMW) return 32 - first;
+    if (base == LSWI || base == STSWI) {
+        const unsigned bytes = record.word >> 11 & 31;
+        return bytes == 0 ? 8 : (bytes + 3) / 4;
+    }
+    return 1;
+}
+
+}
+
+
+std::string resourceName(unsigned resource) {
+    static const char* const BITS[] = {"lt", "gt", "eq", "so"};
+    if (resource < resource::FPR) return "r" + std::to_string(resource - resource::GPR);
+    if (resource < resource::CR) return "f" + std::to_string(resource - resource::FPR);
+    if (resource < resource::SO) {
+        const unsigned bit = resource - resource::CR;
+        return "cr" + std::to_string(bit / 4) + "." + BITS[bit % 4];
+    }
+    switch (resource) {
+        case resource::SO: return "xer.so";
+        case resource::OV: return "xer.ov";
+        case resource::CA: return "xer.ca";
+        case resource::LR: return "lr";
+        case resource::CTR: return "ctr";
+        default: return "?";
+    }
+}
+
+
+std::vector<BlockAnalysis> PipelineAnalyzer::analyze(const std::vector<InstructionRecord>& code) const {
+    const size_t count = code.size();
+    std::vector<bool> leader(count + 1, false);
+    std::vector<uint32_t> labelAt(count, SymbolTable::NONE);
+    leader[0] = true;
+    if (symbols != nullptr) {
+        for (uint32_t id = 0; id < symbols->size(); id++) {
+            const Symbol& symbol = symbols->at(id);
+            if (!symbol.defined || symbol.section != SectionId::Text || symbol.address / 4 >= count) continue;
+            leader[symbol.address / 4] = true;
+            if (labelAt[symbol.address / 4] == SymbolTable::NONE) labelAt[symbol.address / 4] = id;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!endsBlock(code[i])) continue;
+        leader[i + 1] = true;
+        const int64_t target = branchTarget(code[i], i, nullptr);
+        if (target >= 0 && target < int64_t(count) * 4) leader[target / 4] = true;
+    }
+
+    std::vector<BlockAnalysis> blocks;
+    std::vector<Step> steps;
+    size_t first = 0;
+    for (size_t i = 1; i <= count; i++) {
+        if (!leader[i] && i != count) continue;
+        if (i == first) continue;
+
+        BlockAnalysis block;
+        block.first = first;
+        block.count = i - first;
+        block.label = labelAt[first];
+        steps.resize(block.count);
+        for (size_t k = 0; k < block.count; k++) {
+            const InstructionRecord& record = code[first + k];
+            Step& step = steps[k];
+            step.timing = &core.of(record.definition());
+            step.repeat = repeatCount(record);
+            step.serializing = record.definition().timing == TimingClass::Sync;
+            operands(record, step.reads, step.writes);
+        }
+        run(steps, 1, &block);
+
+        const InstructionRecord& last = code[i - 1];
+        if (last.definition().timing == TimingClass::Branch &&
+            branchTarget(last, i - 1, symbols) == int64_t(first) * 4) {
+            const std::vector<unsigned> ends = run(steps, LOOP_PASSES, nullptr);
+            // The second half only, past the ramp-up of the first passes.
+            constexpr unsigned HALF = LOOP_PASSES / 2;
+            block.loopCycles = double(ends[LOOP_PASSES - 1] - ends[HALF - 1]) / HALF;
+        }
+        blocks.push_back(std::move(block));
+        first = i;
+    }
+    return blocks;
+}
+
+
+std::vector<unsigned> PipelineAnalyzer::run(const std::vector<Step>& steps, unsigned passes,
+                                            BlockAnalysis* block) const {
+    std::vector<unsigned> ends(passes, 0);
+    std::array<unsigned, resource::COUNT> ready{};
+    // Cycles each port is taken, so that an instruction whose inputs are
+    // ready early can use a gap left before one that waited.
+    std::vector<std::vector<bool>> taken(core.ports.size());
+    auto freeFrom = [&](size_t port, unsigned from, unsigned length) {
+        const std::vector<bool>& cycles = taken[port];
+        unsigned at = from;
+        for (unsigned c = at; c < at + length && c < cycles.size(); c++) {
+            if (cycles[c]) at = c + 1;
+        }
+        return at;
+    };
+    unsigned done = 0;
+    size_t slot = 0;
+
+    // Critical chain of the first pass, by latency alone.
+    std::array<size_t, resource::COUNT> producer;
+    producer.fill(NO_STEP);
+    std::vector<unsigned> chainLength(steps.size(), 0);
+    std::vector<size_t> previous(steps.size(), NO_STEP);
+    std::vector<unsigned> via(steps.size(), resource::NONE);
+    if (block != nullptr) block->portCycles.assign(core.ports.size(), 0);
+
+    for (unsigned pass = 0; pass < passes; pass++) {
+        const bool detail = block != nullptr && pass == 0;
+        for (size_t k = 0; k < steps.size(); k++) {
+            const Step& step = steps[k];
+            const ClassTiming& timing = *step.timing;
+            unsigned start = static_cast<unsigned>(slot++ / core.issueWidth);
+            for (uint8_t r : step.reads) start = std::max(start, ready[r]);
+            if (step.serializing) start = std::max(start, done);
+
+            unsigned latency = 0;
+            if (timing.implemented()) {
+                const unsigned busy = timing.occupancy * step.repeat;
+                size_t port = CoreModel::MAX_PORTS;
+                unsigned earliest = 0;
+                for (size_t p = 0; p < core.ports.size(); p++) {
+                    if ((timing.ports & 1u << p) == 0) continue;
+                    const unsigned at = freeFrom(p, start, busy);
+                    if (port == CoreModel::MAX_PORTS || at < earliest) {
+                        port = p;
+                        earliest = at;
+                    }
+                }
+                start = earliest;
+                std::vector<bool>& cycles = taken[port];
+                if (cycles.size() < start + busy) cycles.resize(start + busy, false);
+                std::fill(cycles.begin() + start, cycles.begin() + start + busy, true);
+                if (detail) block->portCycles[port] += busy;
+                latency = timing.latency + step.repeat - 1;
+            } else if (detail) {
+                block->unimplemented++;
+            }
+
+            const unsigned finish = start + latency;
+            for (uint8_t w : step.writes) ready[w] = finish;
+            done = std::max(done, finish);
+
+            if (detail) {
+                for (uint8_t r : step.reads) {
+                    const size_t from = producer[r];
+                    if (from != NO_STEP && (previous[k] == NO_STEP || chainLength[from] > chainLength[previous[k]])) {
+                        previous[k] = from;
+                        via[k] = r;
+                    }
+                }
+                chainLength[k] = latency + (previous[k] == NO_STEP ? 0 : chainLength[previous[k]]);
+                for (uint8_t w : step.writes) producer[w] = k;
+            }
+        }
+        const auto dispatched = static_cast<unsigned>((slot + core.issueWidth - 1) / core.issueWidth);
+        ends[pass] = std::max(done, dispatched);
+    }
+
+    if (block != nullptr) {
+        block->cycles = ends[0];
+        block->dispatchBound = static_cast<unsigned>((steps.size() + core.issueWidth - 1) / core.issueWidth);
+        size_t end = 0;
+        for (size_t k = 1; k < steps.size(); k++) {
+            if (chainLength[k] > chainLength[end]) end = k;
+        }
+        block->chainBound = steps.empty() ? 0 : chainLength[end];
+        block->chain.clear();
+        for (size_t k = end; k != NO_STEP && !steps.empty(); k = previous[k]) {
+            block->chain.push_back(BlockAnalysis::Link{block->first + k, via[k]});
+        }
+        std::reverse(block->chain.begin(), block->chain.end());
+    }
+    return ends;
+}
+
+
+void PipelineAnalyzer::print(std::ostream& out, const std::vector<InstructionRecord>& code,
+                             const std::vector<BlockAnalysis>& blocks) const {
+    out << core.name << ": " << core.issueWidth << "-wide dispatch, ports";
+    for (std::string_view port : core.ports) out << " " << port;
+    out << "\n";
+
+    unsigned total = 0;
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const BlockAnalysis& block = blocks[b];
+        const InstructionRecord& first = code[block.first];
+        const InstructionRecord& last = code[block.first + block.count - 1];
+        total += block.cycles;
+
+        out << "\nblock " << b;
+        if (block.label != SymbolTable::NONE && symbols != nullptr) out << " " << symbols->name(block.label);
+        if (first.line == last.line) {
+            out << ", line " << first.line;
+        } else {
+            out << ", lines " << first.line << "-" << last.line;
+        }
+        out << ", " << block.count << (block.count == 1 ? " instruction: " : " instructions: ") << block.cycles
+            << (block.cycles == 1 ? " cycle" : " cycles");
+        if (block.loopCycles > 0) {
+            // Two decimals without touching the stream's format flags.
+            const auto hundredths = static_cast<unsigned>(block.loopCycles * 100 + 0.5);
+            out << ", " << hundredths / 100 << "." << hundredths / 10 % 10 << hundredths % 10 << " per iteration";
+        }
+        out << "\n  bounds: dispatch " << block.dispatchBound << ", critical chain " << block.chainBound << "\n";
+
+        if (block.chain.size() > 1) {
+            out << "  critical chain:";
+            for (const BlockAnalysis::Link& link : block.chain) {
+                if (link.via != resource::NONE) out << " -> " << resourceName(link.via) << " ->";
+                out << " line " << code[link.index].line << " " << code[link.index].syntax().mnemonic;
+            }
+            out << "\n";
+        }
+
+        out << "  port pressure:";
+        bool any = false;
+        for (size_t p = 0; p < block.portCycles.size(); p++) {
+            if (block.portCycles[p] == 0) continue;
+            out << " " << core.ports[p] << " " << block.portCycles[p];
+            if (block.cycles != 0) out << " (" << block.portCycles[p] * 100 / block.cycles << "%)";
+            any = true;
+        }
+        out << (any ? "\n" : " none\n");
+        if (block.unimplemented != 0) {
+            out << "  " << block.unimplemented << " not implemented on " << core.name << ", emulated; not counted\n";
+        }
+    }
+    out << "\ntotal " << total << " cycles in " << blocks.size() << (blocks.size() == 1 ? " block" : " blocks")
+        << ", one pass each\n";
+}
@@ -0,0 +1,95 @@
+#ifndef PPCASM_PIPELINEANALYZER_H
+#define PPCASM_PIPELINEANALYZER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "InstructionRecord.h"
+#include "PipelineModel.h"
+#include "SymbolTable.h"
+
+
+// Registers dependences are tracked through: GPRs, FPRs, each CR bit,
+// XER[SO], XER[OV], XER[CA], LR and CTR.
+namespace resource {
+inline constexpr unsigned GPR = 0;
+inline constexpr unsigned FPR = 32;
+inline constexpr unsigned CR = 64;     // + architected bit number
+inline constexpr unsigned SO = 96;
+inline constexpr unsigned OV = 97;
+inline constexpr unsigned CA = 98;
+inline constexpr unsigned LR = 99;
+inline constexpr unsigned CTR = 100;
+inline constexpr unsigned COUNT = 101;
+inline constexpr unsigned NONE = COUNT;
+}
+
+// "r3", "f1", "cr0.eq", "xer.ca", "lr", ...
+std::string resourceName(unsigned resource);
+
+
+// One basic block and what the model predicts for it.
+struct BlockAnalysis {
+    // A step of the critical chain: the instruction, and the register through
+    // which it waited for the step before (resource::NONE for the first).
+    struct Link {
+        size_t index;
+        unsigned via;
+    };
+
+    size_t first = 0;                       // index of the first record
+    size_t count = 0;
+    uint32_t label = SymbolTable::NONE;     // a .text label at its start
+    // One pass with every input ready at cycle 0, and what bounds it.
+    unsigned cycles = 0;
+    unsigned dispatchBound = 0;
+    unsigned chainBound = 0;                // the critical chain, ports ignored
+    // For a block that branches back to its own start, cycles per iteration
+    // once iterations overlap; otherwise 0.
+    double loopCycles = 0;
+    std::vector<Link> chain;
+    std::vector<unsigned> portCycles;       // busy cycles per port of the core
+    size_t unimplemented = 0;               // not counted, see ClassTiming
+};
+
+
+// A static pipeline model in the manner of llvm-mca, over a .text stream as
+// PowerPCParser::parse() returns it (record i at address 4 * i). The stream
+// is cut into basic blocks at labels, numeric branch targets and after
+// branches. Each block is scheduled on its own: instructions dispatch in
+// order, issueWidth per cycle, then issue out of order on the first cycle
+// their inputs are ready and one of their ports is free, and take the
+// latency and occupancy of their timing class. Memory
+// dependences, caches and branch prediction are not modelled; a load always
+// hits and a branch always costs its latency.
+class PipelineAnalyzer {
+public:
+    // Passes of a loop body scheduled back to back to find its steady state.
+    static constexpr unsigned LOOP_PASSES = 8;
+
+    // `symbols` gives the labels that start blocks and name them; without it
+    // only numeric branch targets do.
+    explicit PipelineAnalyzer(const CoreModel& core, const SymbolTable* symbols = nullptr)
+            : core(core), symbols(symbols) {}
+
+    std::vector<BlockAnalysis> analyze(const std::vector<InstructionRecord>& code) const;
+
+    void print(std::ostream& out, const std::vector<InstructionRecord>& code,
+               const std::vector<BlockAnalysis>& blocks) const;
+
+private:
+    struct Step;
+
+    // Schedules `passes` copies of the block back to back and returns the
+    // cycle each pass is done by. The first pass fills in `block`, if given.
+    std::vector<unsigned> run(const std::vector<Step>& steps, unsigned passes, BlockAnalysis* block) const;
+
+    const CoreModel& core;
+    const SymbolTable* symbols;
+};
+
+
+#endif //PPCASM_PIPELINEANALYZER_H
@@ -0,0 +1,141 @@
+#ifndef PPCASM_PIPELINEMODEL_H
+#define PPCASM_PIPELINEMODEL_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "PowerPCInstruction.h"
+
+
+// What one timing class costs on one core: cycles until the result can be
+// used, cycles the port stays busy (the reciprocal throughput), and the
+// ports that can take it, one bit per CoreModel::ports entry. No ports means
+// the core does not implement the class and traps to emulation.
+struct ClassTiming {
+    uint8_t latency = 0;
+    uint8_t occupancy = 0;
+    uint16_t ports = 0;
+
+    constexpr bool implemented() const { return ports != 0; }
+};
+
+
+// Static description of a core, as a static analyzer sees it: how many
+// instructions it dispatches per cycle, its execution ports, and one timing
+// row per TimingClass. Like the instruction table these are constexpr data.
+struct CoreModel {
+    static constexpr size_t MAX_PORTS = 12;
+
+    std::string_view name;
+    unsigned issueWidth;
+    FixedList<std::string_view, MAX_PORTS> ports;
+    std::array<ClassTiming, TIMING_CLASS_COUNT> timing;
+
+    constexpr const ClassTiming& operator[](TimingClass timingClass) const {
+        return timing[static_cast<size_t>(timingClass)];
+    }
+    constexpr const ClassTiming& of(const PowerPCInstruction& instruction) const {
+        return (*this)[instruction.timing];
+    }
+};
+
+
+// Rounded figures from the core reference manuals, in TimingClass order.
+// Data-dependent latencies (divides, FPSCR moves) are the long case. Good for
+// ranking variants of a loop, not for predicting a cycle count to the cycle.
+namespace cores {
+
+// e500v2: two simple units, a multiple-cycle unit, branch and load/store.
+// Floating point is SPE, so classic FP instructions, loads and stores
+// included, trap.
+namespace e500 {
+inline constexpr uint16_t SU1 = 1, SU2 = 2, MU = 4, BU = 8, LSU = 16;
+}
+
+inline constexpr CoreModel E500{
+        "e500", 2, {"SU1", "SU2", "MU", "BU", "LSU"},
+        {{
+                {1, 1, e500::SU1 | e500::SU2},  // IntSimple
+                {1, 1, e500::SU1 | e500::SU2},  // IntCompare
+                {4, 1, e500::MU},               // IntMultiply
+                {35, 35, e500::MU},             // IntDivide: early-out ends it at 4, 11 or 19
+                {3, 1, e500::LSU},              // Load
+                {3, 1, e500::LSU},              // LoadMultiple
+                {3, 1, e500::LSU},              // Store
+                {3, 1, e500::LSU},              // StoreMultiple
+                {0, 0, 0},                      // FpLoad
+                {0, 0, 0},                      // FpStore
+                {0, 0, 0},                      // FpSimple
+                {0, 0, 0},                      // FpDivide
+                {0, 0, 0},                      // FpStatus
+                {1, 1, e500::BU},               // Branch
+                {1, 1, e500::BU},               // CrLogical
+                {2, 1, e500::SU1},              // CrMove
+                {4, 1, e500::SU1},              // SprMove
+                {3, 1, e500::LSU},              // Cache
+                {10, 10, e500::LSU},            // Sync
+        }}};
+
+// POWER9 in single-thread mode: six-wide dispatch into four execution
+// slices, each with a fixed-point and a vector-scalar pipe, four load/store
+// ports, a divider, a branch and a CR unit.
+namespace power9 {
+inline constexpr uint16_t EXS0 = 1, EXS1 = 2, EXS2 = 4, EXS3 = 8, DIV = 16, LS0 = 32, LS1 = 64, LS2 = 128,
+                          LS3 = 256, BR = 512, CR = 1024;
+inline constexpr uint16_t EXS = EXS0 | EXS1 | EXS2 | EXS3;
+inline constexpr uint16_t LS = LS0 | LS1 | LS2 | LS3;
+}
+
+inline constexpr CoreModel POWER9{
+        "power9", 6, {"EXS0", "EXS1", "EXS2", "EXS3", "DIV", "LS0", "LS1", "LS2", "LS3", "BR", "CR"},
+        {{
+                {2, 1, power9::EXS},            // IntSimple
+                {3, 1, power9::EXS},            // IntCompare
+                {5, 1, power9::EXS},            // IntMultiply
+                {23, 16, power9::DIV},          // IntDivide
+                {4, 1, power9::LS},             // Load
+                {4, 1, power9::LS},             // LoadMultiple
+                {3, 1, power9::LS},             // Store
+                {3, 1, power9::LS},             // StoreMultiple
+                {5, 1, power9::LS},             // FpLoad
+                {3, 1, power9::LS},             // FpStore
+                {7, 1, power9::EXS},            // FpSimple
+                {33, 26, power9::EXS},          // FpDivide
+                {7, 7, power9::EXS0},           // FpStatus
+                {2, 1, power9::BR},             // Branch
+                {2, 1, power9::CR},             // CrLogical
+                {6, 1, power9::CR},             // CrMove
+                {5, 1, power9::BR},             // SprMove
+                {4, 1, power9::LS},             // Cache
+                {20, 20, power9::LS0},          // Sync
+        }}};
+
+inline constexpr const CoreModel* ALL[] = {&E500, &POWER9};
+
+constexpr bool validate(const CoreModel& core) {
+    if (core.issueWidth == 0) return false;
+    for (const ClassTiming& row : core.timing) {
+        if (row.implemented() && (row.latency == 0 || row.occupancy == 0)) return false;
+        if ((row.ports >> core.ports.size()) != 0) return false;
+    }
+    // A row left out at the end would read as not implemented.
+    return core.timing[TIMING_CLASS_COUNT - 1].implemented();
+}
+
+static_assert(validate(E500) && validate(POWER9), "inconsistent core model");
+
+}
+
+
+// The core named `name` (case-sensitive, as in CoreModel::name), or nullptr.
+constexpr const CoreModel* findCore(std::string_view name) {
+    for (const CoreModel* core : cores::ALL) {
+        if (core->name == name) return core;
+    }
+    return nullptr;
+}
+
+
+#endif //PPCASM_PIPELINEMODEL_H
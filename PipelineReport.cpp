@@ -0,0 +1,63 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "lexer.h"
+#include "MappedFile.h"
+#include "PipelineAnalyzer.h"
+#include "PowerPCParser.h"
+
+// Static cycle estimates for a source file: pipeline-report [core] file.s.
+// The core is one of those in PipelineModel.h ("e500", "power9"); without
+// one, every core is reported. Instructions are only parsed, so labels keep
+// the addresses the parser gave them; data in .text would shift them, and
+// the file is refused rather than reported wrongly.
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " [core] file.s" << std::endl;
+        return 2;
+    }
+    const CoreModel* only = nullptr;
+    if (argc == 3) {
+        only = findCore(argv[1]);
+        if (only == nullptr) {
+            std::cerr << "unknown core " << argv[1] << "; known:";
+            for (const CoreModel* core : cores::ALL) std::cerr << " " << core->name;
+            std::cerr << std::endl;
+            return 2;
+        }
+    }
+
+    MappedFile file;
+    try {
+        file = MappedFile(argv[argc - 1]);
+    } catch (const std::runtime_error& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    const std::string_view source = file.view();
+    Lexer lexer(source);
+    SymbolTable symbols;
+    DiagnosticBuffer diagnostics;
+    Sections sections;
+    PowerPCParser parser(lexer, symbols, diagnostics, &sections);
+    const std::vector<InstructionRecord> code = parser.parse();
+    diagnostics.print(std::cerr);
+    if (diagnostics.getErrorCount() != 0) return 1;
+    if (!sections[SectionId::Text].empty()) {
+        std::cerr << "data in .text: move it to .data for the analysis" << std::endl;
+        return 1;
+    }
+    if (code.empty()) return 0;
+
+    bool first = true;
+    for (const CoreModel* core : cores::ALL) {
+        if (only != nullptr && core != only) continue;
+        if (!first) std::cout << "\n";
+        first = false;
+        PipelineAnalyzer analyzer(*core, &symbols);
+        analyzer.print(std::cout, code, analyzer.analyze(code));
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include "PowerPCDecoder.h"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include "PowerPCInstructionTable.h"
+
+using Field = PowerPCInstruction::Encoding::Field;
+using FieldKind = PowerPCInstruction::Encoding::FieldKind;
+
+static constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+
+namespace {
+
+constexpr uint16_t INVALID = UINT16_MAX;
+constexpr uint16_t SECONDARY = 0x8000;
+constexpr size_t SECONDARY_TABLES = 4;
+constexpr size_t EXTENDED = 1024;
+
+constexpr uint32_t primaryOf(uint32_t word) { return word >> 26; }
+constexpr uint32_t extendedOf(uint32_t word) { return (word >> 1) & (EXTENDED - 1); }
+
+constexpr size_t MAX_FIELDS = PowerPCInstruction::Encoding::MAX_FIELDS;
+constexpr uint8_t NO_VARIANT = UINT8_MAX;
+
+// Operand extraction as straight-line arithmetic:
+// value = int32((word & mask) >> shift << left) >> right, which covers
+// unsigned, sign-extended and word-scaled fields; unused slots have mask 0.
+struct FieldDecoder {
+    uint32_t mask = 0;
+    uint8_t shift = 0;
+    uint8_t left = 0;
+    uint8_t right = 0;
+    bool split = false;
+};
+
+struct InstructionDecoder {
+    std::array<FieldDecoder, MAX_FIELDS> fields{};
+    // Variant index by OE (bit 21), AA (bit 30) and Rc/LK (bit 31).
+    std::array<uint8_t, 8> variant{};
+    uint32_t controlMask = 0;
+    // Bits outside every field: the primary opcode, constants such as bit 30
+    // of sc, and reserved bits, which must be zero.
+    uint32_t fixedMask = 0;
+    uint32_t fixedBits = 0;
+};
+
+struct DecodeTable {
+    // Instruction index, SECONDARY | table number, or INVALID.
+    std::array<uint16_t, 64> primary{};
+    std::array<std::array<uint16_t, EXTENDED>, SECONDARY_TABLES> extended{};
+    std::array<InstructionDecoder, INSTRUCTION_COUNT> instructions{};
+};
+
+constexpr size_t controlIndex(uint32_t bits) {
+    return (bits >> 8 & 4) | (bits & 3);
+}
+
+constexpr InstructionDecoder buildInstructionDecoder(const PowerPCInstruction& instr) {
+    InstructionDecoder decoder{};
+    for (auto& slot : decoder.variant) slot = NO_VARIANT;
+    for (size_t v = 0; v < instr.syntax_variants.size(); v++) {
+        const uint32_t bits = instr.syntax_variants[v].control_bits;
+        decoder.controlMask |= bits;
+        if (decoder.variant[controlIndex(bits)] == NO_VARIANT) {
+            decoder.variant[controlIndex(bits)] = static_cast<uint8_t>(v);
+        }
+    }
+
+    const uint32_t base = instr.encoding.base_opcode;
+    decoder.fixedMask = ~instr.encoding.getFullMask();
+    decoder.fixedBits = base & decoder.fixedMask;
+
+    for (size_t i = 0; i < instr.encoding.fields.size(); i++) {
+        const Field& field = instr.encoding.fields[i];
+        FieldDecoder& out = decoder.fields[i];
+        if (field.kind == FieldKind::Control) continue;
+        out.mask = field.mask;
+        out.shift = static_cast<uint8_t>(field.shift());
+        if (field.kind == FieldKind::Signed || field.kind == FieldKind::BranchOffset) {
+            out.left = static_cast<uint8_t>(32 - field.width());
+            out.right = static_cast<uint8_t>(field.kind == FieldKind::BranchOffset ? out.left - 2 : out.left);
+        }
+        out.split = field.kind == FieldKind::SplitSPR;
+    }
+    return decoder;
+}
+
+constexpr void claim(uint16_t& slot, uint16_t index) {
+    if (slot != INVALID && slot != index) throw std::logic_error("overlapping opcodes in instruction table");
+    slot = index;
+}
+
+constexpr DecodeTable buildDecodeTable() {
+    DecodeTable table{};
+    for (auto& slot : table.primary) slot = INVALID;
+    for (auto& secondary : table.extended) {
+        for (auto& slot : secondary) slot = INVALID;
+    }
+
+    size_t secondaryCount = 0;
+    for (size_t i = 0; i < INSTRUCTION_COUNT; i++) {
+        const PowerPCInstruction& instr = isa::TABLE[i];
+        table.instructions[i] = buildInstructionDecoder(instr);
+        if (!instr.alias_of.empty()) continue;
+
+        const uint16_t index = static_cast<uint16_t>(i);
+        const uint32_t opcode = primaryOf(instr.encoding.base_opcode);
+        const int xo = instr.encoding.fieldIndex("XO");
+        if (xo < 0) {
+            claim(table.primary[opcode], index);
+            continue;
+        }
+
+        if (table.primary[opcode] == INVALID) {
+            if (secondaryCount == SECONDARY_TABLES) throw std::logic_error("too many extended opcode tables");
+            table.primary[opcode] = static_cast<uint16_t>(SECONDARY | secondaryCount++);
+        }
+        if ((table.primary[opcode] & SECONDARY) == 0) throw std::logic_error("primary opcode used both ways");
+
+        // Claim every bits-21-30 pattern the XO field matches, which covers
+        // the OE bit of XO-form and frC of A-form.
+        auto& secondary = table.extended[table.primary[opcode] & ~SECONDARY];
+        const uint32_t xoMask = (instr.encoding.fields[xo].mask >> 1) & (EXTENDED - 1);
+        const uint32_t xoValue = extendedOf(instr.encoding.base_opcode) & xoMask;
+        for (uint32_t e = 0; e < EXTENDED; e++) {
+            if ((e & xoMask) == xoValue) claim(secondary[e], index);
+        }
+    }
+    return table;
+}
+
+constexpr DecodeTable TABLE = buildDecodeTable();
+
+int32_t extractOperand(const FieldDecoder& field, uint32_t word) {
+    const uint32_t raw = (word & field.mask) >> field.shift;
+    const int32_t value = static_cast<int32_t>(raw << field.left) >> field.right;
+    const int32_t swapped = static_cast<int32_t>((raw & 0x1f) << 5 | raw >> 5);
+    return field.split ? swapped : value;
+}
+
+uint16_t lookup(uint32_t word) {
+    uint16_t entry = TABLE.primary[primaryOf(word)];
+    if (entry != INVALID && (entry & SECONDARY) != 0) {
+        entry = TABLE.extended[entry & ~SECONDARY][extendedOf(word)];
+    }
+    return entry;
+}
+
+}
+
+
+const PowerPCInstruction* PowerPCDecoder::identify(uint32_t word) {
+    uint16_t entry = lookup(word);
+    return entry == INVALID ? nullptr : &isa::TABLE[entry];
+}
+
+
+bool PowerPCDecoder::decode(uint32_t word, ParsedInstruction& out) {
+    uint16_t entry = lookup(word);
+    const InstructionDecoder* decoder = entry == INVALID ? nullptr : &TABLE.instructions[entry];
+    uint8_t variant = decoder == nullptr ? NO_VARIANT : decoder->variant[controlIndex(word & decoder->controlMask)];
+    // Unknown opcode, reserved bits set, or a spelling that does not exist
+    // (stwcx. without Rc).
+    if (variant == NO_VARIANT || (word & decoder->fixedMask) != decoder->fixedBits) {
+        out.instruction = nullptr;
+        out.variant = nullptr;
+        out.operands = {};
+        return false;
+    }
+
+    const PowerPCInstruction& instr = isa::TABLE[entry];
+    out.instruction = &instr;
+    out.variant = &instr.syntax_variants[variant];
+    for (size_t i = 0; i < MAX_FIELDS; i++) {
+        out.operands[i] = extractOperand(decoder->fields[i], word);
+    }
+    return true;
+}
+
+
+uint32_t PowerPCDecoder::load(const uint8_t* bytes) const {
+    uint32_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return (endian == Endian::Big) == HOST_BIG_ENDIAN ? word : __builtin_bswap32(word);
+}
+
+
+size_t PowerPCDecoder::decodeAll(std::string_view code, std::vector<ParsedInstruction>& out) const {
+    const size_t count = code.size() / 4;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(code.data());
+    size_t first = out.size();
+    out.resize(first + count);
+
+    size_t invalid = 0;
+    for (size_t i = 0; i < count; i++) {
+        ParsedInstruction& decoded = out[first + i];
+        if (!decode(load(bytes + i * 4), decoded)) invalid++;
+        decoded.line = static_cast<uint32_t>(i);
+    }
+    return invalid;
+}
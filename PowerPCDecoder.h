@@ -0,0 +1,47 @@
+#ifndef PPCASM_POWERPCDECODER_H
+#define PPCASM_POWERPCDECODER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "PowerPCEncoder.h"
+#include "PowerPCInstruction.h"
+#include "InstructionRecord.h"
+
+
+// Turns 32-bit machine words back into instruction table entries. The
+// lookup is two table reads: the primary opcode (bits 0-5) selects either
+// an instruction or a second-level table indexed by bits 21-30, which holds
+// every extended-opcode layout (X, XO with OE, XL, XFX, XFL and A-form).
+// Simplified mnemonics are never produced; words decode to the base
+// instruction.
+class PowerPCDecoder {
+public:
+    explicit PowerPCDecoder(Endian endian = Endian::Big) : endian(endian) {}
+
+    Endian getEndian() const { return endian; }
+
+    // The table entry for `word` (host order), or nullptr if it is not a
+    // known instruction.
+    static const PowerPCInstruction* identify(uint32_t word);
+
+    // Fills instruction, variant and operands in the layout the encoder
+    // takes, so encode(decode(w)) == w. Returns false for invalid words.
+    static bool decode(uint32_t word, ParsedInstruction& out);
+
+    // Decodes a block of code in target byte order, e.g. a memory-mapped
+    // .text section; a trailing partial word is ignored. Every word yields
+    // one entry and `line` holds its word index; invalid words have a null
+    // instruction. Returns the number of invalid words.
+    size_t decodeAll(std::string_view code, std::vector<ParsedInstruction>& out) const;
+
+    uint32_t load(const uint8_t* bytes) const;
+
+private:
+    Endian endian;
+};
+
+
+#endif //PPCASM_POWERPCDECODER_H
@@ -0,0 +1,209 @@
+#include "PowerPCEncoder.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using Field = PowerPCInstruction::Encoding::Field;
+using FieldKind = PowerPCInstruction::Encoding::FieldKind;
+
+static constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+
+static uint32_t byteSwap(uint32_t word) {
+    return __builtin_bswap32(word);
+}
+
+
+bool PowerPCEncoder::fits(const Field& field, int32_t value) {
+    const unsigned width = field.width();
+    const int64_t v = value;
+    switch (field.kind) {
+        case FieldKind::Signed:
+            // Accept the unsigned spelling too, as in "li r3,0xffff".
+            return v >= -(int64_t(1) << (width - 1)) && v < (int64_t(1) << width);
+        case FieldKind::SplitSPR:
+            return v >= 0 && v < 1024;
+        case FieldKind::BranchOffset:
+            return (v & 3) == 0 && v >= -(int64_t(1) << (width + 1)) && v < (int64_t(1) << (width + 1));
+        default:
+            return v >= 0 && v < (int64_t(1) << width);
+    }
+}
+
+
+static uint32_t placeBits(const Field& field, int32_t value) {
+    uint32_t bits;
+    switch (field.kind) {
+        case FieldKind::SplitSPR:
+            bits = ((static_cast<uint32_t>(value) & 0x1f) << 5 | static_cast<uint32_t>(value) >> 5) << field.shift();
+            break;
+        case FieldKind::BranchOffset:
+            bits = static_cast<uint32_t>(value);
+            break;
+        default:
+            bits = static_cast<uint32_t>(value) << field.shift();
+            break;
+    }
+    return bits & field.mask;
+}
+
+
+uint32_t PowerPCEncoder::placeOperand(const Field& field, int32_t value) {
+    if (!fits(field, value)) {
+        throw std::runtime_error("Operand " + std::to_string(value) + " out of range for field " +
+                                 std::string(field.name));
+    }
+    return placeBits(field, value);
+}
+
+
+int32_t PowerPCEncoder::readOperand(const Field& field, uint32_t word) {
+    const uint32_t bits = (word & field.mask) >> field.shift();
+    const unsigned width = field.width();
+    switch (field.kind) {
+        case FieldKind::Signed:
+            return static_cast<int32_t>(bits << (32 - width)) >> (32 - width);
+        case FieldKind::SplitSPR:
+            return static_cast<int32_t>((bits & 0x1f) << 5 | bits >> 5);
+        case FieldKind::BranchOffset:
+            // Word-scaled: the byte offset is the field's bits left in place.
+            return static_cast<int32_t>((word & field.mask) << (32 - width - field.shift())) >>
+                   (32 - width - field.shift());
+        default:
+            return static_cast<int32_t>(bits);
+    }
+}
+
+
+uint32_t PowerPCEncoder::encode(const ParsedInstruction& instruction) const {
+    return encode(*instruction.instruction, *instruction.variant, instruction.operands.data());
+}
+
+
+uint32_t PowerPCEncoder::encode(const PowerPCInstruction& instruction,
+                                const PowerPCInstruction::SyntaxVariant& variant,
+                                const int32_t* operands) const {
+    uint32_t word = instruction.encoding.base_opcode | variant.control_bits;
+    const auto& fields = instruction.encoding.fields;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (operands[i] != 0) word |= placeOperand(fields[i], operands[i]);
+    }
+    return word;
+}
+
+
+Expected<uint32_t> PowerPCEncoder::tryEncode(const ParsedInstruction& instruction) {
+    uint32_t word = instruction.instruction->encoding.base_opcode | instruction.variant->control_bits;
+    const auto& fields = instruction.instruction->encoding.fields;
+    for (size_t i = 0; i < fields.size(); i++) {
+        const int32_t value = instruction.operands[i];
+        if (value == 0) continue;
+        if (!fits(fields[i], value)) {
+            return Unexpected{diagnosticAtLine(DiagnosticCode::OperandOutOfRange, instruction.line, value, 0, 0,
+                                               fields[i].name)};
+        }
+        word |= placeBits(fields[i], value);
+    }
+    return word;
+}
+
+
+void PowerPCEncoder::append(const std::vector<ParsedInstruction>& instructions, std::vector<uint8_t>& out) const {
+    size_t offset = out.size();
+    out.resize(offset + instructions.size() * 4);
+    for (const auto& instruction : instructions) {
+        store(encode(instruction), out.data() + offset);
+        offset += 4;
+    }
+}
+
+
+uint32_t PowerPCEncoder::toTarget(uint32_t word) const {
+    return (endian == Endian::Big) == HOST_BIG_ENDIAN ? word : byteSwap(word);
+}
+
+
+void PowerPCEncoder::store(uint32_t word, uint8_t* out) const {
+    word = toTarget(word);
+    std::memcpy(out, &word, sizeof(word));
+}
+
+
+// The batch loops are branch-free over plain arrays, so they vectorize;
+// the byte order is chosen once, outside the loop.
+
+void PowerPCEncoder::encodeBatch(const XOFormBatch& batch, uint32_t* out) const {
+    const size_t count = batch.size();
+    const uint32_t* opcode = batch.opcode.data();
+    const uint8_t* rD = batch.rD.data();
+    const uint8_t* rA = batch.rA.data();
+    const uint8_t* rB = batch.rB.data();
+    const uint8_t* oe = batch.oe.data();
+    const uint8_t* rc = batch.rc.data();
+
+    auto word = [&](size_t i) {
+        return opcode[i] | (rD[i] & 31u) << 21 | (rA[i] & 31u) << 16 | (rB[i] & 31u) << 11 |
+               (oe[i] & 1u) << 10 | (rc[i] & 1u);
+    };
+
+    if ((endian == Endian::Big) == HOST_BIG_ENDIAN) {
+        for (size_t i = 0; i < count; i++) out[i] = word(i);
+    } else {
+        for (size_t i = 0; i < count; i++) out[i] = byteSwap(word(i));
+    }
+}
+
+
+void PowerPCEncoder::encodeBatch(const DFormBatch& batch, uint32_t* out) const {
+    const size_t count = batch.size();
+    const uint32_t* opcode = batch.opcode.data();
+    const uint8_t* rD = batch.rD.data();
+    const uint8_t* rA = batch.rA.data();
+    const uint16_t* imm = batch.imm.data();
+
+    auto word = [&](size_t i) {
+        return opcode[i] | (rD[i] & 31u) << 21 | (rA[i] & 31u) << 16 | imm[i];
+    };
+
+    if ((endian == Endian::Big) == HOST_BIG_ENDIAN) {
+        for (size_t i = 0; i < count; i++) out[i] = word(i);
+    } else {
+        for (size_t i = 0; i < count; i++) out[i] = byteSwap(word(i));
+    }
+}
+
+
+void XOFormBatch::reserve(size_t count) {
+    opcode.reserve(count);
+    rD.reserve(count);
+    rA.reserve(count);
+    rB.reserve(count);
+    oe.reserve(count);
+    rc.reserve(count);
+}
+
+
+void XOFormBatch::push_back(uint32_t base, uint8_t d, uint8_t a, uint8_t b, bool setOE, bool setRc) {
+    opcode.push_back(base);
+    rD.push_back(d);
+    rA.push_back(a);
+    rB.push_back(b);
+    oe.push_back(setOE);
+    rc.push_back(setRc);
+}
+
+
+void DFormBatch::reserve(size_t count) {
+    opcode.reserve(count);
+    rD.reserve(count);
+    rA.reserve(count);
+    imm.reserve(count);
+}
+
+
+void DFormBatch::push_back(uint32_t base, uint8_t d, uint8_t a, uint16_t immediate) {
+    opcode.push_back(base);
+    rD.push_back(d);
+    rA.push_back(a);
+    imm.push_back(immediate);
+}
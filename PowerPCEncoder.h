@@ -0,0 +1,84 @@
+#ifndef PPCASM_POWERPCENCODER_H
+#define PPCASM_POWERPCENCODER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PowerPCInstruction.h"
+#include "InstructionRecord.h"
+#include "Diagnostics.h"
+
+
+enum class Endian : uint8_t {
+    Big,
+    Little
+};
+
+
+// Operands of a run of XO-form instructions (add, subf, mullw, ...) as one
+// array per field, so the batch encoder is a straight loop the compiler can
+// vectorize. `opcode` is the base opcode of each entry.
+struct XOFormBatch {
+    std::vector<uint32_t> opcode;
+    std::vector<uint8_t> rD, rA, rB;
+    std::vector<uint8_t> oe, rc;
+
+    size_t size() const { return opcode.size(); }
+    void reserve(size_t count);
+    void push_back(uint32_t base, uint8_t d, uint8_t a, uint8_t b, bool setOE = false, bool setRc = false);
+};
+
+// Same for D-form instructions (addi, lwz, stw, ori, ...); `rD` also holds
+// rS and `imm` holds SIMM, UIMM or d as 16 raw bits.
+struct DFormBatch {
+    std::vector<uint32_t> opcode;
+    std::vector<uint8_t> rD, rA;
+    std::vector<uint16_t> imm;
+
+    size_t size() const { return opcode.size(); }
+    void reserve(size_t count);
+    void push_back(uint32_t base, uint8_t d, uint8_t a, uint16_t immediate);
+};
+
+
+// Turns parsed instructions into 32-bit machine words using the field
+// layout of the instruction table. Words are produced in host order by
+// encode() and in target byte order by everything that writes memory.
+class PowerPCEncoder {
+public:
+    explicit PowerPCEncoder(Endian endian = Endian::Big) : endian(endian) {}
+
+    Endian getEndian() const { return endian; }
+
+    // Range-checks every operand; throws std::runtime_error if one does not
+    // fit its field.
+    uint32_t encode(const ParsedInstruction& instruction) const;
+    uint32_t encode(const PowerPCInstruction& instruction, const PowerPCInstruction::SyntaxVariant& variant,
+                    const int32_t* operands) const;
+    // Same checks, reported as an OperandOutOfRange diagnostic instead.
+    static Expected<uint32_t> tryEncode(const ParsedInstruction& instruction);
+
+    void append(const std::vector<ParsedInstruction>& instructions, std::vector<uint8_t>& out) const;
+
+    // Batch paths write batch.size() words to `out` in target byte order.
+    // Operands are not range-checked; excess bits are masked off.
+    void encodeBatch(const XOFormBatch& batch, uint32_t* out) const;
+    void encodeBatch(const DFormBatch& batch, uint32_t* out) const;
+
+    uint32_t toTarget(uint32_t word) const;
+    void store(uint32_t word, uint8_t* out) const;
+
+    // Bits of `value` placed in `field`, with the same range check as
+    // encode(). Used to patch operands into words already emitted.
+    static uint32_t placeOperand(const PowerPCInstruction::Encoding::Field& field, int32_t value);
+    static bool fits(const PowerPCInstruction::Encoding::Field& field, int32_t value);
+    // Inverse of placeOperand: the value held by `field` in `word`.
+    static int32_t readOperand(const PowerPCInstruction::Encoding::Field& field, uint32_t word);
+
+private:
+    Endian endian;
+};
+
+
+#endif //PPCASM_POWERPCENCODER_H
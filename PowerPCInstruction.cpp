@@ -0,0 +1,73 @@
+#include "PowerPCInstruction.h"
+#include <iostream>
+#include "PipelineModel.h"
+
+const char* formName(InstructionForm form) {
+    static const char* const names[] = {
+            "XO", "D", "DS", "A", "I", "B", "SC", "M", "MD", "MDS", "X", "XL", "XFX", "XFL"
+    };
+    return names[static_cast<int>(form)];
+}
+
+
+void printInstructionInfo(const PowerPCInstruction& instr) {
+    std::cout << "Instruction Name: " << instr.name << "\n";
+    std::cout << "Primary Mnemonic: " << instr.primary_mnemonic << "\n\n";
+
+    std::cout << "Syntax Variants:\n";
+    for (const auto& variant : instr.syntax_variants) {
+        std::cout << "  " << variant.mnemonic << " " << variant.syntax
+                  << " (OE=" << variant.oe << ", Rc=" << variant.rc
+                  << ", AA=" << variant.aa << ", LK=" << variant.lk << ")\n";
+    }
+
+    std::cout << "\nEquivalent POWER Mnemonics:\n";
+    for (const auto& mnemonic : instr.power_mnemonics) {
+        std::cout << "  " << mnemonic << "\n";
+    }
+
+    std::cout << "\nEncoding (Base Opcode: 0x" << std::hex << instr.encoding.base_opcode << "):\n";
+    for (const auto& field : instr.encoding.fields) {
+        std::cout << "  " << field.name << ": bits " << std::dec << (int)field.start_bit
+                  << "-" << (int)field.end_bit << " (mask: 0x"
+                  << std::hex << field.mask << ")\n";
+    }
+    std::cout << std::dec;
+
+    std::cout << "\nPseudocode: " << instr.pseudocode << "\n";
+    std::cout << "Description: " << instr.description << "\n";
+
+    std::cout << "\nRegister Effects:\n";
+    std::cout << "  CR: LT=" << instr.effects.cr_lt << " GT=" << instr.effects.cr_gt
+              << " EQ=" << instr.effects.cr_eq << " SO=" << instr.effects.cr_so << "\n";
+    std::cout << "  XER: SO=" << instr.effects.xer_so << " OV=" << instr.effects.xer_ov
+              << " CA=" << instr.effects.xer_ca << "\n";
+    std::cout << "  Defines: 0x" << std::hex << instr.effects.defines << " Uses: 0x" << instr.effects.uses
+              << std::dec << "\n";
+
+    std::cout << "\nClassification:\n";
+    std::cout << "  Architecture Level: " << (instr.arch_level == ArchLevel::USIA ? "USIA" :
+                                              instr.arch_level == ArchLevel::VEA ? "VEA" : "OEA") << "\n";
+    std::cout << "  Privilege Level: " << (instr.privilege_level == PrivilegeLevel::User ? "User" :
+                                           instr.privilege_level == PrivilegeLevel::Supervisor ? "Supervisor" : "Hypervisor") << "\n";
+    std::cout << "  Optional: " << (instr.is_optional ? "Yes" : "No") << "\n";
+    std::cout << "  Form: " << formName(instr.form) << "\n";
+    if (!instr.alias_of.empty()) {
+        std::cout << "  Simplified mnemonic for: " << instr.alias_of << "\n";
+    }
+
+    std::cout << "\nTiming:\n";
+    for (const CoreModel* core : cores::ALL) {
+        const ClassTiming& timing = core->of(instr);
+        std::cout << "  " << core->name << ": ";
+        if (!timing.implemented()) {
+            std::cout << "not implemented\n";
+            continue;
+        }
+        std::cout << "latency " << int(timing.latency) << ", throughput 1/" << int(timing.occupancy) << ", ports";
+        for (size_t port = 0; port < core->ports.size(); port++) {
+            if ((timing.ports & 1u << port) != 0) std::cout << " " << core->ports[port];
+        }
+        std::cout << "\n";
+    }
+}
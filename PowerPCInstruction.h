@@ -1,11 +1,11 @@
-
 #ifndef PPCASM_POWERPCINSTRUCTION_H
 #define PPCASM_POWERPCINSTRUCTION_H
-#include <string>
-#include <vector>
+#include <string_view>
 #include <cstdint>
+#include <cstddef>
 #include <array>
-#include <iostream>
+#include <initializer_list>
+#include <stdexcept>
 
 
 enum class ArchLevel {
@@ -22,6 +22,34 @@ enum class PrivilegeLevel {
 };
 
 
+// What an instruction costs to execute, as a row of a core model's timing
+// table (PipelineModel.h). Derived from the opcode, so simplified mnemonics
+// share the row of their base instruction.
+enum class TimingClass : uint8_t {
+    IntSimple,
+    IntCompare,
+    IntMultiply,
+    IntDivide,
+    Load,
+    LoadMultiple,   // lmw, lswi, lswx: per register
+    Store,
+    StoreMultiple,  // stmw, stswi, stswx: per register
+    FpLoad,
+    FpStore,
+    FpSimple,
+    FpDivide,       // fdiv, fsqrt
+    FpStatus,       // FPSCR moves
+    Branch,
+    CrLogical,
+    CrMove,         // mfcr, mtcrf, mcrxr
+    SprMove,
+    Cache,
+    Sync            // waits for everything before it
+};
+
+inline constexpr size_t TIMING_CLASS_COUNT = 19;
+
+
 enum class InstructionForm {
     XO,
     D,
@@ -33,64 +61,145 @@ enum class InstructionForm {
     M,
     MD,
     MDS,
-    X
+    X,
+    XL,
+    XFX,
+    XFL
+};
+
+
+// Fixed-capacity list usable in constant expressions, so instruction
+// definitions can live in read-only static data instead of on the heap.
+template <class T, size_t N>
+class FixedList {
+public:
+    constexpr FixedList() : items(), count(0) {}
+    constexpr FixedList(std::initializer_list<T> list) : items(), count(0) {
+        for (const T& item : list) push_back(item);
+    }
+
+    constexpr void push_back(const T& item) {
+        if (count == N) throw std::length_error("FixedList capacity exceeded");
+        items[count++] = item;
+    }
+
+    constexpr const T* begin() const { return items.data(); }
+    constexpr const T* end() const { return items.data() + count; }
+    constexpr size_t size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+    constexpr T& operator[](size_t i) { return items[i]; }
+    constexpr const T& operator[](size_t i) const { return items[i]; }
+
+private:
+    std::array<T, N> items;
+    uint8_t count;
 };
 
 
 struct PowerPCInstruction {
 
-    std::string name;
-    std::string primary_mnemonic;
+    std::string_view name;
+    std::string_view primary_mnemonic;
 
 
     struct SyntaxVariant {
-        std::string mnemonic;
-        std::string syntax;
-        bool oe;
-        bool rc;
+        std::string_view mnemonic;
+        std::string_view syntax;
+        bool oe = false;
+        bool rc = false;
+        bool aa = false;
+        bool lk = false;
+        // OE/Rc/AA/LK bits this spelling adds to the base opcode; filled in
+        // by the instruction table from the fields the form actually has.
+        uint32_t control_bits = 0;
     };
-    std::vector<SyntaxVariant> syntax_variants;
+    FixedList<SyntaxVariant, 4> syntax_variants;
 
 
-    std::vector<std::string> power_mnemonics;
+    FixedList<std::string_view, 4> power_mnemonics;
 
 
     struct Encoding {
-        uint32_t base_opcode;
+        static constexpr size_t MAX_FIELDS = 8;
+
+        uint32_t base_opcode = 0;
+
+        // How an operand value is placed into its field.
+        enum class FieldKind : uint8_t {
+            Unsigned,
+            Signed,
+            SplitSPR,       // 10-bit SPR/TBR number with its 5-bit halves swapped
+            BranchOffset,   // byte displacement; the low two bits are implied
+            Control         // XO, OE, Rc, AA, LK: set by the mnemonic, not an operand
+        };
 
         struct Field {
-            std::string name;
-            uint8_t start_bit;
-            uint8_t end_bit;
-            uint32_t mask;
-
-            Field(const std::string& n, uint8_t s, uint8_t e)
-                    : name(n), start_bit(s), end_bit(e),
-                      mask(((1 << (e - s + 1)) - 1) << (31 - e)) {}
+            std::string_view name;
+            uint8_t start_bit = 0;
+            uint8_t end_bit = 0;
+            FieldKind kind = FieldKind::Unsigned;
+            uint32_t mask = 0;
+
+            constexpr Field() = default;
+            constexpr Field(std::string_view n, uint8_t s, uint8_t e, FieldKind k = FieldKind::Unsigned)
+                    : name(n), start_bit(s), end_bit(e), kind(k),
+                      mask(static_cast<uint32_t>(((uint64_t(1) << (e - s + 1)) - 1) << (31 - e))) {}
+
+            constexpr unsigned width() const { return end_bit - start_bit + 1u; }
+            constexpr unsigned shift() const { return 31u - end_bit; }
         };
 
-        std::vector<Field> fields;
+        FixedList<Field, MAX_FIELDS> fields;
 
-        void addField(const std::string& name, uint8_t start, uint8_t end) {
-            fields.emplace_back(name, start, end);
+        constexpr void addField(std::string_view name, uint8_t start, uint8_t end,
+                                FieldKind kind = FieldKind::Unsigned) {
+            fields.push_back(Field(name, start, end, kind));
         }
 
-        uint32_t getFullMask() const {
+        constexpr uint32_t getFullMask() const {
             uint32_t mask = 0;
             for (const auto& field : fields) {
                 mask |= field.mask;
             }
             return mask;
         }
+
+        constexpr const Field* findField(std::string_view fieldName) const {
+            for (const auto& field : fields) {
+                if (field.name == fieldName) return &field;
+            }
+            return nullptr;
+        }
+
+        constexpr int fieldIndex(std::string_view fieldName) const {
+            for (size_t i = 0; i < fields.size(); i++) {
+                if (fields[i].name == fieldName) return static_cast<int>(i);
+            }
+            return -1;
+        }
     };
     Encoding encoding;
 
 
-    std::string pseudocode;
-    std::string description;
+    std::string_view pseudocode;
+    std::string_view description;
 
 
     struct RegisterEffects {
+        // Where condition state is defined (written) or used (read). CR
+        // locations are relative to the operands; FlagLiveness.h resolves
+        // them for one instruction word.
+        enum Flag : uint16_t {
+            FLAG_CR0 = 1 << 0,      // with Rc=1
+            FLAG_CR1 = 1 << 1,      // with Rc=1, by floating-point instructions
+            FLAG_CR_FIELD = 1 << 2, // crfD when defined, crfS when used
+            FLAG_CR_BIT = 1 << 3,   // crbD when defined; BI, or crbA and crbB, when used
+            FLAG_CR = 1 << 4,       // the fields CRM selects when defined, all of CR when used
+            FLAG_XER_SO = 1 << 5,   // SO and OV: only with OE=1 where there is an OE bit
+            FLAG_XER_OV = 1 << 6,
+            FLAG_XER_CA = 1 << 7
+        };
+
         bool cr_lt;
         bool cr_gt;
         bool cr_eq;
@@ -98,116 +207,26 @@ struct PowerPCInstruction {
         bool xer_so;
         bool xer_ov;
         bool xer_ca;
+        uint16_t defines;
+        uint16_t uses;
     };
     RegisterEffects effects;
+    TimingClass timing;
 
 
     ArchLevel arch_level;
     PrivilegeLevel privilege_level;
     bool is_optional;
     InstructionForm form;
-};
-
-
-PowerPCInstruction createADDInstruction() {
-    PowerPCInstruction add;
-
-
-    add.name = "Add";
-    add.primary_mnemonic = "add";
-
-
-    add.syntax_variants = {
-            {"add",  "rD,rA,rB", false, false},
-            {"add.", "rD,rA,rB", false, true},
-            {"addo", "rD,rA,rB", true,  false},
-            {"addo.", "rD,rA,rB", true,  true}
-    };
-
-
-    add.power_mnemonics = {"cax", "cax.", "caxo", "caxo."};
-
-
-    add.encoding.base_opcode = 0x7C000214;
-    add.encoding.addField("D", 6, 10);
-    add.encoding.addField("A", 11, 15);
-    add.encoding.addField("B", 16, 20);
-    add.encoding.addField("OE", 21, 21);
-    add.encoding.addField("XO", 22, 30);
-    add.encoding.addField("Rc", 31, 31);
-
-
-    add.pseudocode = "rD ← (rA) + (rB)";
-    add.description = "The sum (rA) + (rB) is placed into rD.";
 
+    // Primary mnemonic of the instruction this one is a simplified form of
+    // (e.g. "or" for "mr"); empty for real instructions.
+    std::string_view alias_of;
+};
 
-    add.effects = {
-            true,
-            true,
-            true,
-            true,
-            true,
-            true,
-            false
-    };
-
-
-    add.arch_level = ArchLevel::USIA;
-    add.privilege_level = PrivilegeLevel::User;
-    add.is_optional = false;
-    add.form = InstructionForm::XO;
-
-    return add;
-}
-
-
-void printInstructionInfo(const PowerPCInstruction& instr) {
-    std::cout << "Instruction Name: " << instr.name << "\n";
-    std::cout << "Primary Mnemonic: " << instr.primary_mnemonic << "\n\n";
-
-    std::cout << "Syntax Variants:\n";
-    for (const auto& variant : instr.syntax_variants) {
-        std::cout << "  " << variant.mnemonic << " " << variant.syntax
-                  << " (OE=" << variant.oe << ", Rc=" << variant.rc << ")\n";
-    }
-
-    std::cout << "\nEquivalent POWER Mnemonics:\n";
-    for (const auto& mnemonic : instr.power_mnemonics) {
-        std::cout << "  " << mnemonic << "\n";
-    }
-
-    std::cout << "\nEncoding (Base Opcode: 0x" << std::hex << instr.encoding.base_opcode << "):\n";
-    for (const auto& field : instr.encoding.fields) {
-        std::cout << "  " << field.name << ": bits " << (int)field.start_bit
-                  << "-" << (int)field.end_bit << " (mask: 0x"
-                  << field.mask << ")\n";
-    }
 
-    std::cout << "\nPseudocode: " << instr.pseudocode << "\n";
-    std::cout << "Description: " << instr.description << "\n";
-
-    std::cout << "\nRegister Effects:\n";
-    std::cout << "  CR: LT=" << instr.effects.cr_lt << " GT=" << instr.effects.cr_gt
-              << " EQ=" << instr.effects.cr_eq << " SO=" << instr.effects.cr_so << "\n";
-    std::cout << "  XER: SO=" << instr.effects.xer_so << " OV=" << instr.effects.xer_ov
-              << " CA=" << instr.effects.xer_ca << "\n";
-
-    std::cout << "\nClassification:\n";
-    std::cout << "  Architecture Level: " << (instr.arch_level == ArchLevel::USIA ? "USIA" :
-                                              instr.arch_level == ArchLevel::VEA ? "VEA" : "OEA") << "\n";
-    std::cout << "  Privilege Level: " << (instr.privilege_level == PrivilegeLevel::User ? "User" :
-                                           instr.privilege_level == PrivilegeLevel::Supervisor ? "Supervisor" : "Hypervisor") << "\n";
-    std::cout << "  Optional: " << (instr.is_optional ? "Yes" : "No") << "\n";
-    std::cout << "  Form: " << (instr.form == InstructionForm::XO ? "XO" :
-                                instr.form == InstructionForm::D ? "D" :
-                                instr.form == InstructionForm::DS ? "DS" : "...") << "\n";
-}
-
-int main() {
-    auto add_instr = createADDInstruction();
-    printInstructionInfo(add_instr);
-    return 0;
-}
+const char* formName(InstructionForm form);
+void printInstructionInfo(const PowerPCInstruction& instr);
 
 
 
@@ -0,0 +1,822 @@
+#ifndef PPCASM_POWERPCINSTRUCTIONTABLE_H
+#define PPCASM_POWERPCINSTRUCTIONTABLE_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include "PowerPCInstruction.h"
+
+// The instruction database: every 32-bit user-level (UISA and VEA)
+// instruction plus the common simplified mnemonics, as one constexpr table.
+// It lives in read-only data, is shared by every parser and costs nothing at
+// startup. Field layouts and masks are derived at compile time from the
+// operand syntax and the instruction form.
+
+namespace isa {
+
+using Variant = PowerPCInstruction::SyntaxVariant;
+using Field = PowerPCInstruction::Encoding::Field;
+using FieldKind = PowerPCInstruction::Encoding::FieldKind;
+using Effects = PowerPCInstruction::RegisterEffects;
+using Variants = FixedList<Variant, 4>;
+using PowerNames = FixedList<std::string_view, 4>;
+
+// Shorthand for the defines and uses columns below.
+inline constexpr uint16_t FLAG_CR0 = Effects::FLAG_CR0;
+inline constexpr uint16_t FLAG_CR1 = Effects::FLAG_CR1;
+inline constexpr uint16_t FLAG_CRF = Effects::FLAG_CR_FIELD;
+inline constexpr uint16_t FLAG_CRB = Effects::FLAG_CR_BIT;
+inline constexpr uint16_t FLAG_CR = Effects::FLAG_CR;
+inline constexpr uint16_t FLAG_SO = Effects::FLAG_XER_SO;
+inline constexpr uint16_t FLAG_OV = Effects::FLAG_XER_OV;
+inline constexpr uint16_t FLAG_CA = Effects::FLAG_XER_CA;
+inline constexpr uint16_t FLAG_XER = FLAG_SO | FLAG_OV | FLAG_CA;
+
+// The Rc=1 forms copy XER[SO] into CR0, and OE=1 keeps it sticky, so both
+// use it; the extended arithmetic also uses XER[CA] as its carry in.
+//                             LT     GT     EQ     SO     XER.SO XER.OV XER.CA defines uses
+inline constexpr Effects NONE{false, false, false, false, false, false, false, 0, 0};
+inline constexpr Effects CR0{true, true, true, true, false, false, false, FLAG_CR0, FLAG_SO};
+inline constexpr Effects CR0_OV{true, true, true, true, true, true, false, FLAG_CR0 | FLAG_SO | FLAG_OV, FLAG_SO};
+inline constexpr Effects CR0_CA{true, true, true, true, false, false, true, FLAG_CR0 | FLAG_CA, FLAG_SO};
+inline constexpr Effects CR0_OV_CA{true, true, true, true, true, true, true, FLAG_CR0 | FLAG_XER, FLAG_SO};
+inline constexpr Effects CR0_OV_CA_IN{true, true, true, true, true, true, true, FLAG_CR0 | FLAG_XER, FLAG_SO | FLAG_CA};
+inline constexpr Effects CA{false, false, false, false, false, false, true, FLAG_CA, 0};
+inline constexpr Effects CR1{true, true, true, true, false, false, false, FLAG_CR1, 0};
+// Integer compares, which copy XER[SO]; floating-point compares and mcrfs;
+// mcrf; mcrxr, which clears what it copies.
+inline constexpr Effects CRF{true, true, true, true, false, false, false, FLAG_CRF, FLAG_SO};
+inline constexpr Effects CRF_FP{true, true, true, true, false, false, false, FLAG_CRF, 0};
+inline constexpr Effects CRF_CRF{true, true, true, true, false, false, false, FLAG_CRF, FLAG_CRF};
+inline constexpr Effects CRF_XER{true, true, true, true, true, true, true, FLAG_CRF | FLAG_XER, FLAG_XER};
+// Conditional branches; CR logical instructions; mfcr and mtcrf; mfxer and
+// mtxer. A plain mfspr or mtspr depends on its SPR, which FlagLiveness.h
+// looks at.
+inline constexpr Effects COND{false, false, false, false, false, false, false, 0, FLAG_CRB};
+inline constexpr Effects CRB{true, true, true, true, false, false, false, FLAG_CRB, FLAG_CRB};
+inline constexpr Effects CR_IN{false, false, false, false, false, false, false, 0, FLAG_CR};
+inline constexpr Effects CR_OUT{true, true, true, true, false, false, false, FLAG_CR, 0};
+inline constexpr Effects XER_IN{false, false, false, false, false, false, false, 0, FLAG_XER};
+inline constexpr Effects XER_OUT{false, false, false, false, true, true, true, FLAG_XER, 0};
+
+constexpr uint32_t op(uint32_t primary, uint32_t extended = 0) {
+    return primary << 26 | extended << 1;
+}
+
+constexpr Variants one(std::string_view mnemonic, std::string_view syntax) {
+    return {Variant{mnemonic, syntax}};
+}
+
+constexpr Variants dot(std::string_view mnemonic, std::string_view syntax) {
+    return {Variant{mnemonic, syntax, false, true}};
+}
+
+constexpr Variants rc(std::string_view plain, std::string_view record, std::string_view syntax) {
+    return {Variant{plain, syntax}, Variant{record, syntax, false, true}};
+}
+
+constexpr Variants oerc(std::string_view plain, std::string_view record, std::string_view overflow,
+                        std::string_view both, std::string_view syntax) {
+    return {Variant{plain, syntax}, Variant{record, syntax, false, true},
+            Variant{overflow, syntax, true, false}, Variant{both, syntax, true, true}};
+}
+
+constexpr Variants lk(std::string_view plain, std::string_view link, std::string_view syntax) {
+    return {Variant{plain, syntax}, Variant{link, syntax, false, false, false, true}};
+}
+
+constexpr Variants aalk(std::string_view plain, std::string_view absolute, std::string_view link,
+                        std::string_view both, std::string_view syntax) {
+    return {Variant{plain, syntax}, Variant{absolute, syntax, false, false, true, false},
+            Variant{link, syntax, false, false, false, true}, Variant{both, syntax, false, false, true, true}};
+}
+
+// Simplified mnemonic whose operand is optional (e.g. "cmpw [crfD,]rA,rB").
+constexpr Variants optionalFirst(std::string_view mnemonic, std::string_view full, std::string_view shortSyntax) {
+    return {Variant{mnemonic, full}, Variant{mnemonic, shortSyntax}};
+}
+
+// Bit positions of every operand name used in syntax strings. Register
+// operands name the field they occupy ("frD" lives in D).
+constexpr Field operandField(std::string_view operand, InstructionForm form) {
+    if (operand == "rD" || operand == "frD") return Field("D", 6, 10);
+    if (operand == "rS" || operand == "frS") return Field("S", 6, 10);
+    if (operand == "rA" || operand == "frA") return Field("A", 11, 15);
+    if (operand == "rB" || operand == "frB") return Field("B", 16, 20);
+    if (operand == "frC") return Field("C", 21, 25);
+    if (operand == "SIMM") return Field("SIMM", 16, 31, FieldKind::Signed);
+    if (operand == "UIMM") return Field("UIMM", 16, 31);
+    if (operand == "d") return Field("d", 16, 31, FieldKind::Signed);
+    if (operand == "crfD") return Field("crfD", 6, 8);
+    if (operand == "crfS") return Field("crfS", 11, 13);
+    if (operand == "L") return Field("L", 10, 10);
+    if (operand == "crbD") return Field("crbD", 6, 10);
+    if (operand == "crbA") return Field("crbA", 11, 15);
+    if (operand == "crbB") return Field("crbB", 16, 20);
+    if (operand == "BO") return Field("BO", 6, 10);
+    if (operand == "BI") return Field("BI", 11, 15);
+    if (operand == "target_addr") {
+        return form == InstructionForm::I ? Field("LI", 6, 29, FieldKind::BranchOffset)
+                                          : Field("BD", 16, 29, FieldKind::BranchOffset);
+    }
+    if (operand == "SH") return Field("SH", 16, 20);
+    if (operand == "MB") return Field("MB", 21, 25);
+    if (operand == "ME") return Field("ME", 26, 30);
+    if (operand == "NB") return Field("NB", 16, 20);
+    if (operand == "TO") return Field("TO", 6, 10);
+    if (operand == "SPR") return Field("SPR", 11, 20, FieldKind::SplitSPR);
+    if (operand == "TBR") return Field("TBR", 11, 20, FieldKind::SplitSPR);
+    if (operand == "CRM") return Field("CRM", 12, 19);
+    if (operand == "FM") return Field("FM", 7, 14);
+    if (operand == "IMM") return Field("IMM", 16, 19);
+    throw std::logic_error("unknown operand in syntax string");
+}
+
+constexpr bool isSyntaxSeparator(char c) {
+    return c == ',' || c == '(' || c == ')' || c == '|';
+}
+
+constexpr void addOperandFields(PowerPCInstruction::Encoding& encoding, std::string_view syntax,
+                                InstructionForm form) {
+    size_t start = 0;
+    while (start < syntax.size()) {
+        size_t end = start;
+        while (end < syntax.size() && !isSyntaxSeparator(syntax[end])) end++;
+        if (end > start) {
+            Field field = operandField(syntax.substr(start, end - start), form);
+            if (encoding.fieldIndex(field.name) < 0) encoding.fields.push_back(field);
+        }
+        start = end + 1;
+    }
+}
+
+constexpr uint32_t controlBit(const PowerPCInstruction::Encoding& encoding, std::string_view name, bool set) {
+    const int index = encoding.fieldIndex(name);
+    return set && index >= 0 ? encoding.fields[index].mask : 0;
+}
+
+// Timing row of an opcode; the extended opcode sits in bits 21-30, or
+// 26-30 for A-form.
+constexpr TimingClass timingClass(InstructionForm form, uint32_t opcode) {
+    using T = TimingClass;
+    const uint32_t primary = opcode >> 26;
+    const uint32_t extended = form == InstructionForm::A ? opcode >> 1 & 31 : opcode >> 1 & 1023;
+    switch (primary) {
+        case 3: case 10: case 11:
+            return T::IntCompare;
+        case 7:
+            return T::IntMultiply;
+        case 16: case 18:
+            return T::Branch;
+        case 17:
+            return T::Sync;
+        case 19:
+            if (extended == 16 || extended == 528) return T::Branch;
+            if (extended == 150) return T::Sync;
+            return T::CrLogical;
+        case 32: case 33: case 34: case 35: case 40: case 41: case 42: case 43:
+            return T::Load;
+        case 36: case 37: case 38: case 39: case 44: case 45:
+            return T::Store;
+        case 48: case 49: case 50: case 51:
+            return T::FpLoad;
+        case 52: case 53: case 54: case 55:
+            return T::FpStore;
+        case 46:
+            return T::LoadMultiple;
+        case 47:
+            return T::StoreMultiple;
+        case 59:
+            return extended == 18 || extended == 22 ? T::FpDivide : T::FpSimple;
+        case 63:
+            if (form == InstructionForm::A) return extended == 18 || extended == 22 ? T::FpDivide : T::FpSimple;
+            if (extended == 38 || extended == 64 || extended == 70 || extended == 134 || extended == 583 ||
+                extended == 711) {
+                return T::FpStatus;
+            }
+            return T::FpSimple;
+        case 31:
+            break;
+        default:
+            return T::IntSimple;
+    }
+    switch (extended) {
+        case 0: case 4: case 32:
+            return T::IntCompare;
+        case 11: case 75: case 235:
+            return T::IntMultiply;
+        case 459: case 491:
+            return T::IntDivide;
+        case 20: case 23: case 55: case 87: case 119: case 279: case 311: case 343: case 375: case 534: case 790:
+            return T::Load;
+        case 535: case 567: case 599: case 631:
+            return T::FpLoad;
+        case 533: case 597:
+            return T::LoadMultiple;
+        case 150: case 151: case 183: case 215: case 247: case 407: case 439: case 662: case 918:
+            return T::Store;
+        case 663: case 695: case 727: case 759: case 983:
+            return T::FpStore;
+        case 661: case 725:
+            return T::StoreMultiple;
+        case 19: case 144: case 512:
+            return T::CrMove;
+        case 339: case 371: case 467:
+            return T::SprMove;
+        case 54: case 86: case 246: case 278: case 982: case 1014:
+            return T::Cache;
+        case 598: case 854:
+            return T::Sync;
+        default:
+            return T::IntSimple;
+    }
+}
+
+constexpr PowerPCInstruction define(InstructionForm form, std::string_view name, uint32_t opcode,
+                                    const Variants& variants, const PowerNames& power,
+                                    std::string_view pseudocode, const Effects& effects) {
+    PowerPCInstruction instr{};
+    instr.name = name;
+    instr.primary_mnemonic = variants[0].mnemonic;
+    instr.syntax_variants = variants;
+    instr.power_mnemonics = power;
+    instr.encoding.base_opcode = opcode;
+    instr.pseudocode = pseudocode;
+    instr.effects = effects;
+    instr.timing = timingClass(form, opcode);
+    instr.arch_level = ArchLevel::USIA;
+    instr.privilege_level = PrivilegeLevel::User;
+    instr.is_optional = false;
+    instr.form = form;
+
+    bool anyOE = false, anyRc = false, anyAA = false, anyLK = false;
+    for (const auto& variant : variants) {
+        addOperandFields(instr.encoding, variant.syntax, form);
+        anyOE = anyOE || variant.oe;
+        anyRc = anyRc || variant.rc;
+        anyAA = anyAA || variant.aa;
+        anyLK = anyLK || variant.lk;
+    }
+
+    switch (form) {
+        case InstructionForm::XO:
+            if (anyOE) instr.encoding.addField("OE", 21, 21, FieldKind::Control);
+            instr.encoding.addField("XO", 22, 30, FieldKind::Control);
+            if (anyRc) instr.encoding.addField("Rc", 31, 31, FieldKind::Control);
+            break;
+        case InstructionForm::X:
+        case InstructionForm::XFX:
+        case InstructionForm::XFL:
+            instr.encoding.addField("XO", 21, 30, FieldKind::Control);
+            if (anyRc) instr.encoding.addField("Rc", 31, 31, FieldKind::Control);
+            break;
+        case InstructionForm::XL:
+            instr.encoding.addField("XO", 21, 30, FieldKind::Control);
+            if (anyLK) instr.encoding.addField("LK", 31, 31, FieldKind::Control);
+            break;
+        case InstructionForm::A:
+            instr.encoding.addField("XO", 26, 30, FieldKind::Control);
+            if (anyRc) instr.encoding.addField("Rc", 31, 31, FieldKind::Control);
+            break;
+        case InstructionForm::M:
+            if (anyRc) instr.encoding.addField("Rc", 31, 31, FieldKind::Control);
+            break;
+        case InstructionForm::I:
+        case InstructionForm::B:
+            if (anyAA) instr.encoding.addField("AA", 30, 30, FieldKind::Control);
+            if (anyLK) instr.encoding.addField("LK", 31, 31, FieldKind::Control);
+            break;
+        default:
+            break;
+    }
+
+    for (size_t i = 0; i < instr.syntax_variants.size(); i++) {
+        Variant& variant = instr.syntax_variants[i];
+        variant.control_bits = controlBit(instr.encoding, "OE", variant.oe) |
+                               controlBit(instr.encoding, "Rc", variant.rc) |
+                               controlBit(instr.encoding, "AA", variant.aa) |
+                               controlBit(instr.encoding, "LK", variant.lk);
+    }
+    return instr;
+}
+
+constexpr PowerPCInstruction described(PowerPCInstruction instr, std::string_view description) {
+    instr.description = description;
+    return instr;
+}
+
+constexpr PowerPCInstruction vea(PowerPCInstruction instr) {
+    instr.arch_level = ArchLevel::VEA;
+    return instr;
+}
+
+constexpr PowerPCInstruction optional(PowerPCInstruction instr) {
+    instr.is_optional = true;
+    return instr;
+}
+
+constexpr PowerPCInstruction alias(std::string_view base, PowerPCInstruction instr) {
+    instr.alias_of = base;
+    return instr;
+}
+
+using F = InstructionForm;
+
+inline constexpr PowerPCInstruction TABLE[] = {
+        // Integer arithmetic
+        described(define(F::XO, "Add", op(31, 266), oerc("add", "add.", "addo", "addo.", "rD,rA,rB"),
+                         {"cax", "cax.", "caxo", "caxo."}, "rD ← (rA) + (rB)", CR0_OV),
+                  "The sum (rA) + (rB) is placed into rD."),
+        define(F::XO, "Add Carrying", op(31, 10), oerc("addc", "addc.", "addco", "addco.", "rD,rA,rB"),
+               {"a", "a.", "ao", "ao."}, "rD ← (rA) + (rB)", CR0_OV_CA),
+        define(F::XO, "Add Extended", op(31, 138), oerc("adde", "adde.", "addeo", "addeo.", "rD,rA,rB"),
+               {"ae", "ae.", "aeo", "aeo."}, "rD ← (rA) + (rB) + XER[CA]", CR0_OV_CA_IN),
+        define(F::D, "Add Immediate", op(14), one("addi", "rD,rA,SIMM"), {"cal"},
+               "if rA = 0 then rD ← EXTS(SIMM) else rD ← (rA) + EXTS(SIMM)", NONE),
+        define(F::D, "Add Immediate Carrying", op(12), one("addic", "rD,rA,SIMM"), {"ai"},
+               "rD ← (rA) + EXTS(SIMM)", CA),
+        define(F::D, "Add Immediate Carrying and Record", op(13), dot("addic.", "rD,rA,SIMM"), {"ai."},
+               "rD ← (rA) + EXTS(SIMM)", CR0_CA),
+        define(F::D, "Add Immediate Shifted", op(15), one("addis", "rD,rA,SIMM"), {"cau"},
+               "if rA = 0 then rD ← (SIMM || 0x0000) else rD ← (rA) + (SIMM || 0x0000)", NONE),
+        define(F::XO, "Add to Minus One Extended", op(31, 234), oerc("addme", "addme.", "addmeo", "addmeo.", "rD,rA"),
+               {"ame", "ame.", "ameo", "ameo."}, "rD ← (rA) + XER[CA] - 1", CR0_OV_CA_IN),
+        define(F::XO, "Add to Zero Extended", op(31, 202), oerc("addze", "addze.", "addzeo", "addzeo.", "rD,rA"),
+               {"aze", "aze.", "azeo", "azeo."}, "rD ← (rA) + XER[CA]", CR0_OV_CA_IN),
+        define(F::XO, "Divide Word", op(31, 491), oerc("divw", "divw.", "divwo", "divwo.", "rD,rA,rB"),
+               {}, "rD ← (rA) ÷ (rB)", CR0_OV),
+        define(F::XO, "Divide Word Unsigned", op(31, 459), oerc("divwu", "divwu.", "divwuo", "divwuo.", "rD,rA,rB"),
+               {}, "rD ← (rA) ÷ (rB) (unsigned)", CR0_OV),
+        define(F::XO, "Multiply High Word", op(31, 75), rc("mulhw", "mulhw.", "rD,rA,rB"),
+               {}, "rD ← ((rA) × (rB))[0-31]", CR0),
+        define(F::XO, "Multiply High Word Unsigned", op(31, 11), rc("mulhwu", "mulhwu.", "rD,rA,rB"),
+               {}, "rD ← ((rA) × (rB))[0-31] (unsigned)", CR0),
+        define(F::D, "Multiply Low Immediate", op(7), one("mulli", "rD,rA,SIMM"), {"muli"},
+               "rD ← ((rA) × EXTS(SIMM))[32-63]", NONE),
+        define(F::XO, "Multiply Low Word", op(31, 235), oerc("mullw", "mullw.", "mullwo", "mullwo.", "rD,rA,rB"),
+               {"muls", "muls.", "mulso", "mulso."}, "rD ← ((rA) × (rB))[32-63]", CR0_OV),
+        define(F::XO, "Negate", op(31, 104), oerc("neg", "neg.", "nego", "nego.", "rD,rA"),
+               {}, "rD ← ¬(rA) + 1", CR0_OV),
+        define(F::XO, "Subtract From", op(31, 40), oerc("subf", "subf.", "subfo", "subfo.", "rD,rA,rB"),
+               {}, "rD ← ¬(rA) + (rB) + 1", CR0_OV),
+        define(F::XO, "Subtract from Carrying", op(31, 8), oerc("subfc", "subfc.", "subfco", "subfco.", "rD,rA,rB"),
+               {"sf", "sf.", "sfo", "sfo."}, "rD ← ¬(rA) + (rB) + 1", CR0_OV_CA),
+        define(F::XO, "Subtract from Extended", op(31, 136), oerc("subfe", "subfe.", "subfeo", "subfeo.", "rD,rA,rB"),
+               {"sfe", "sfe.", "sfeo", "sfeo."}, "rD ← ¬(rA) + (rB) + XER[CA]", CR0_OV_CA_IN),
+        define(F::D, "Subtract from Immediate Carrying", op(8), one("subfic", "rD,rA,SIMM"), {"sfi"},
+               "rD ← ¬(rA) + EXTS(SIMM) + 1", CA),
+        define(F::XO, "Subtract from Minus One Extended", op(31, 232),
+               oerc("subfme", "subfme.", "subfmeo", "subfmeo.", "rD,rA"),
+               {"sfme", "sfme.", "sfmeo", "sfmeo."}, "rD ← ¬(rA) + XER[CA] - 1", CR0_OV_CA_IN),
+        define(F::XO, "Subtract from Zero Extended", op(31, 200),
+               oerc("subfze", "subfze.", "subfzeo", "subfzeo.", "rD,rA"),
+               {"sfze", "sfze.", "sfzeo", "sfzeo."}, "rD ← ¬(rA) + XER[CA]", CR0_OV_CA_IN),
+
+        // Integer compare
+        define(F::X, "Compare", op(31, 0), one("cmp", "crfD,L,rA,rB"), {},
+               "CR[crfD] ← compare signed (rA), (rB) || XER[SO]", CRF),
+        define(F::D, "Compare Immediate", op(11), one("cmpi", "crfD,L,rA,SIMM"), {},
+               "CR[crfD] ← compare signed (rA), EXTS(SIMM) || XER[SO]", CRF),
+        define(F::X, "Compare Logical", op(31, 32), one("cmpl", "crfD,L,rA,rB"), {},
+               "CR[crfD] ← compare unsigned (rA), (rB) || XER[SO]", CRF),
+        define(F::D, "Compare Logical Immediate", op(10), one("cmpli", "crfD,L,rA,UIMM"), {},
+               "CR[crfD] ← compare unsigned (rA), (0x0000 || UIMM) || XER[SO]", CRF),
+
+        // Integer logical
+        define(F::X, "AND", op(31, 28), rc("and", "and.", "rA,rS,rB"), {}, "rA ← (rS) & (rB)", CR0),
+        define(F::X, "AND with Complement", op(31, 60), rc("andc", "andc.", "rA,rS,rB"), {},
+               "rA ← (rS) & ¬(rB)", CR0),
+        define(F::D, "AND Immediate", op(28), dot("andi.", "rA,rS,UIMM"), {"andil."},
+               "rA ← (rS) & (0x0000 || UIMM)", CR0),
+        define(F::D, "AND Immediate Shifted", op(29), dot("andis.", "rA,rS,UIMM"), {"andiu."},
+               "rA ← (rS) & (UIMM || 0x0000)", CR0),
+        define(F::X, "Count Leading Zeros Word", op(31, 26), rc("cntlzw", "cntlzw.", "rA,rS"), {"cntlz", "cntlz."},
+               "rA ← number of leading zero bits of (rS)", CR0),
+        define(F::X, "Equivalent", op(31, 284), rc("eqv", "eqv.", "rA,rS,rB"), {}, "rA ← (rS) ≡ (rB)", CR0),
+        define(F::X, "Extend Sign Byte", op(31, 954), rc("extsb", "extsb.", "rA,rS"), {},
+               "rA ← EXTS((rS)[24-31])", CR0),
+        define(F::X, "Extend Sign Half Word", op(31, 922), rc("extsh", "extsh.", "rA,rS"), {"exts", "exts."},
+               "rA ← EXTS((rS)[16-31])", CR0),
+        define(F::X, "NAND", op(31, 476), rc("nand", "nand.", "rA,rS,rB"), {}, "rA ← ¬((rS) & (rB))", CR0),
+        define(F::X, "NOR", op(31, 124), rc("nor", "nor.", "rA,rS,rB"), {}, "rA ← ¬((rS) | (rB))", CR0),
+        define(F::X, "OR", op(31, 444), rc("or", "or.", "rA,rS,rB"), {}, "rA ← (rS) | (rB)", CR0),
+        define(F::X, "OR with Complement", op(31, 412), rc("orc", "orc.", "rA,rS,rB"), {},
+               "rA ← (rS) | ¬(rB)", CR0),
+        define(F::D, "OR Immediate", op(24), one("ori", "rA,rS,UIMM"), {"oril"},
+               "rA ← (rS) | (0x0000 || UIMM)", NONE),
+        define(F::D, "OR Immediate Shifted", op(25), one("oris", "rA,rS,UIMM"), {"oriu"},
+               "rA ← (rS) | (UIMM || 0x0000)", NONE),
+        define(F::X, "XOR", op(31, 316), rc("xor", "xor.", "rA,rS,rB"), {}, "rA ← (rS) ⊕ (rB)", CR0),
+        define(F::D, "XOR Immediate", op(26), one("xori", "rA,rS,UIMM"), {"xoril"},
+               "rA ← (rS) ⊕ (0x0000 || UIMM)", NONE),
+        define(F::D, "XOR Immediate Shifted", op(27), one("xoris", "rA,rS,UIMM"), {"xoriu"},
+               "rA ← (rS) ⊕ (UIMM || 0x0000)", NONE),
+
+        // Integer rotate and shift
+        define(F::M, "Rotate Left Word Immediate then Mask Insert", op(20),
+               rc("rlwimi", "rlwimi.", "rA,rS,SH,MB,ME"), {"rlimi", "rlimi."},
+               "m ← MASK(MB, ME); rA ← (ROTL(rS, SH) & m) | ((rA) & ¬m)", CR0),
+        define(F::M, "Rotate Left Word Immediate then AND with Mask", op(21),
+               rc("rlwinm", "rlwinm.", "rA,rS,SH,MB,ME"), {"rlinm", "rlinm."},
+               "rA ← ROTL(rS, SH) & MASK(MB, ME)", CR0),
+        define(F::M, "Rotate Left Word then AND with Mask", op(23),
+               rc("rlwnm", "rlwnm.", "rA,rS,rB,MB,ME"), {"rlnm", "rlnm."},
+               "rA ← ROTL(rS, (rB)[27-31]) & MASK(MB, ME)", CR0),
+        define(F::X, "Shift Left Word", op(31, 24), rc("slw", "slw.", "rA,rS,rB"), {"sl", "sl."},
+               "rA ← (rS) << (rB)[26-31]", CR0),
+        define(F::X, "Shift Right Algebraic Word", op(31, 792), rc("sraw", "sraw.", "rA,rS,rB"), {"sra", "sra."},
+               "rA ← (rS) >> (rB)[26-31] (signed); XER[CA] ← shifted-out ones and (rS) < 0", CR0_CA),
+        define(F::X, "Shift Right Algebraic Word Immediate", op(31, 824), rc("srawi", "srawi.", "rA,rS,SH"),
+               {"srai", "srai."}, "rA ← (rS) >> SH (signed); XER[CA] ← shifted-out ones and (rS) < 0", CR0_CA),
+        define(F::X, "Shift Right Word", op(31, 536), rc("srw", "srw.", "rA,rS,rB"), {"sr", "sr."},
+               "rA ← (rS) >> (rB)[26-31]", CR0),
+
+        // Floating-point arithmetic
+        define(F::A, "Floating Add", op(63, 21), rc("fadd", "fadd.", "frD,frA,frB"), {"fa", "fa."},
+               "frD ← (frA) + (frB)", CR1),
+        define(F::A, "Floating Add Single", op(59, 21), rc("fadds", "fadds.", "frD,frA,frB"), {},
+               "frD ← SINGLE((frA) + (frB))", CR1),
+        define(F::A, "Floating Divide", op(63, 18), rc("fdiv", "fdiv.", "frD,frA,frB"), {"fd", "fd."},
+               "frD ← (frA) ÷ (frB)", CR1),
+        define(F::A, "Floating Divide Single", op(59, 18), rc("fdivs", "fdivs.", "frD,frA,frB"), {},
+               "frD ← SINGLE((frA) ÷ (frB))", CR1),
+        define(F::A, "Floating Multiply", op(63, 25), rc("fmul", "fmul.", "frD,frA,frC"), {"fm", "fm."},
+               "frD ← (frA) × (frC)", CR1),
+        define(F::A, "Floating Multiply Single", op(59, 25), rc("fmuls", "fmuls.", "frD,frA,frC"), {},
+               "frD ← SINGLE((frA) × (frC))", CR1),
+        optional(define(F::A, "Floating Reciprocal Estimate Single", op(59, 24), rc("fres", "fres.", "frD,frB"), {},
+                        "frD ← estimate of 1 ÷ (frB)", CR1)),
+        optional(define(F::A, "Floating Reciprocal Square Root Estimate", op(63, 26),
+                        rc("frsqrte", "frsqrte.", "frD,frB"), {}, "frD ← estimate of 1 ÷ √(frB)", CR1)),
+        optional(define(F::A, "Floating Select", op(63, 23), rc("fsel", "fsel.", "frD,frA,frC,frB"), {},
+                        "if (frA) ≥ 0 then frD ← (frC) else frD ← (frB)", CR1)),
+        optional(define(F::A, "Floating Square Root", op(63, 22), rc("fsqrt", "fsqrt.", "frD,frB"), {},
+                        "frD ← √(frB)", CR1)),
+        optional(define(F::A, "Floating Square Root Single", op(59, 22), rc("fsqrts", "fsqrts.", "frD,frB"), {},
+                        "frD ← SINGLE(√(frB))", CR1)),
+        define(F::A, "Floating Subtract", op(63, 20), rc("fsub", "fsub.", "frD,frA,frB"), {"fs", "fs."},
+               "frD ← (frA) - (frB)", CR1),
+        define(F::A, "Floating Subtract Single", op(59, 20), rc("fsubs", "fsubs.", "frD,frA,frB"), {},
+               "frD ← SINGLE((frA) - (frB))", CR1),
+
+        // Floating-point multiply-add
+        define(F::A, "Floating Multiply-Add", op(63, 29), rc("fmadd", "fmadd.", "frD,frA,frC,frB"), {"fma", "fma."},
+               "frD ← (frA) × (frC) + (frB)", CR1),
+        define(F::A, "Floating Multiply-Add Single", op(59, 29), rc("fmadds", "fmadds.", "frD,frA,frC,frB"), {},
+               "frD ← SINGLE((frA) × (frC) + (frB))", CR1),
+        define(F::A, "Floating Multiply-Subtract", op(63, 28), rc("fmsub", "fmsub.", "frD,frA,frC,frB"),
+               {"fms", "fms."}, "frD ← (frA) × (frC) - (frB)", CR1),
+        define(F::A, "Floating Multiply-Subtract Single", op(59, 28), rc("fmsubs", "fmsubs.", "frD,frA,frC,frB"), {},
+               "frD ← SINGLE((frA) × (frC) - (frB))", CR1),
+        define(F::A, "Floating Negative Multiply-Add", op(63, 31), rc("fnmadd", "fnmadd.", "frD,frA,frC,frB"),
+               {"fnma", "fnma."}, "frD ← -((frA) × (frC) + (frB))", CR1),
+        define(F::A, "Floating Negative Multiply-Add Single", op(59, 31),
+               rc("fnmadds", "fnmadds.", "frD,frA,frC,frB"), {}, "frD ← SINGLE(-((frA) × (frC) + (frB)))", CR1),
+        define(F::A, "Floating Negative Multiply-Subtract", op(63, 30), rc("fnmsub", "fnmsub.", "frD,frA,frC,frB"),
+               {"fnms", "fnms."}, "frD ← -((frA) × (frC) - (frB))", CR1),
+        define(F::A, "Floating Negative Multiply-Subtract Single", op(59, 30),
+               rc("fnmsubs", "fnmsubs.", "frD,frA,frC,frB"), {}, "frD ← SINGLE(-((frA) × (frC) - (frB)))", CR1),
+
+        // Floating-point rounding, conversion and compare
+        define(F::X, "Floating Convert to Integer Word", op(63, 14), rc("fctiw", "fctiw.", "frD,frB"), {},
+               "frD[32-63] ← ROUND_TO_INT32((frB), FPSCR[RN])", CR1),
+        define(F::X, "Floating Convert to Integer Word with Round toward Zero", op(63, 15),
+               rc("fctiwz", "fctiwz.", "frD,frB"), {}, "frD[32-63] ← TRUNCATE_TO_INT32((frB))", CR1),
+        define(F::X, "Floating Round to Single", op(63, 12), rc("frsp", "frsp.", "frD,frB"), {},
+               "frD ← SINGLE((frB))", CR1),
+        define(F::X, "Floating Compare Ordered", op(63, 32), one("fcmpo", "crfD,frA,frB"), {},
+               "CR[crfD] ← compare (frA), (frB); VXVC on NaN", CRF_FP),
+        define(F::X, "Floating Compare Unordered", op(63, 0), one("fcmpu", "crfD,frA,frB"), {},
+               "CR[crfD] ← compare (frA), (frB)", CRF_FP),
+
+        // Floating-point status and control register
+        define(F::X, "Move to Condition Register from FPSCR", op(63, 64), one("mcrfs", "crfD,crfS"), {},
+               "CR[crfD] ← FPSCR[crfS]; clear exception bits of FPSCR[crfS]", CRF_FP),
+        define(F::X, "Move from FPSCR", op(63, 583), rc("mffs", "mffs.", "frD"), {}, "frD[32-63] ← FPSCR", CR1),
+        define(F::X, "Move to FPSCR Bit 0", op(63, 70), rc("mtfsb0", "mtfsb0.", "crbD"), {},
+               "FPSCR[crbD] ← 0", CR1),
+        define(F::X, "Move to FPSCR Bit 1", op(63, 38), rc("mtfsb1", "mtfsb1.", "crbD"), {},
+               "FPSCR[crbD] ← 1", CR1),
+        define(F::XFL, "Move to FPSCR Fields", op(63, 711), rc("mtfsf", "mtfsf.", "FM,frB"), {},
+               "FPSCR ← (frB)[32-63] under field mask FM", CR1),
+        define(F::X, "Move to FPSCR Field Immediate", op(63, 134), rc("mtfsfi", "mtfsfi.", "crfD,IMM"), {},
+               "FPSCR[crfD] ← IMM", CR1),
+
+        // Floating-point move
+        define(F::X, "Floating Absolute Value", op(63, 264), rc("fabs", "fabs.", "frD,frB"), {},
+               "frD ← |(frB)|", CR1),
+        define(F::X, "Floating Move Register", op(63, 72), rc("fmr", "fmr.", "frD,frB"), {}, "frD ← (frB)", CR1),
+        define(F::X, "Floating Negative Absolute Value", op(63, 136), rc("fnabs", "fnabs.", "frD,frB"), {},
+               "frD ← -|(frB)|", CR1),
+        define(F::X, "Floating Negate", op(63, 40), rc("fneg", "fneg.", "frD,frB"), {}, "frD ← -(frB)", CR1),
+
+        // Integer load
+        define(F::D, "Load Byte and Zero", op(34), one("lbz", "rD,d(rA)"), {},
+               "rD ← (24)0 || MEM(EA, 1)", NONE),
+        define(F::D, "Load Byte and Zero with Update", op(35), one("lbzu", "rD,d(rA)"), {},
+               "rD ← (24)0 || MEM(EA, 1); rA ← EA", NONE),
+        define(F::X, "Load Byte and Zero with Update Indexed", op(31, 119), one("lbzux", "rD,rA,rB"), {},
+               "rD ← (24)0 || MEM(EA, 1); rA ← EA", NONE),
+        define(F::X, "Load Byte and Zero Indexed", op(31, 87), one("lbzx", "rD,rA,rB"), {},
+               "rD ← (24)0 || MEM(EA, 1)", NONE),
+        define(F::D, "Load Half Word Algebraic", op(42), one("lha", "rD,d(rA)"), {},
+               "rD ← EXTS(MEM(EA, 2))", NONE),
+        define(F::D, "Load Half Word Algebraic with Update", op(43), one("lhau", "rD,d(rA)"), {},
+               "rD ← EXTS(MEM(EA, 2)); rA ← EA", NONE),
+        define(F::X, "Load Half Word Algebraic with Update Indexed", op(31, 375), one("lhaux", "rD,rA,rB"), {},
+               "rD ← EXTS(MEM(EA, 2)); rA ← EA", NONE),
+        define(F::X, "Load Half Word Algebraic Indexed", op(31, 343), one("lhax", "rD,rA,rB"), {},
+               "rD ← EXTS(MEM(EA, 2))", NONE),
+        define(F::X, "Load Half Word Byte-Reverse Indexed", op(31, 790), one("lhbrx", "rD,rA,rB"), {},
+               "rD ← (16)0 || BYTE_REVERSE(MEM(EA, 2))", NONE),
+        define(F::D, "Load Half Word and Zero", op(40), one("lhz", "rD,d(rA)"), {},
+               "rD ← (16)0 || MEM(EA, 2)", NONE),
+        define(F::D, "Load Half Word and Zero with Update", op(41), one("lhzu", "rD,d(rA)"), {},
+               "rD ← (16)0 || MEM(EA, 2); rA ← EA", NONE),
+        define(F::X, "Load Half Word and Zero with Update Indexed", op(31, 311), one("lhzux", "rD,rA,rB"), {},
+               "rD ← (16)0 || MEM(EA, 2); rA ← EA", NONE),
+        define(F::X, "Load Half Word and Zero Indexed", op(31, 279), one("lhzx", "rD,rA,rB"), {},
+               "rD ← (16)0 || MEM(EA, 2)", NONE),
+        define(F::D, "Load Multiple Word", op(46), one("lmw", "rD,d(rA)"), {"lm"},
+               "for r from rD to r31: GPR(r) ← MEM(EA, 4); EA ← EA + 4", NONE),
+        define(F::X, "Load String Word Immediate", op(31, 597), one("lswi", "rD,rA,NB"), {"lsi"},
+               "load NB bytes starting at (rA|0) into consecutive registers from rD", NONE),
+        define(F::X, "Load String Word Indexed", op(31, 533), one("lswx", "rD,rA,rB"), {"lsx"},
+               "load XER[25-31] bytes starting at EA into consecutive registers from rD", NONE),
+        define(F::X, "Load Word and Reserve Indexed", op(31, 20), one("lwarx", "rD,rA,rB"), {},
+               "RESERVE ← 1; rD ← MEM(EA, 4)", NONE),
+        define(F::X, "Load Word Byte-Reverse Indexed", op(31, 534), one("lwbrx", "rD,rA,rB"), {"lbrx"},
+               "rD ← BYTE_REVERSE(MEM(EA, 4))", NONE),
+        define(F::D, "Load Word and Zero", op(32), one("lwz", "rD,d(rA)"), {"l"}, "rD ← MEM(EA, 4)", NONE),
+        define(F::D, "Load Word and Zero with Update", op(33), one("lwzu", "rD,d(rA)"), {"lu"},
+               "rD ← MEM(EA, 4); rA ← EA", NONE),
+        define(F::X, "Load Word and Zero with Update Indexed", op(31, 55), one("lwzux", "rD,rA,rB"), {"lux"},
+               "rD ← MEM(EA, 4); rA ← EA", NONE),
+        define(F::X, "Load Word and Zero Indexed", op(31, 23), one("lwzx", "rD,rA,rB"), {"lx"},
+               "rD ← MEM(EA, 4)", NONE),
+
+        // Integer store
+        define(F::D, "Store Byte", op(38), one("stb", "rS,d(rA)"), {}, "MEM(EA, 1) ← (rS)[24-31]", NONE),
+        define(F::D, "Store Byte with Update", op(39), one("stbu", "rS,d(rA)"), {},
+               "MEM(EA, 1) ← (rS)[24-31]; rA ← EA", NONE),
+        define(F::X, "Store Byte with Update Indexed", op(31, 247), one("stbux", "rS,rA,rB"), {},
+               "MEM(EA, 1) ← (rS)[24-31]; rA ← EA", NONE),
+        define(F::X, "Store Byte Indexed", op(31, 215), one("stbx", "rS,rA,rB"), {},
+               "MEM(EA, 1) ← (rS)[24-31]", NONE),
+        define(F::D, "Store Half Word", op(44), one("sth", "rS,d(rA)"), {}, "MEM(EA, 2) ← (rS)[16-31]", NONE),
+        define(F::X, "Store Half Word Byte-Reverse Indexed", op(31, 918), one("sthbrx", "rS,rA,rB"), {},
+               "MEM(EA, 2) ← BYTE_REVERSE((rS)[16-31])", NONE),
+        define(F::D, "Store Half Word with Update", op(45), one("sthu", "rS,d(rA)"), {},
+               "MEM(EA, 2) ← (rS)[16-31]; rA ← EA", NONE),
+        define(F::X, "Store Half Word with Update Indexed", op(31, 439), one("sthux", "rS,rA,rB"), {},
+               "MEM(EA, 2) ← (rS)[16-31]; rA ← EA", NONE),
+        define(F::X, "Store Half Word Indexed", op(31, 407), one("sthx", "rS,rA,rB"), {},
+               "MEM(EA, 2) ← (rS)[16-31]", NONE),
+        define(F::D, "Store Multiple Word", op(47), one("stmw", "rS,d(rA)"), {"stm"},
+               "for r from rS to r31: MEM(EA, 4) ← GPR(r); EA ← EA + 4", NONE),
+        define(F::X, "Store String Word Immediate", op(31, 725), one("stswi", "rS,rA,NB"), {"stsi"},
+               "store NB bytes from consecutive registers starting at rS to (rA|0)", NONE),
+        define(F::X, "Store String Word Indexed", op(31, 661), one("stswx", "rS,rA,rB"), {"stsx"},
+               "store XER[25-31] bytes from consecutive registers starting at rS to EA", NONE),
+        define(F::D, "Store Word", op(36), one("stw", "rS,d(rA)"), {"st"}, "MEM(EA, 4) ← (rS)", NONE),
+        define(F::X, "Store Word Byte-Reverse Indexed", op(31, 662), one("stwbrx", "rS,rA,rB"), {"stbrx"},
+               "MEM(EA, 4) ← BYTE_REVERSE((rS))", NONE),
+        define(F::X, "Store Word Conditional Indexed", op(31, 150), dot("stwcx.", "rS,rA,rB"), {},
+               "if RESERVE then MEM(EA, 4) ← (rS); CR0 ← 0b00 || RESERVE || XER[SO]; RESERVE ← 0", CR0),
+        define(F::D, "Store Word with Update", op(37), one("stwu", "rS,d(rA)"), {"stu"},
+               "MEM(EA, 4) ← (rS); rA ← EA", NONE),
+        define(F::X, "Store Word with Update Indexed", op(31, 183), one("stwux", "rS,rA,rB"), {"stux"},
+               "MEM(EA, 4) ← (rS); rA ← EA", NONE),
+        define(F::X, "Store Word Indexed", op(31, 151), one("stwx", "rS,rA,rB"), {"stx"},
+               "MEM(EA, 4) ← (rS)", NONE),
+
+        // Floating-point load and store
+        define(F::D, "Load Floating-Point Double", op(50), one("lfd", "frD,d(rA)"), {}, "frD ← MEM(EA, 8)", NONE),
+        define(F::D, "Load Floating-Point Double with Update", op(51), one("lfdu", "frD,d(rA)"), {},
+               "frD ← MEM(EA, 8); rA ← EA", NONE),
+        define(F::X, "Load Floating-Point Double with Update Indexed", op(31, 631), one("lfdux", "frD,rA,rB"), {},
+               "frD ← MEM(EA, 8); rA ← EA", NONE),
+        define(F::X, "Load Floating-Point Double Indexed", op(31, 599), one("lfdx", "frD,rA,rB"), {},
+               "frD ← MEM(EA, 8)", NONE),
+        define(F::D, "Load Floating-Point Single", op(48), one("lfs", "frD,d(rA)"), {},
+               "frD ← DOUBLE(MEM(EA, 4))", NONE),
+        define(F::D, "Load Floating-Point Single with Update", op(49), one("lfsu", "frD,d(rA)"), {},
+               "frD ← DOUBLE(MEM(EA, 4)); rA ← EA", NONE),
+        define(F::X, "Load Floating-Point Single with Update Indexed", op(31, 567), one("lfsux", "frD,rA,rB"), {},
+               "frD ← DOUBLE(MEM(EA, 4)); rA ← EA", NONE),
+        define(F::X, "Load Floating-Point Single Indexed", op(31, 535), one("lfsx", "frD,rA,rB"), {},
+               "frD ← DOUBLE(MEM(EA, 4))", NONE),
+        define(F::D, "Store Floating-Point Double", op(54), one("stfd", "frS,d(rA)"), {}, "MEM(EA, 8) ← (frS)", NONE),
+        define(F::D, "Store Floating-Point Double with Update", op(55), one("stfdu", "frS,d(rA)"), {},
+               "MEM(EA, 8) ← (frS); rA ← EA", NONE),
+        define(F::X, "Store Floating-Point Double with Update Indexed", op(31, 759), one("stfdux", "frS,rA,rB"), {},
+               "MEM(EA, 8) ← (frS); rA ← EA", NONE),
+        define(F::X, "Store Floating-Point Double Indexed", op(31, 727), one("stfdx", "frS,rA,rB"), {},
+               "MEM(EA, 8) ← (frS)", NONE),
+        optional(define(F::X, "Store Floating-Point as Integer Word Indexed", op(31, 983),
+                        one("stfiwx", "frS,rA,rB"), {}, "MEM(EA, 4) ← (frS)[32-63]", NONE)),
+        define(F::D, "Store Floating-Point Single", op(52), one("stfs", "frS,d(rA)"), {},
+               "MEM(EA, 4) ← SINGLE((frS))", NONE),
+        define(F::D, "Store Floating-Point Single with Update", op(53), one("stfsu", "frS,d(rA)"), {},
+               "MEM(EA, 4) ← SINGLE((frS)); rA ← EA", NONE),
+        define(F::X, "Store Floating-Point Single with Update Indexed", op(31, 695), one("stfsux", "frS,rA,rB"), {},
+               "MEM(EA, 4) ← SINGLE((frS)); rA ← EA", NONE),
+        define(F::X, "Store Floating-Point Single Indexed", op(31, 663), one("stfsx", "frS,rA,rB"), {},
+               "MEM(EA, 4) ← SINGLE((frS))", NONE),
+
+        // Branch and system call
+        define(F::I, "Branch", op(18), aalk("b", "ba", "bl", "bla", "target_addr"), {},
+               "if AA then NIA ← EXTS(LI || 0b00) else NIA ← CIA + EXTS(LI || 0b00); if LK then LR ← CIA + 4", NONE),
+        define(F::B, "Branch Conditional", op(16), aalk("bc", "bca", "bcl", "bcla", "BO,BI,target_addr"), {},
+               "if ¬BO[2] then CTR ← CTR - 1; if ctr_ok & cond_ok then NIA ← target; if LK then LR ← CIA + 4", COND),
+        define(F::XL, "Branch Conditional to Count Register", op(19, 528), lk("bcctr", "bcctrl", "BO,BI"),
+               {"bcc", "bccl"}, "if cond_ok then NIA ← CTR[0-29] || 0b00; if LK then LR ← CIA + 4", COND),
+        define(F::XL, "Branch Conditional to Link Register", op(19, 16), lk("bclr", "bclrl", "BO,BI"),
+               {"bcr", "bcrl"}, "if ¬BO[2] then CTR ← CTR - 1; if ctr_ok & cond_ok then NIA ← LR[0-29] || 0b00",
+               COND),
+        define(F::SC, "System Call", op(17) | 2, one("sc", ""), {"svca"}, "SRR0 ← CIA + 4; NIA ← 0x00000C00", NONE),
+
+        // Condition register logical
+        define(F::XL, "Condition Register AND", op(19, 257), one("crand", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← CR[crbA] & CR[crbB]", CRB),
+        define(F::XL, "Condition Register AND with Complement", op(19, 129), one("crandc", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← CR[crbA] & ¬CR[crbB]", CRB),
+        define(F::XL, "Condition Register Equivalent", op(19, 289), one("creqv", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← CR[crbA] ≡ CR[crbB]", CRB),
+        define(F::XL, "Condition Register NAND", op(19, 225), one("crnand", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← ¬(CR[crbA] & CR[crbB])", CRB),
+        define(F::XL, "Condition Register NOR", op(19, 33), one("crnor", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← ¬(CR[crbA] | CR[crbB])", CRB),
+        define(F::XL, "Condition Register OR", op(19, 449), one("cror", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← CR[crbA] | CR[crbB]", CRB),
+        define(F::XL, "Condition Register OR with Complement", op(19, 417), one("crorc", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← CR[crbA] | ¬CR[crbB]", CRB),
+        define(F::XL, "Condition Register XOR", op(19, 193), one("crxor", "crbD,crbA,crbB"), {},
+               "CR[crbD] ← CR[crbA] ⊕ CR[crbB]", CRB),
+        define(F::XL, "Move Condition Register Field", op(19, 0), one("mcrf", "crfD,crfS"), {},
+               "CR[crfD] ← CR[crfS]", CRF_CRF),
+
+        // Trap
+        define(F::X, "Trap Word", op(31, 4), one("tw", "TO,rA,rB"), {"t"},
+               "if (rA) compared with (rB) matches TO then TRAP", NONE),
+        define(F::D, "Trap Word Immediate", op(3), one("twi", "TO,rA,SIMM"), {"ti"},
+               "if (rA) compared with EXTS(SIMM) matches TO then TRAP", NONE),
+
+        // Processor control
+        define(F::X, "Move to Condition Register from XER", op(31, 512), one("mcrxr", "crfD"), {},
+               "CR[crfD] ← XER[0-3]; XER[0-3] ← 0b0000", CRF_XER),
+        define(F::X, "Move from Condition Register", op(31, 19), one("mfcr", "rD"), {}, "rD ← CR", CR_IN),
+        define(F::XFX, "Move from Special-Purpose Register", op(31, 339), one("mfspr", "rD,SPR"), {},
+               "rD ← SPR(spr[5-9] || spr[0-4])", NONE),
+        define(F::XFX, "Move to Condition Register Fields", op(31, 144), one("mtcrf", "CRM,rS"), {},
+               "CR ← ((rS) & MASK(CRM)) | (CR & ¬MASK(CRM))", CR_OUT),
+        define(F::XFX, "Move to Special-Purpose Register", op(31, 467), one("mtspr", "SPR,rS"), {},
+               "SPR(spr[5-9] || spr[0-4]) ← (rS)", NONE),
+
+        // Virtual environment: cache control, ordering and time base
+        vea(define(F::X, "Data Cache Block Flush", op(31, 86), one("dcbf", "rA,rB"), {},
+                   "flush the block containing EA", NONE)),
+        vea(define(F::X, "Data Cache Block Store", op(31, 54), one("dcbst", "rA,rB"), {},
+                   "write back the block containing EA", NONE)),
+        vea(define(F::X, "Data Cache Block Touch", op(31, 278), one("dcbt", "rA,rB"), {},
+                   "hint: the block containing EA will be loaded", NONE)),
+        vea(define(F::X, "Data Cache Block Touch for Store", op(31, 246), one("dcbtst", "rA,rB"), {},
+                   "hint: the block containing EA will be stored", NONE)),
+        vea(define(F::X, "Data Cache Block Clear to Zero", op(31, 1014), one("dcbz", "rA,rB"), {"dclz"},
+                   "zero the block containing EA", NONE)),
+        vea(define(F::X, "Enforce In-Order Execution of I/O", op(31, 854), one("eieio", ""), {},
+                   "order storage accesses to caching-inhibited memory", NONE)),
+        vea(define(F::X, "Instruction Cache Block Invalidate", op(31, 982), one("icbi", "rA,rB"), {},
+                   "invalidate the instruction block containing EA", NONE)),
+        vea(define(F::XL, "Instruction Synchronize", op(19, 150), one("isync", ""), {"ics"},
+                   "wait for preceding instructions, discard prefetched instructions", NONE)),
+        vea(define(F::XFX, "Move from Time Base", op(31, 371), one("mftb", "rD,TBR"), {},
+                   "rD ← TBR(tbr[5-9] || tbr[0-4])", NONE)),
+        define(F::X, "Synchronize", op(31, 598), one("sync", ""), {"dcs"},
+               "wait until all preceding storage accesses complete", NONE),
+
+        // Simplified mnemonics. The fixed operand values are part of the base
+        // opcode; "rS|rB" puts one operand into both fields.
+        alias("ori", define(F::D, "No Operation", op(24), one("nop", ""), {}, "(ori r0,r0,0)", NONE)),
+        alias("addi", define(F::D, "Load Immediate", op(14), one("li", "rD,SIMM"), {},
+                             "rD ← EXTS(SIMM) (addi rD,0,SIMM)", NONE)),
+        alias("addis", define(F::D, "Load Immediate Shifted", op(15), one("lis", "rD,SIMM"), {},
+                              "rD ← SIMM || 0x0000 (addis rD,0,SIMM)", NONE)),
+        alias("addi", define(F::D, "Load Address", op(14), one("la", "rD,d(rA)"), {},
+                             "rD ← (rA) + EXTS(d) (addi rD,rA,d)", NONE)),
+        alias("or", define(F::X, "Move Register", op(31, 444), rc("mr", "mr.", "rA,rS|rB"), {},
+                           "rA ← (rS) (or rA,rS,rS)", CR0)),
+        alias("nor", define(F::X, "Complement Register", op(31, 124), rc("not", "not.", "rA,rS|rB"), {},
+                            "rA ← ¬(rS) (nor rA,rS,rS)", CR0)),
+        alias("subf", define(F::XO, "Subtract", op(31, 40), oerc("sub", "sub.", "subo", "subo.", "rD,rB,rA"), {},
+                             "rD ← (rB) - (rA) written as sub rD,rB,rA (subf rD,rA,rB)", CR0_OV)),
+        alias("subfc", define(F::XO, "Subtract Carrying", op(31, 8),
+                              oerc("subc", "subc.", "subco", "subco.", "rD,rB,rA"), {},
+                              "rD ← (rB) - (rA) written as subc rD,rB,rA (subfc rD,rA,rB)", CR0_OV_CA)),
+        alias("cmp", define(F::X, "Compare Word", op(31, 0), optionalFirst("cmpw", "crfD,rA,rB", "rA,rB"), {},
+                            "(cmp crfD,0,rA,rB)", CRF)),
+        alias("cmpi", define(F::D, "Compare Word Immediate", op(11), optionalFirst("cmpwi", "crfD,rA,SIMM", "rA,SIMM"),
+                             {}, "(cmpi crfD,0,rA,SIMM)", CRF)),
+        alias("cmpl", define(F::X, "Compare Logical Word", op(31, 32), optionalFirst("cmplw", "crfD,rA,rB", "rA,rB"),
+                             {}, "(cmpl crfD,0,rA,rB)", CRF)),
+        alias("cmpli", define(F::D, "Compare Logical Word Immediate", op(10),
+                              optionalFirst("cmplwi", "crfD,rA,UIMM", "rA,UIMM"), {}, "(cmpli crfD,0,rA,UIMM)", CRF)),
+        alias("bclr", define(F::XL, "Branch to Link Register", op(19, 16) | 20u << 21, lk("blr", "blrl", ""),
+                             {"br", "brl"}, "NIA ← LR[0-29] || 0b00 (bclr 20,0)", NONE)),
+        alias("bcctr", define(F::XL, "Branch to Count Register", op(19, 528) | 20u << 21, lk("bctr", "bctrl", ""),
+                              {}, "NIA ← CTR[0-29] || 0b00 (bcctr 20,0)", NONE)),
+        alias("bc", define(F::B, "Decrement CTR, Branch if Nonzero", op(16) | 16u << 21, one("bdnz", "target_addr"),
+                           {}, "CTR ← CTR - 1; if CTR ≠ 0 then NIA ← target (bc 16,0,target)", NONE)),
+        alias("bc", define(F::B, "Decrement CTR, Branch if Zero", op(16) | 18u << 21, one("bdz", "target_addr"),
+                           {}, "CTR ← CTR - 1; if CTR = 0 then NIA ← target (bc 18,0,target)", NONE)),
+        alias("bc", define(F::B, "Branch if Less Than", op(16) | 12u << 21 | 0u << 16,
+                           optionalFirst("blt", "crfS,target_addr", "target_addr"), {},
+                           "if CR[4×crfS+LT] then NIA ← target (bc 12,4×crfS,target)", COND)),
+        alias("bc", define(F::B, "Branch if Greater Than", op(16) | 12u << 21 | 1u << 16,
+                           optionalFirst("bgt", "crfS,target_addr", "target_addr"), {},
+                           "if CR[4×crfS+GT] then NIA ← target (bc 12,4×crfS+1,target)", COND)),
+        alias("bc", define(F::B, "Branch if Equal", op(16) | 12u << 21 | 2u << 16,
+                           optionalFirst("beq", "crfS,target_addr", "target_addr"), {},
+                           "if CR[4×crfS+EQ] then NIA ← target (bc 12,4×crfS+2,target)", COND)),
+        alias("bc", define(F::B, "Branch if Summary Overflow", op(16) | 12u << 21 | 3u << 16,
+                           optionalFirst("bso", "crfS,target_addr", "target_addr"), {},
+                           "if CR[4×crfS+SO] then NIA ← target (bc 12,4×crfS+3,target)", COND)),
+        alias("bc", define(F::B, "Branch if Greater Than or Equal", op(16) | 4u << 21 | 0u << 16,
+                           optionalFirst("bge", "crfS,target_addr", "target_addr"), {},
+                           "if ¬CR[4×crfS+LT] then NIA ← target (bc 4,4×crfS,target)", COND)),
+        alias("bc", define(F::B, "Branch if Less Than or Equal", op(16) | 4u << 21 | 1u << 16,
+                           optionalFirst("ble", "crfS,target_addr", "target_addr"), {},
+                           "if ¬CR[4×crfS+GT] then NIA ← target (bc 4,4×crfS+1,target)", COND)),
+        alias("bc", define(F::B, "Branch if Not Equal", op(16) | 4u << 21 | 2u << 16,
+                           optionalFirst("bne", "crfS,target_addr", "target_addr"), {},
+                           "if ¬CR[4×crfS+EQ] then NIA ← target (bc 4,4×crfS+2,target)", COND)),
+        alias("bc", define(F::B, "Branch if Not Summary Overflow", op(16) | 4u << 21 | 3u << 16,
+                           optionalFirst("bns", "crfS,target_addr", "target_addr"), {},
+                           "if ¬CR[4×crfS+SO] then NIA ← target (bc 4,4×crfS+3,target)", COND)),
+        alias("mtspr", define(F::XFX, "Move to Link Register", op(31, 467) | 8u << 16, one("mtlr", "rS"), {},
+                              "LR ← (rS) (mtspr 8,rS)", NONE)),
+        alias("mfspr", define(F::XFX, "Move from Link Register", op(31, 339) | 8u << 16, one("mflr", "rD"), {},
+                              "rD ← LR (mfspr rD,8)", NONE)),
+        alias("mtspr", define(F::XFX, "Move to Count Register", op(31, 467) | 9u << 16, one("mtctr", "rS"), {},
+                              "CTR ← (rS) (mtspr 9,rS)", NONE)),
+        alias("mfspr", define(F::XFX, "Move from Count Register", op(31, 339) | 9u << 16, one("mfctr", "rD"), {},
+                              "rD ← CTR (mfspr rD,9)", NONE)),
+        alias("mtspr", define(F::XFX, "Move to XER", op(31, 467) | 1u << 16, one("mtxer", "rS"), {},
+                              "XER ← (rS) (mtspr 1,rS)", XER_OUT)),
+        alias("mfspr", define(F::XFX, "Move from XER", op(31, 339) | 1u << 16, one("mfxer", "rD"), {},
+                              "rD ← XER (mfspr rD,1)", XER_IN)),
+        alias("mtcrf", define(F::XFX, "Move to Condition Register", op(31, 144) | 0xffu << 12, one("mtcr", "rS"), {},
+                              "CR ← (rS) (mtcrf 0xff,rS)", CR_OUT)),
+        alias("tw", define(F::X, "Trap Unconditionally", op(31, 4) | 31u << 21, one("trap", ""), {},
+                           "TRAP (tw 31,0,0)", NONE)),
+};
+
+constexpr size_t indexOf(std::string_view primary) {
+    for (size_t i = 0; i < std::size(TABLE); i++) {
+        if (TABLE[i].primary_mnemonic == primary) return i;
+    }
+    throw std::logic_error("no such instruction");
+}
+
+// Compile-time consistency checks: aliases name real instructions, and no
+// operand field overlaps a bit that the base opcode already sets.
+constexpr bool validate() {
+    for (const auto& instr : TABLE) {
+        if (!instr.alias_of.empty() && !TABLE[indexOf(instr.alias_of)].alias_of.empty()) return false;
+        for (const auto& field : instr.encoding.fields) {
+            if (field.name != "XO" && (instr.encoding.base_opcode & field.mask) != 0) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(validate(), "inconsistent instruction table");
+
+}
+
+
+// Index of an entry in the instruction table.
+enum class InstructionId : uint16_t {};
+
+inline constexpr size_t INSTRUCTION_COUNT = std::size(isa::TABLE);
+
+constexpr const PowerPCInstruction& instructionAt(InstructionId id) {
+    return isa::TABLE[static_cast<size_t>(id)];
+}
+
+// Looks an instruction up by primary mnemonic; meant for constant
+// expressions, where an unknown name is a compile error.
+constexpr InstructionId instructionId(std::string_view primary) {
+    return static_cast<InstructionId>(isa::indexOf(primary));
+}
+
+constexpr InstructionId baseInstruction(InstructionId id) {
+    const PowerPCInstruction& instr = instructionAt(id);
+    return instr.alias_of.empty() ? id : instructionId(instr.alias_of);
+}
+
+
+#endif //PPCASM_POWERPCINSTRUCTIONTABLE_H
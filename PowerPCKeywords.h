@@ -0,0 +1,166 @@
+#ifndef PPCASM_POWERPCKEYWORDS_H
+#define PPCASM_POWERPCKEYWORDS_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include "PerfectHash.h"
+#include "PowerPCInstructionTable.h"
+
+
+enum class KeywordKind : uint8_t {
+    Mnemonic,
+    GPR,
+    FPR,
+    CRField,
+    SPR
+};
+
+
+// Spelling flags of a mnemonic: which optional encoding bits it sets, and
+// whether it is the old POWER name of the instruction.
+enum KeywordFlags : uint8_t {
+    KW_OE = 1 << 0,
+    KW_RC = 1 << 1,
+    KW_LK = 1 << 2,
+    KW_AA = 1 << 3,
+    KW_POWER = 1 << 4
+};
+
+
+// Every reserved word of the assembler. For mnemonics `value` is the
+// InstructionId, for registers the register (or SPR) number.
+struct Keyword {
+    std::string_view text;
+    KeywordKind kind = KeywordKind::Mnemonic;
+    uint8_t flags = 0;
+    uint16_t value = 0;
+};
+
+
+namespace keywords {
+
+constexpr Keyword reg(std::string_view text, KeywordKind kind, uint16_t number) {
+    return {text, kind, 0, number};
+}
+
+inline constexpr Keyword REGISTERS[] = {
+        reg("r0", KeywordKind::GPR, 0), reg("r1", KeywordKind::GPR, 1),
+        reg("r2", KeywordKind::GPR, 2), reg("r3", KeywordKind::GPR, 3),
+        reg("r4", KeywordKind::GPR, 4), reg("r5", KeywordKind::GPR, 5),
+        reg("r6", KeywordKind::GPR, 6), reg("r7", KeywordKind::GPR, 7),
+        reg("r8", KeywordKind::GPR, 8), reg("r9", KeywordKind::GPR, 9),
+        reg("r10", KeywordKind::GPR, 10), reg("r11", KeywordKind::GPR, 11),
+        reg("r12", KeywordKind::GPR, 12), reg("r13", KeywordKind::GPR, 13),
+        reg("r14", KeywordKind::GPR, 14), reg("r15", KeywordKind::GPR, 15),
+        reg("r16", KeywordKind::GPR, 16), reg("r17", KeywordKind::GPR, 17),
+        reg("r18", KeywordKind::GPR, 18), reg("r19", KeywordKind::GPR, 19),
+        reg("r20", KeywordKind::GPR, 20), reg("r21", KeywordKind::GPR, 21),
+        reg("r22", KeywordKind::GPR, 22), reg("r23", KeywordKind::GPR, 23),
+        reg("r24", KeywordKind::GPR, 24), reg("r25", KeywordKind::GPR, 25),
+        reg("r26", KeywordKind::GPR, 26), reg("r27", KeywordKind::GPR, 27),
+        reg("r28", KeywordKind::GPR, 28), reg("r29", KeywordKind::GPR, 29),
+        reg("r30", KeywordKind::GPR, 30), reg("r31", KeywordKind::GPR, 31),
+
+        reg("f0", KeywordKind::FPR, 0), reg("f1", KeywordKind::FPR, 1),
+        reg("f2", KeywordKind::FPR, 2), reg("f3", KeywordKind::FPR, 3),
+        reg("f4", KeywordKind::FPR, 4), reg("f5", KeywordKind::FPR, 5),
+        reg("f6", KeywordKind::FPR, 6), reg("f7", KeywordKind::FPR, 7),
+        reg("f8", KeywordKind::FPR, 8), reg("f9", KeywordKind::FPR, 9),
+        reg("f10", KeywordKind::FPR, 10), reg("f11", KeywordKind::FPR, 11),
+        reg("f12", KeywordKind::FPR, 12), reg("f13", KeywordKind::FPR, 13),
+        reg("f14", KeywordKind::FPR, 14), reg("f15", KeywordKind::FPR, 15),
+        reg("f16", KeywordKind::FPR, 16), reg("f17", KeywordKind::FPR, 17),
+        reg("f18", KeywordKind::FPR, 18), reg("f19", KeywordKind::FPR, 19),
+        reg("f20", KeywordKind::FPR, 20), reg("f21", KeywordKind::FPR, 21),
+        reg("f22", KeywordKind::FPR, 22), reg("f23", KeywordKind::FPR, 23),
+        reg("f24", KeywordKind::FPR, 24), reg("f25", KeywordKind::FPR, 25),
+        reg("f26", KeywordKind::FPR, 26), reg("f27", KeywordKind::FPR, 27),
+        reg("f28", KeywordKind::FPR, 28), reg("f29", KeywordKind::FPR, 29),
+        reg("f30", KeywordKind::FPR, 30), reg("f31", KeywordKind::FPR, 31),
+
+        reg("cr0", KeywordKind::CRField, 0), reg("cr1", KeywordKind::CRField, 1),
+        reg("cr2", KeywordKind::CRField, 2), reg("cr3", KeywordKind::CRField, 3),
+        reg("cr4", KeywordKind::CRField, 4), reg("cr5", KeywordKind::CRField, 5),
+        reg("cr6", KeywordKind::CRField, 6), reg("cr7", KeywordKind::CRField, 7),
+
+        reg("xer", KeywordKind::SPR, 1),
+        reg("lr", KeywordKind::SPR, 8),
+        reg("ctr", KeywordKind::SPR, 9),
+};
+
+constexpr uint8_t variantFlags(const PowerPCInstruction::SyntaxVariant& variant) {
+    return static_cast<uint8_t>((variant.oe ? KW_OE : 0) | (variant.rc ? KW_RC : 0) |
+                                (variant.lk ? KW_LK : 0) | (variant.aa ? KW_AA : 0));
+}
+
+// Variants that only differ in their operands share one spelling.
+constexpr bool isFirstSpelling(const PowerPCInstruction& instr, size_t variant) {
+    for (size_t i = 0; i < variant; i++) {
+        if (instr.syntax_variants[i].mnemonic == instr.syntax_variants[variant].mnemonic) return false;
+    }
+    return true;
+}
+
+constexpr size_t mnemonicCount() {
+    size_t count = 0;
+    for (const auto& instr : isa::TABLE) {
+        for (size_t i = 0; i < instr.syntax_variants.size(); i++) {
+            if (isFirstSpelling(instr, i)) count++;
+        }
+        count += instr.power_mnemonics.size();
+    }
+    return count;
+}
+
+inline constexpr size_t COUNT = mnemonicCount() + std::size(REGISTERS);
+
+// Mnemonics come straight from the instruction table; a POWER name takes
+// the flags of the variant at the same position.
+constexpr std::array<Keyword, COUNT> build() {
+    std::array<Keyword, COUNT> result{};
+    size_t n = 0;
+    for (size_t id = 0; id < INSTRUCTION_COUNT; id++) {
+        const PowerPCInstruction& instr = isa::TABLE[id];
+        for (size_t i = 0; i < instr.syntax_variants.size(); i++) {
+            if (!isFirstSpelling(instr, i)) continue;
+            const auto& variant = instr.syntax_variants[i];
+            result[n++] = {variant.mnemonic, KeywordKind::Mnemonic, variantFlags(variant), static_cast<uint16_t>(id)};
+        }
+        for (size_t i = 0; i < instr.power_mnemonics.size(); i++) {
+            uint8_t flags = i < instr.syntax_variants.size() ? variantFlags(instr.syntax_variants[i]) : 0;
+            result[n++] = {instr.power_mnemonics[i], KeywordKind::Mnemonic, static_cast<uint8_t>(flags | KW_POWER),
+                           static_cast<uint16_t>(id)};
+        }
+    }
+    for (const Keyword& keyword : REGISTERS) result[n++] = keyword;
+    return result;
+}
+
+inline constexpr std::array<Keyword, COUNT> TABLE = build();
+
+constexpr std::array<std::string_view, COUNT> texts() {
+    std::array<std::string_view, COUNT> result{};
+    for (size_t i = 0; i < COUNT; i++) result[i] = TABLE[i].text;
+    return result;
+}
+
+inline constexpr PerfectHash<COUNT> HASH{texts()};
+
+}
+
+
+// Index into keywords::TABLE, or -1 if `word` is not reserved.
+constexpr int findKeyword(std::string_view word) {
+    return keywords::HASH.find(word);
+}
+
+constexpr const Keyword& keywordAt(size_t index) {
+    return keywords::TABLE[index];
+}
+
+
+#endif //PPCASM_POWERPCKEYWORDS_H
@@ -0,0 +1,43 @@
+#ifndef PPCASM_POWERPCOPERAND_H
+#define PPCASM_POWERPCOPERAND_H
+
+
+#include <cstdint>
+
+
+// Operand as written in the source, before it is matched against a syntax
+// string. Immediates are typed by their spelling: a leading minus makes a
+// SignedImmediate, anything else (including 0xffffffff, which does not fit
+// int32_t) an UnsignedImmediate, so the 32-bit value is never ambiguous.
+enum class OperandKind : uint8_t {
+    GPR,
+    FPR,
+    CRField,
+    SPR,
+    SignedImmediate,
+    UnsignedImmediate,
+    Displacement,   // value(base), as in "stw r5, 8(r1)"
+    Label           // symbol + value, as in "b loop" or "b table+8"
+};
+
+inline const char* operandKindName(OperandKind kind) {
+    static const char* const kindNames[] = {
+            "general-purpose register", "floating-point register", "condition register field",
+            "special-purpose register", "signed immediate", "unsigned immediate", "displacement", "label"
+    };
+    return kindNames[static_cast<int>(kind)];
+}
+
+
+// Plain data, so operand lists can live in an Arena and be copied freely.
+struct Operand {
+    OperandKind kind;
+    uint8_t base;       // base GPR of a Displacement
+    int32_t value;      // register number, immediate, displacement or label addend
+    uint32_t symbol;    // SymbolTable id of a Label
+};
+
+static_assert(sizeof(Operand) == 12, "Operand lists are stored packed");
+
+
+#endif //PPCASM_POWERPCOPERAND_H
@@ -1,182 +1,533 @@
-
-#include <iostream>
-#include <vector>
+#include "PowerPCParser.h"
+#include <array>
+#include <cstring>
+#include <iterator>
 #include <string>
-#include <unordered_map>
-#include <memory>
-#include <stdexcept>
-#include "lexer.h"
+#include "PowerPCEncoder.h"
+#include "NumberLiteral.h"
+#include "PerfectHash.h"
+
+namespace {
+
+enum class DirectiveKind : uint8_t {
+    Value,
+    Text,
+    Data,
+    Section,
+    Global,
+    Align,
+    P2Align,
+    BAlign,
+    Space
+};
+
+struct DirectiveSpec {
+    std::string_view name;
+    DirectiveKind kind;
+    uint8_t size;   // of each value
+};
+
+// As in GNU as for PowerPC, .word is two bytes and .align takes a power of
+// two. Names are looked up through a perfect hash, like mnemonics.
+constexpr DirectiveSpec DIRECTIVES[] = {
+        {".long", DirectiveKind::Value, 4},
+        {".byte", DirectiveKind::Value, 1},
+        {".short", DirectiveKind::Value, 2},
+        {".quad", DirectiveKind::Value, 8},
+        {".int", DirectiveKind::Value, 4},
+        {".word", DirectiveKind::Value, 2},
+        {".hword", DirectiveKind::Value, 2},
+        {".text", DirectiveKind::Text, 0},
+        {".data", DirectiveKind::Data, 0},
+        {".section", DirectiveKind::Section, 0},
+        {".global", DirectiveKind::Global, 0},
+        {".globl", DirectiveKind::Global, 0},
+        {".align", DirectiveKind::Align, 0},
+        {".p2align", DirectiveKind::P2Align, 0},
+        {".balign", DirectiveKind::BAlign, 0},
+        {".space", DirectiveKind::Space, 0},
+        {".skip", DirectiveKind::Space, 0},
+        {".zero", DirectiveKind::Space, 0},
+};
+
+constexpr size_t DIRECTIVE_COUNT = std::size(DIRECTIVES);
+
+constexpr std::array<std::string_view, DIRECTIVE_COUNT> directiveNames() {
+    std::array<std::string_view, DIRECTIVE_COUNT> names{};
+    for (size_t i = 0; i < DIRECTIVE_COUNT; i++) names[i] = DIRECTIVES[i].name;
+    return names;
+}
+
+constexpr PerfectHash<DIRECTIVE_COUNT> DIRECTIVE_HASH{directiveNames()};
+
+constexpr uint32_t NOP = 0x60000000;    // ori r0,r0,0
+constexpr uint64_t MAX_ALIGNMENT = 65536;
+constexpr uint64_t MAX_SPACE = 1u << 30;
+
+// `number` as `bytes` bytes of two's complement. False if it fits them
+// neither signed nor unsigned.
+bool fitBytes(const NumberValue& number, size_t bytes, uint64_t& value) {
+    const uint64_t limit = bytes >= 8 ? UINT64_MAX : (uint64_t(1) << (8 * bytes)) - 1;
+    if (number.negative ? number.magnitude > limit / 2 + 1 : number.magnitude > limit) return false;
+    value = number.negative ? 0 - number.magnitude : number.magnitude;
+    return true;
+}
+
+}
+
+PowerPCParser::PowerPCParser(TokenSource& tokens, SymbolTable& symbols, DiagnosticBuffer& diagnostics,
+                             Sections* sections)
+        : tokens(tokens), symbols(symbols), diagnostics(diagnostics), sections(sections), ring(), consumed(0),
+          pulled(0), exhausted(false), operands(), operandCount(0), section(SectionId::Text), addresses(),
+          errorCount(0) {
+}
+
+
+std::vector<InstructionRecord> PowerPCParser::parse() {
+    std::vector<InstructionRecord> parsed;
+    parse([&parsed](const InstructionRecord& record) { parsed.push_back(record); });
+    return parsed;
+}
+
 
-class PowerPCParser {
-public:
-    PowerPCParser(const std::vector<Token>& tokens) : tokens(tokens), current(0) {
-        initializeInstructions();
+void PowerPCParser::parse(const Sink& sink) {
+    InstructionRecord record{};
+    while (next(record)) {
+        sink(record);
     }
+}
 
 
-    std::vector<PowerPCInstruction> parse() {
-        std::vector<PowerPCInstruction> instructions;
+bool PowerPCParser::next(InstructionRecord& record) {
+    while (!isAtEnd()) {
+        if (match({TokenType::EOL})) continue;
 
-        while (!isAtEnd()) {
-            try {
+        if (check(TokenType::LABEL)) {
+            defineLabel(advance());
+            continue;
+        }
 
-                while (match({TokenType::DIRECTIVE, TokenType::LABEL})) {
-                    advance();
-                }
+        if (check(TokenType::DIRECTIVE)) {
+            Expected<void> done = parseDirective();
+            if (!done) {
+                report(done.error());
+                if (previous().getType() != TokenType::EOL) synchronize();
+            }
+            continue;
+        }
 
-                if (check(TokenType::INSTRUCTION)) {
-                    instructions.push_back(parseInstruction());
-                } else {
-                    advance();
-                    std::cerr << "Warning: Unknown token at line " << previous().getLine() << std::endl;
-                }
-            } catch (const std::runtime_error& e) {
-                std::cerr << "Error at line " << currentToken().getLine() << ": " << e.what() << std::endl;
+        if (check(TokenType::INSTRUCTION)) {
+            if (section != SectionId::Text) {
+                report(diagnosticAt(DiagnosticCode::InstructionOutsideText, currentToken()));
                 synchronize();
+                continue;
+            }
+            Expected<void> parsed = parseInstruction(record);
+            if (parsed) {
+                addresses[static_cast<size_t>(SectionId::Text)] += 4;
+                return true;
             }
+            report(parsed.error());
+            if (previous().getType() != TokenType::EOL) synchronize();
+            continue;
         }
 
-        return instructions;
+        Diagnostic unknown = diagnosticAt(DiagnosticCode::UnknownToken, advance());
+        unknown.severity = Severity::Warning;
+        diagnostics.report(unknown);
     }
 
-private:
-    const std::vector<Token>& tokens;
-    size_t current;
+    return false;
+}
 
 
-    std::unordered_map<std::string, PowerPCInstruction> instructionSet;
+void PowerPCParser::report(const Diagnostic& diagnostic) {
+    diagnostics.report(diagnostic);
+    errorCount++;
+}
 
-    void initializeInstructions() {
 
-        PowerPCInstruction add;
-        add.name = "Add";
-        add.primary_mnemonic = "add";
-        add.syntax_variants = {
-                {"add",  "rD,rA,rB", false, false},
-                {"add.", "rD,rA,rB", false, true},
-                {"addo", "rD,rA,rB", true,  false},
-                {"addo.", "rD,rA,rB", true,  true}
-        };
-        add.power_mnemonics = {"cax", "cax.", "caxo", "caxo."};
+// Drops the rest of the line. Stopping at the next mnemonic instead would
+// misread operands such as "a" (POWER for addc) as a new instruction.
+void PowerPCParser::synchronize() {
+    skipLine();
+    match({TokenType::EOL});
+}
 
 
-        add.encoding.base_opcode = 0x7C000214;
-        add.encoding.addField("D", 6, 10);
-        add.encoding.addField("A", 11, 15);
-        add.encoding.addField("B", 16, 20);
-        add.encoding.addField("OE", 21, 21);
-        add.encoding.addField("XO", 22, 30);
-        add.encoding.addField("Rc", 31, 31);
+// A duplicate label is reported without dropping the instruction after it,
+// so the addresses of the rest of the file stay right.
+void PowerPCParser::defineLabel(const Token& label) {
+    std::string_view name = text(label);
+    name.remove_suffix(1);
+    if (symbols.define(name, getAddress(), static_cast<uint32_t>(label.getLine()), section) == SymbolTable::NONE) {
+        const Symbol& first = symbols.at(symbols.find(name));
+        report(diagnosticAt(DiagnosticCode::DuplicateSymbol, label, static_cast<int32_t>(first.line), 0, 0,
+                            symbols.name(symbols.find(name))));
+    }
+}
 
 
-        add.pseudocode = "rD ← (rA) + (rB)";
-        add.description = "The sum (rA) + (rB) is placed into rD.";
+void PowerPCParser::skipLine() {
+    while (!isAtEnd() && !check(TokenType::EOL)) {
+        advance();
+    }
+}
 
 
-        add.effects = {true, true, true, true, true, true, false};
+// Token to blame for a problem at the current position.
+const Token& PowerPCParser::here() {
+    return isAtEnd() ? previous() : currentToken();
+}
 
 
-        add.arch_level = ArchLevel::USIA;
-        add.privilege_level = PrivilegeLevel::User;
-        add.is_optional = false;
-        add.form = InstructionForm::XO;
+// An instruction whose operands do not fit their fields is reported but
+// still returned, flagged RECORD_INVALID, so that it keeps its address.
+Expected<void> PowerPCParser::parseInstruction(InstructionRecord& record) {
+    const Token instrToken = advance();
+    const Keyword& keyword = keywordAt(instrToken.getAux());
+    const InstructionId id = static_cast<InstructionId>(keyword.value);
+    const PowerPCInstruction* definition = &instructionAt(id);
 
-        instructionSet["add"] = add;
-        instructionSet["add."] = add;
-        instructionSet["addo"] = add;
-        instructionSet["addo."] = add;
+    Token firstTokens[syntax::MAX_OPERANDS];
+    Expected<size_t> count = parseOperandList(operands.data(), firstTokens, operands.size());
+    if (!count) return Unexpected{count.error()};
 
+    if (!match({TokenType::EOL}) && !isAtEnd()) {
+        return Unexpected{diagnosticAt(DiagnosticCode::ExpectedEndOfLine, here())};
+    }
 
+    const size_t variant = selectVariant(id, keyword, *count);
+    if (variant == NO_VARIANT) {
+        return Unexpected{diagnosticAt(DiagnosticCode::UnsupportedForm, instrToken, 0, 0, 0, keyword.text)};
     }
 
+    const auto line = static_cast<uint32_t>(instrToken.getLine());
+    ParsedInstruction instruction{definition, &definition->syntax_variants[variant], line};
+    operandCount = *count;
+    Expected<uint32_t> symbol = bindOperands(instruction, operandProgram(id, variant), instrToken, firstTokens);
+    if (!symbol) return Unexpected{symbol.error()};
+
+    record = InstructionRecord{0, line, *symbol, id, static_cast<uint8_t>(variant),
+                               keywords::variantFlags(*instruction.variant)};
+    Expected<uint32_t> word = PowerPCEncoder::tryEncode(instruction);
+    if (word) {
+        record.word = *word;
+    } else {
+        const Diagnostic& error = word.error();
+        report(diagnosticAt(error.code, instrToken, error.arg0, error.arg1, error.arg2, error.detail));
+        record.flags |= RECORD_INVALID;
+    }
+    return {};
+}
+
+
+// Spellings differ in their OE/Rc/AA/LK bits; simplified mnemonics with an
+// optional first operand ("blt [crfS,]target") differ in operand count.
+size_t PowerPCParser::selectVariant(InstructionId id, const Keyword& keyword, size_t operandCount) const {
+    const auto& variants = instructionAt(id).syntax_variants;
+    const uint8_t flags = keyword.flags & (KW_OE | KW_RC | KW_AA | KW_LK);
+    size_t variant = NO_VARIANT;
+    for (size_t i = 0; i < variants.size(); i++) {
+        if (keywords::variantFlags(variants[i]) != flags) continue;
+        if (variant == NO_VARIANT || (operandProgram(id, variant).count != operandCount &&
+                                      operandProgram(id, i).count == operandCount)) {
+            variant = i;
+        }
+    }
+    return variant;
+}
 
-    bool isAtEnd() const { return current >= tokens.size(); }
-    const Token& currentToken() const { return tokens.at(current); }
-    const Token& previous() const { return tokens.at(current - 1); }
-    const Token& advance() { return tokens.at(current++); }
 
-    bool check(TokenType type) const {
-        if (isAtEnd()) return false;
-        return currentToken().getType() == type;
+Expected<size_t> PowerPCParser::parseOperandList(Operand* list, Token* firstTokens, size_t capacity) {
+    if (isAtEnd() || check(TokenType::EOL)) return size_t(0);
+    size_t count = 0;
+    do {
+        if (count == capacity) {
+            return Unexpected{diagnosticAt(DiagnosticCode::TooManyOperands, here())};
+        }
+        firstTokens[count] = currentToken();
+        Expected<Operand> operand = parseOperand();
+        if (!operand) return Unexpected{operand.error()};
+        list[count++] = *operand;
+    } while (match({TokenType::COMMA}));
+    return count;
+}
+
+
+// One operand: a register, an immediate, d(rA), or a label with an optional
+// addend ("table+8" lexes as a name and a signed number, "table + 8" with a
+// separate PLUS).
+Expected<Operand> PowerPCParser::parseOperand() {
+    if (check(TokenType::REGISTER)) {
+        const Keyword& keyword = keywordAt(advance().getAux());
+        OperandKind kind = OperandKind::GPR;
+        switch (keyword.kind) {
+            case KeywordKind::FPR: kind = OperandKind::FPR; break;
+            case KeywordKind::CRField: kind = OperandKind::CRField; break;
+            case KeywordKind::SPR: kind = OperandKind::SPR; break;
+            default: break;
+        }
+        return Operand{kind, 0, static_cast<int32_t>(keyword.value), SymbolTable::NONE};
     }
 
-    bool match(const std::vector<TokenType>& types) {
-        for (const auto& type : types) {
-            if (check(type)) {
-                advance();
-                return true;
+    if (check(TokenType::IDENTIFIER) || check(TokenType::INSTRUCTION)) {
+        const Token& name = advance();
+        Operand label{OperandKind::Label, 0, 0, symbols.reference(text(name), static_cast<uint32_t>(name.getLine()))};
+        if (match({TokenType::PLUS, TokenType::MINUS})) {
+            const bool minus = previous().getType() == TokenType::MINUS;
+            Expected<Operand> addend = parseImmediate();
+            if (!addend) return addend;
+            label.value = minus ? static_cast<int32_t>(0u - static_cast<uint32_t>(addend->value)) : addend->value;
+        } else if (check(TokenType::NUMBER)) {
+            const char sign = text(currentToken()).front();
+            if (sign == '+' || sign == '-') {
+                Expected<Operand> addend = parseImmediate();
+                if (!addend) return addend;
+                label.value = addend->value;
             }
         }
-        return false;
+        return label;
     }
 
+    if (check(TokenType::NUMBER)) {
+        Expected<Operand> immediate = parseImmediate();
+        if (!immediate || !match({TokenType::LPAREN})) return immediate;
 
-    void synchronize() {
-        advance();
-        while (!isAtEnd()) {
-            if (previous().getType() == TokenType::EOL) return;
-            if (check(TokenType::INSTRUCTION)) return;
-            advance();
+        Operand operand = *immediate;
+        if (!check(TokenType::REGISTER) || keywordAt(currentToken().getAux()).kind != KeywordKind::GPR) {
+            return Unexpected{diagnosticAt(DiagnosticCode::ExpectedBaseRegister, here())};
+        }
+        operand.kind = OperandKind::Displacement;
+        operand.base = static_cast<uint8_t>(keywordAt(advance().getAux()).value);
+        if (!match({TokenType::RPAREN})) {
+            return Unexpected{diagnosticAt(DiagnosticCode::ExpectedRightParen, here())};
         }
+        return operand;
     }
 
+    return Unexpected{diagnosticAt(DiagnosticCode::ExpectedOperand, here())};
+}
 
-    PowerPCInstruction parseInstruction() {
-        const Token& instrToken = advance();
-        auto it = instructionSet.find(instrToken.getValue());
-        if (it == instructionSet.end()) {
-            throw std::runtime_error("Unknown instruction: " + instrToken.getValue());
-        }
 
-        PowerPCInstruction instruction = it->second;
+Expected<Operand> PowerPCParser::parseImmediate() {
+    Expected<uint64_t> value = parseInteger(4);
+    if (!value) return Unexpected{value.error()};
+    const bool negative = (previous().getFlags() & Token::NUMBER_NEGATIVE) != 0;
+    return Operand{negative ? OperandKind::SignedImmediate : OperandKind::UnsignedImmediate, 0,
+                   static_cast<int32_t>(static_cast<uint32_t>(*value)), SymbolTable::NONE};
+}
 
 
-        if (instruction.primary_mnemonic == "add") {
-            parseAddOperands(instruction);
+Expected<uint64_t> PowerPCParser::parseInteger(size_t bytes) {
+    if (!check(TokenType::NUMBER)) {
+        return Unexpected{diagnosticAt(DiagnosticCode::ExpectedNumber, here())};
+    }
+    // Most values were converted by the lexer already.
+    const Token& token = advance();
+    NumberValue number{token.getAux(), (token.getFlags() & Token::NUMBER_NEGATIVE) != 0};
+    if ((token.getFlags() & Token::NUMBER_KNOWN) == 0) {
+        const NumberStatus status = number::parse(text(token), number);
+        if (status == NumberStatus::BadDigit) {
+            return Unexpected{diagnosticAt(DiagnosticCode::BadOctalDigit, token)};
         }
-
-
-
-        if (!match({TokenType::EOL})) {
-            throw std::runtime_error("Expected end of line after instruction");
+        if (status == NumberStatus::Overflow) {
+            return Unexpected{diagnosticAt(DiagnosticCode::NumberOutOfRange, token)};
         }
+    }
+    uint64_t value = 0;
+    if (!fitBytes(number, bytes, value)) {
+        return Unexpected{diagnosticAt(DiagnosticCode::NumberOutOfRange, token)};
+    }
+    return value;
+}
+
+
+// Unknown directives (.type, .size, ...) are skipped with a warning.
+Expected<void> PowerPCParser::parseDirective() {
+    const Token directive = advance();
+    const int index = DIRECTIVE_HASH.find(text(directive));
+    if (index < 0) {
+        Diagnostic unknown = diagnosticAt(DiagnosticCode::UnknownDirective, directive);
+        unknown.severity = Severity::Warning;
+        diagnostics.report(unknown);
+        skipLine();
+        return {};
+    }
 
-        return instruction;
+    const DirectiveSpec& spec = DIRECTIVES[index];
+    Expected<void> done{};
+    switch (spec.kind) {
+        case DirectiveKind::Value: done = emitData(spec.size); break;
+        case DirectiveKind::Text: section = SectionId::Text; break;
+        case DirectiveKind::Data: section = SectionId::Data; break;
+        case DirectiveKind::Section: done = switchSection(); break;
+        case DirectiveKind::Global: done = markGlobal(); break;
+        case DirectiveKind::Align: done = align(true); break;
+        case DirectiveKind::P2Align: done = align(true); break;
+        case DirectiveKind::BAlign: done = align(false); break;
+        case DirectiveKind::Space: done = space(); break;
     }
+    if (!done) return done;
 
+    if (!match({TokenType::EOL}) && !isAtEnd()) {
+        return Unexpected{diagnosticAt(DiagnosticCode::ExpectedEndOfLine, here())};
+    }
+    return {};
+}
 
-    void parseAddOperands(PowerPCInstruction& instruction) {
 
+// Subsections such as .text.startup go into their parent. Section flags and
+// type after the name, as in .section .data,"aw", are ignored.
+Expected<void> PowerPCParser::switchSection() {
+    if (!check(TokenType::DIRECTIVE) && !check(TokenType::IDENTIFIER)) {
+        return Unexpected{diagnosticAt(DiagnosticCode::UnknownSection, here())};
+    }
+    const Token& name = advance();
+    auto within = [](std::string_view name, std::string_view base) {
+        return name.substr(0, base.size()) == base && (name.size() == base.size() || name[base.size()] == '.');
+    };
+    if (within(text(name), ".text")) {
+        section = SectionId::Text;
+    } else if (within(text(name), ".data")) {
+        section = SectionId::Data;
+    } else {
+        return Unexpected{diagnosticAt(DiagnosticCode::UnknownSection, name)};
+    }
+    skipLine();
+    return {};
+}
 
 
-        if (!check(TokenType::REGISTER)) {
-            throw std::runtime_error("Expected register as first operand");
+Expected<void> PowerPCParser::markGlobal() {
+    do {
+        if (!check(TokenType::IDENTIFIER) && !check(TokenType::INSTRUCTION)) {
+            return Unexpected{diagnosticAt(DiagnosticCode::ExpectedSymbol, here())};
         }
-        std::string rd = advance().getValue();
-
-
-        if (!match({TokenType::COMMA})) {
-            throw std::runtime_error("Expected comma after first operand");
+        const Token& name = advance();
+        symbols.markGlobal(symbols.reference(text(name), static_cast<uint32_t>(name.getLine())));
+    } while (match({TokenType::COMMA}));
+    return {};
+}
+
+
+// The bulk data path: each value goes from its token straight into the
+// section buffer, without the operand machinery of instructions. Words and
+// doublewords may also name a symbol with an optional addend; they are left
+// zero and recorded for a relocation.
+Expected<void> PowerPCParser::emitData(size_t size) {
+    if (isAtEnd() || check(TokenType::EOL)) return {};
+    do {
+        if (size >= 4 && (check(TokenType::IDENTIFIER) || check(TokenType::INSTRUCTION))) {
+            Expected<Operand> label = parseOperand();
+            if (!label) return Unexpected{label.error()};
+            const uint32_t offset = getAddress();
+            reserve(size);
+            if (sections != nullptr) {
+                sections->addRelocation({section, static_cast<uint8_t>(size), offset, label->symbol, label->value});
+            }
+            continue;
         }
+        Expected<uint64_t> value = parseInteger(size);
+        if (!value) return Unexpected{value.error()};
+        uint8_t* out = reserve(size);
+        if (out != nullptr) sections->store(*value, size, out);
+    } while (match({TokenType::COMMA}));
+    return {};
+}
+
+
+// Pads with nops in .text when the gap is made of whole words, otherwise
+// with zeros, unless a fill byte is given.
+Expected<void> PowerPCParser::align(bool exponent) {
+    const Token at = here();
+    Expected<uint64_t> amount = parseInteger(4);
+    if (!amount) return Unexpected{amount.error()};
+    const uint64_t alignment = !exponent ? *amount : *amount < 32 ? uint64_t(1) << *amount : 0;
+    if (alignment == 0 || alignment > MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+        return Unexpected{diagnosticAt(DiagnosticCode::BadAlignment, at, static_cast<int32_t>(*amount))};
+    }
 
+    int fill = -1;
+    if (match({TokenType::COMMA})) {
+        Expected<uint64_t> byte = parseInteger(1);
+        if (!byte) return Unexpected{byte.error()};
+        fill = static_cast<int>(*byte & 0xff);
+    }
 
-        if (!check(TokenType::REGISTER)) {
-            throw std::runtime_error("Expected register as second operand");
-        }
-        std::string ra = advance().getValue();
+    const uint32_t address = getAddress();
+    const size_t count = (alignment - address % alignment) % alignment;
+    uint8_t* out = reserve(count);
+    if (out == nullptr) return {};
+    if (fill < 0 && section == SectionId::Text && address % 4 == 0) {
+        for (size_t i = 0; i < count; i += 4) sections->store(NOP, 4, out + i);
+    } else if (fill > 0) {
+        std::memset(out, fill, count);
+    }
+    return {};
+}
 
 
-        if (!match({TokenType::COMMA})) {
-            throw std::runtime_error("Expected comma after second operand");
-        }
+Expected<void> PowerPCParser::space() {
+    const Token at = here();
+    Expected<uint64_t> count = parseInteger(4);
+    if (!count) return Unexpected{count.error()};
+    if (*count > MAX_SPACE) {
+        return Unexpected{diagnosticAt(DiagnosticCode::NumberOutOfRange, at)};
+    }
 
+    int fill = 0;
+    if (match({TokenType::COMMA})) {
+        Expected<uint64_t> byte = parseInteger(1);
+        if (!byte) return Unexpected{byte.error()};
+        fill = static_cast<int>(*byte & 0xff);
+    }
 
-        if (!check(TokenType::REGISTER)) {
-            throw std::runtime_error("Expected register as third operand");
-        }
-        std::string rb = advance().getValue();
+    uint8_t* out = reserve(*count);
+    if (out != nullptr && fill != 0) std::memset(out, fill, *count);
+    return {};
+}
+
+
+// Advances the current section by `count` bytes and returns them, zeroed,
+// or nullptr when the parser has no sections to store into.
+uint8_t* PowerPCParser::reserve(size_t count) {
+    addresses[static_cast<size_t>(section)] += static_cast<uint32_t>(count);
+    return sections == nullptr ? nullptr : (*sections)[section].extend(count);
+}
+
+
+// Runs the operand program of the chosen variant over the written operands
+// and returns the label used, or SymbolTable::NONE. Range checks are left to
+// the encoder, except for unsigned immediates of 2^31 and up, which no field
+// can hold and which would read as negative.
+Expected<uint32_t> PowerPCParser::bindOperands(ParsedInstruction& instruction, const syntax::OperandProgram& program,
+                                               const Token& mnemonic, const Token* firstTokens) const {
+    if (operandCount != program.count) {
+        return Unexpected{diagnosticAt(DiagnosticCode::OperandCount, mnemonic, program.count,
+                                       static_cast<int32_t>(operandCount))};
+    }
 
+    uint32_t symbol = SymbolTable::NONE;
+    for (size_t i = 0; i < program.count; i++) {
+        const syntax::OperandSlot& slot = program.slots[i];
+        const Operand& operand = operands[i];
+        if ((slot.accepts & syntax::kindBit(operand.kind)) == 0) {
+            return Unexpected{diagnosticAt(DiagnosticCode::OperandKind, firstTokens[i],
+                                           static_cast<int32_t>(i), static_cast<int32_t>(slot.expected),
+                                           static_cast<int32_t>(operand.kind))};
+        }
+        if (operand.kind == OperandKind::UnsignedImmediate && operand.value < 0) {
+            return Unexpected{diagnosticAt(DiagnosticCode::OperandOutOfRange, firstTokens[i],
+                                           operand.value)};
+        }
 
+        instruction.operands[slot.field] = operand.value;
+        if (slot.second >= 0) {
+            instruction.operands[slot.second] = operand.kind == OperandKind::Displacement ? operand.base
+                                                                                          : operand.value;
+        }
+        if (operand.kind == OperandKind::Label) symbol = operand.symbol;
     }
-};
-
+    return symbol;
+}
@@ -0,0 +1,142 @@
+#ifndef PPCASM_POWERPCPARSER_H
+#define PPCASM_POWERPCPARSER_H
+
+#include <array>
+#include <functional>
+#include <vector>
+#include <string_view>
+#include <initializer_list>
+#include "token.h"
+#include "TokenSource.h"
+#include "PowerPCInstruction.h"
+#include "PowerPCInstructionTable.h"
+#include "PowerPCKeywords.h"
+#include "PowerPCOperand.h"
+#include "PowerPCSyntax.h"
+#include "SymbolTable.h"
+#include "Diagnostics.h"
+#include "InstructionRecord.h"
+#include "Sections.h"
+
+
+// Labels are defined in `symbols` at the current address of the current
+// section as they are met, so a caller pulling instructions with next()
+// sees every backward reference already resolved. Tokens are pulled from
+// `tokens` one at a time into a small ring, so a parser fed by a StreamLexer holds one
+// line of input at most. Each instruction comes out encoded, as a 16-byte
+// InstructionRecord. Malformed lines are reported to `diagnostics` and
+// skipped; nothing is thrown.
+//
+// Directives are carried out as they are met: .text/.data/.section switch
+// sections, .global marks symbols, .align/.p2align/.balign and .space pad,
+// and .byte/.short/.long/.quad store their values straight into `sections`
+// in the target byte order; a .long or .quad naming a symbol stores zero
+// and adds a DataRelocation. Without `sections` the bytes are only counted,
+// which keeps the addresses of labels right. Instructions belong in .text
+// (including data placed there); the caller stores their words.
+class PowerPCParser {
+public:
+    using Sink = std::function<void(const InstructionRecord&)>;
+
+    PowerPCParser(TokenSource& tokens, SymbolTable& symbols, DiagnosticBuffer& diagnostics,
+                  Sections* sections = nullptr);
+
+    PowerPCParser(const PowerPCParser&) = delete;
+    PowerPCParser& operator=(const PowerPCParser&) = delete;
+
+    std::vector<InstructionRecord> parse();
+    // Hands each instruction to `sink` as soon as it is parsed.
+    void parse(const Sink& sink);
+    // Parses up to the next instruction. Returns false at the end of input.
+    bool next(InstructionRecord& record);
+
+    // Operands as written of the instruction last returned by next(), until
+    // the next call.
+    const Operand* getOperands() const { return operands.data(); }
+    size_t getOperandCount() const { return operandCount; }
+
+    // Offset of the next byte in the current section.
+    uint32_t getAddress() const { return addresses[static_cast<size_t>(section)]; }
+    SectionId getSection() const { return section; }
+    size_t getErrorCount() const { return errorCount; }
+
+private:
+    // Room for the current token and the one before it, with slack so that
+    // a token handed out by advance() stays valid while the next is read.
+    static constexpr size_t LOOKAHEAD = 4;
+
+    TokenSource& tokens;
+    SymbolTable& symbols;
+    DiagnosticBuffer& diagnostics;
+    Sections* sections;
+    std::array<Token, LOOKAHEAD> ring;
+    size_t consumed;
+    size_t pulled;
+    bool exhausted;
+    std::array<Operand, syntax::MAX_OPERANDS> operands;
+    size_t operandCount;
+    SectionId section;
+    std::array<uint32_t, SECTION_COUNT> addresses;
+    size_t errorCount;
+
+    // Reads the current token into the ring if it is not there yet. Tokens
+    // are only pulled on demand, so the source is never asked for the next
+    // line before the parser has finished with the current one.
+    bool fill() {
+        if (pulled > consumed) return true;
+        if (exhausted || !tokens.next(ring[pulled % LOOKAHEAD])) {
+            exhausted = true;
+            return false;
+        }
+        pulled++;
+        return true;
+    }
+
+    bool isAtEnd() { return !fill(); }
+    const Token& currentToken() { fill(); return ring[consumed % LOOKAHEAD]; }
+    const Token& previous() const { return ring[(consumed - 1) % LOOKAHEAD]; }
+    const Token& advance() { fill(); return ring[consumed++ % LOOKAHEAD]; }
+    std::string_view text(const Token& token) const { return tokens.text(token); }
+
+    bool check(TokenType type) {
+        if (isAtEnd()) return false;
+        return currentToken().getType() == type;
+    }
+
+    bool match(std::initializer_list<TokenType> types) {
+        for (const auto& type : types) {
+            if (check(type)) {
+                advance();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void report(const Diagnostic& diagnostic);
+    void synchronize();
+    void skipLine();
+    void defineLabel(const Token& label);
+    const Token& here();
+
+    static constexpr size_t NO_VARIANT = SIZE_MAX;
+    Expected<void> parseInstruction(InstructionRecord& record);
+    size_t selectVariant(InstructionId id, const Keyword& keyword, size_t operandCount) const;
+    Expected<size_t> parseOperandList(Operand* list, Token* firstTokens, size_t capacity);
+    Expected<Operand> parseOperand();
+    Expected<Operand> parseImmediate();
+    Expected<uint64_t> parseInteger(size_t bytes);
+
+    Expected<void> parseDirective();
+    Expected<void> switchSection();
+    Expected<void> markGlobal();
+    Expected<void> emitData(size_t size);
+    Expected<void> align(bool exponent);
+    Expected<void> space();
+    uint8_t* reserve(size_t count);
+    Expected<uint32_t> bindOperands(ParsedInstruction& instruction, const syntax::OperandProgram& program,
+                                    const Token& mnemonic, const Token* firstTokens) const;
+};
+
+
+#endif //PPCASM_POWERPCPARSER_H
@@ -0,0 +1,683 @@
+#include "PowerPCSimulator.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include "PowerPCDecoder.h"
+#include "PowerPCInstructionTable.h"
+#include "SimulatorSemantics.h"
+
+using namespace sim;
+
+static constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+
+namespace {
+
+// Bytes fill registers from the most significant end, starting over at r0
+// after r31; a register that gets any byte is cleared first.
+void loadString(CpuState& cpu, const uint8_t* memory, uint32_t address, unsigned reg, unsigned count) {
+    for (unsigned i = 0; i < count; i++) {
+        const unsigned slot = i & 3;
+        if (slot == 0) cpu.gpr[reg] = 0;
+        cpu.gpr[reg] |= uint32_t(memory[address + i]) << (24 - 8 * slot);
+        if (slot == 3) reg = (reg + 1) & 31;
+    }
+}
+
+void storeString(const CpuState& cpu, uint8_t* memory, uint32_t address, unsigned reg, unsigned count) {
+    for (unsigned i = 0; i < count; i++) {
+        const unsigned slot = i & 3;
+        memory[address + i] = static_cast<uint8_t>(cpu.gpr[reg] >> (24 - 8 * slot));
+        if (slot == 3) reg = (reg + 1) & 31;
+    }
+}
+
+}
+
+
+const char* stopReasonName(StopReason reason) {
+    switch (reason) {
+        case StopReason::Returned: return "returned";
+        case StopReason::Limit: return "instruction limit";
+        case StopReason::SystemCall: return "system call";
+        case StopReason::Trap: return "trap";
+        case StopReason::IllegalInstruction: return "illegal instruction";
+        case StopReason::Unimplemented: return "unimplemented instruction";
+        case StopReason::MemoryFault: return "memory fault";
+    }
+    return "unknown";
+}
+
+
+PowerPCSimulator::PowerPCSimulator(size_t memorySize, Endian endian)
+        : endian(endian), swap((endian == Endian::Big) != HOST_BIG_ENDIAN) {
+    if (memorySize > MAX_MEMORY) throw std::length_error("simulated memory too large");
+    const size_t rounded = (memorySize + PAGE_SIZE - 1) & ~size_t(PAGE_SIZE - 1);
+    bytes.resize(rounded);
+    pages.resize(rounded >> PAGE_SHIFT);
+}
+
+
+PowerPCSimulator::~PowerPCSimulator() = default;
+
+
+void PowerPCSimulator::load(uint32_t address, const void* data, size_t count) {
+    if (count == 0) return;
+    if (!inside(address, count)) throw std::out_of_range("load outside simulated memory");
+    std::memcpy(bytes.data() + address, data, count);
+    invalidate(address, count);
+}
+
+
+uint64_t PowerPCSimulator::read(uint32_t address, size_t size) const {
+    if (!inside(address, size)) throw std::out_of_range("read outside simulated memory");
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = value << 8 | bytes[address + (endian == Endian::Big ? i : size - 1 - i)];
+    }
+    return value;
+}
+
+
+void PowerPCSimulator::write(uint32_t address, uint64_t value, size_t size) {
+    if (!inside(address, size)) throw std::out_of_range("write outside simulated memory");
+    for (size_t i = 0; i < size; i++) {
+        bytes[address + (endian == Endian::Big ? size - 1 - i : i)] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    invalidate(address, size);
+}
+
+
+// Only the words written over go back to Decode, so data sharing a page
+// with code costs a flag store rather than re-decoding the page, and the
+// record being executed stays where it is. Blocks are dropped whole.
+void PowerPCSimulator::invalidate(uint32_t address, size_t count) {
+    if (count == 0 || address >= bytes.size()) return;
+    const uint64_t end = std::min<uint64_t>(uint64_t(address) + count, bytes.size());
+    uint64_t word = address & ~uint32_t(3);
+    while (word < end) {
+        const uint64_t pageEnd = (word | (PAGE_SIZE - 1)) + 1;
+        const uint64_t stop = std::min(end, pageEnd);
+        if (CodePage* code = pages[word >> PAGE_SHIFT].get()) {
+            if (!code->owned.empty()) {
+                dropBlocks(*code, static_cast<uint32_t>(word), static_cast<uint32_t>(stop));
+            }
+            for (; word < stop; word += 4) {
+                code->ops[(word & (PAGE_SIZE - 1)) >> 2].handler = handlers[static_cast<size_t>(Op::Decode)];
+            }
+        }
+        word = pageEnd;
+    }
+}
+
+
+PowerPCSimulator::CodePage* PowerPCSimulator::page(uint32_t address) {
+    auto& slot = pages[address >> PAGE_SHIFT];
+    if (!slot) {
+        slot = std::make_unique<CodePage>();
+        reset(*slot);
+    }
+    return slot.get();
+}
+
+
+void PowerPCSimulator::reset(CodePage& code) {
+    for (auto& op : code.ops) {
+        op = DecodedOp{handlers[static_cast<size_t>(Op::Decode)], 0, 0, 0, 0, 0};
+    }
+    code.ops.back().handler = handlers[static_cast<size_t>(Op::NextPage)];
+}
+
+
+// Runs once per word. Register fields are taken straight from their bit
+// positions; immediates, branch displacements and the special fields come
+// from the decoder's operand values.
+void PowerPCSimulator::translate(uint32_t address, DecodedOp& op) const {
+    const uint32_t word = loadAs<uint32_t>(bytes.data() + address, swap);
+    op = DecodedOp{nullptr, 0, static_cast<uint8_t>(word >> 21 & 31), static_cast<uint8_t>(word >> 16 & 31),
+                   static_cast<uint8_t>(word >> 11 & 31), 0};
+
+    ParsedInstruction parsed{};
+    Op kind = Op::Illegal;
+    if (PowerPCDecoder::decode(word, parsed)) {
+        const PowerPCInstruction& instr = *parsed.instruction;
+        const PowerPCInstruction::SyntaxVariant& variant = *parsed.variant;
+        const Semantics semantics = SEMANTICS[parsed.instruction - isa::TABLE];
+        auto operand = [&](std::string_view name) {
+            const int index = instr.encoding.fieldIndex(name);
+            return index < 0 ? 0 : parsed.operands[index];
+        };
+
+        kind = semantics.op;
+        op.flags = static_cast<uint8_t>((variant.rc ? FLAG_RC : 0) | (variant.oe ? FLAG_OE : 0) |
+                                        (instr.effects.xer_ca ? FLAG_CA : 0) | (variant.lk ? FLAG_LK : 0));
+
+        switch (instr.form) {
+            case InstructionForm::D:
+                // Exactly one of these is present.
+                op.imm = static_cast<int32_t>(static_cast<uint32_t>(
+                        operand("SIMM") | operand("UIMM") | operand("d")) << semantics.detail);
+                if (instr.encoding.fieldIndex("crfD") >= 0) op.d = static_cast<uint8_t>(operand("crfD"));
+                break;
+            case InstructionForm::I:
+                op.imm = static_cast<int32_t>((variant.aa ? 0 : address) + operand("LI"));
+                break;
+            case InstructionForm::B:
+                op.imm = static_cast<int32_t>((variant.aa ? 0 : address) + operand("BD"));
+                break;
+            case InstructionForm::M:
+                op.imm = static_cast<int32_t>(rotateMask(operand("MB"), operand("ME")));
+                break;
+            default:
+                break;
+        }
+
+        switch (kind) {
+            case Op::Compare:
+            case Op::CompareLogical:
+            case Op::MoveConditionFromXer:
+                op.d = static_cast<uint8_t>(operand("crfD"));
+                break;
+            case Op::MoveConditionField:
+                op.d = static_cast<uint8_t>(operand("crfD"));
+                op.a = static_cast<uint8_t>(operand("crfS"));
+                break;
+            case Op::ConditionLogical:
+                op.imm = semantics.detail;
+                break;
+            case Op::MoveToConditionFields: {
+                const auto crm = static_cast<uint32_t>(operand("CRM"));
+                uint32_t mask = 0;
+                for (unsigned field = 0; field < 8; field++) {
+                    if ((crm >> (7 - field) & 1) != 0) mask |= 0xfu << (28 - 4 * field);
+                }
+                op.imm = static_cast<int32_t>(mask);
+                break;
+            }
+            case Op::MoveFromXer:
+            case Op::MoveToXer: {
+                const bool from = kind == Op::MoveFromXer;
+                switch (operand("SPR")) {
+                    case 1: kind = from ? Op::MoveFromXer : Op::MoveToXer; break;
+                    case 8: kind = from ? Op::MoveFromLink : Op::MoveToLink; break;
+                    case 9: kind = from ? Op::MoveFromCount : Op::MoveToCount; break;
+                    default: kind = Op::Illegal; break;
+                }
+                break;
+            }
+            case Op::MoveFromTimeBase:
+                switch (operand("TBR")) {
+                    case 268: break;
+                    case 269: kind = Op::MoveFromTimeBaseUpper; break;
+                    default: kind = Op::Illegal; break;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    op.handler = handlers[static_cast<size_t>(kind)];
+}
+
+
+StopReason PowerPCSimulator::call(uint32_t entry, uint64_t limit) {
+    cpu.pc = entry;
+    cpu.lr = RETURN_ADDRESS;
+    return run(limit);
+}
+
+
+// Direct-threaded: every record holds the address of its handler, and each
+// handler ends by jumping to the next record's. Sequential code walks the
+// records of a page; the extra record at the end of each page moves on to
+// the next one. Branch targets were made absolute when the branch was
+// decoded.
+StopReason PowerPCSimulator::run(uint64_t limit) {
+#define SIMULATOR_OP_LABEL(name) &&name,
+    static const void* const HANDLERS[] = {SIMULATOR_OPS(SIMULATOR_OP_LABEL)};
+#undef SIMULATOR_OP_LABEL
+    handlers = HANDLERS;
+    if (limit == 0) return StopReason::Limit;
+
+    auto& gpr = cpu.gpr;
+    uint8_t* const memory = bytes.data();
+    uint64_t remaining = limit;
+    uint32_t next = cpu.pc;
+    uint32_t pageBase = 0;
+    DecodedOp* ops = nullptr;
+    DecodedOp* op = nullptr;
+    StopReason reason = StopReason::Limit;
+
+#define CIA (pageBase + static_cast<uint32_t>(op - ops) * 4)
+#define NEXT() \
+    do { \
+        op++; \
+        if (--remaining == 0) { \
+            cpu.pc = CIA; \
+            goto stop; \
+        } \
+        goto *op->handler; \
+    } while (0)
+#define JUMP(target) \
+    do { \
+        next = (target); \
+        remaining--; \
+        goto enter; \
+    } while (0)
+#define HALT(why, at) \
+    do { \
+        cpu.pc = (at); \
+        reason = (why); \
+        goto stop; \
+    } while (0)
+#define CHECK(address, size) \
+    do { \
+        if (!inside((address), (size))) { \
+            fault = (address); \
+            HALT(StopReason::MemoryFault, CIA); \
+        } \
+    } while (0)
+#define RA_OR_ZERO (op->a == 0 ? 0 : gpr[op->a])
+
+enter:
+    if (next == RETURN_ADDRESS) HALT(StopReason::Returned, next);
+    if (remaining == 0) HALT(StopReason::Limit, next);
+    if ((next & 3) != 0 || !inside(next, 4)) {
+        fault = next;
+        HALT(StopReason::MemoryFault, next);
+    }
+    {
+        CodePage* code = page(next);
+        const size_t index = (next & (PAGE_SIZE - 1)) >> 2;
+        pageBase = next & ~(PAGE_SIZE - 1);
+        ops = code->ops.data();
+        op = ops + index;
+        if (blockCache) {
+            Block* block = code->blocks[index];
+            if (block == nullptr && ++code->heat[index] == HOT_THRESHOLD) block = buildBlock(next, *code);
+            if (block != nullptr && block->length <= remaining) {
+                if (!runBlocks(block, remaining, next)) {
+                    reason = StopReason::MemoryFault;
+                    goto stop;
+                }
+                goto enter;
+            }
+        }
+    }
+    goto *op->handler;
+
+Decode:
+    translate(CIA, *op);
+    goto *op->handler;
+NextPage:
+    next = pageBase + PAGE_SIZE;
+    goto enter;
+Illegal:
+    HALT(StopReason::IllegalInstruction, CIA);
+Unimplemented:
+    HALT(StopReason::Unimplemented, CIA);
+
+#define ARITHMETIC(name, expression) \
+    name: { \
+        const Sum sum = (expression); \
+        gpr[op->d] = sum.value; \
+        if (op->flags != 0) recordFlags(cpu, op->flags, sum.value, sum.carry, sum.overflow); \
+        NEXT(); \
+    }
+    ARITHMETIC(Add, addWithCarry(gpr[op->a], gpr[op->b], 0))
+    ARITHMETIC(AddExtended, addWithCarry(gpr[op->a], gpr[op->b], carryIn(cpu)))
+    ARITHMETIC(AddImmediateCarrying, addWithCarry(gpr[op->a], static_cast<uint32_t>(op->imm), 0))
+    ARITHMETIC(AddMinusOne, addWithCarry(gpr[op->a], 0xffffffff, carryIn(cpu)))
+    ARITHMETIC(AddZero, addWithCarry(gpr[op->a], 0, carryIn(cpu)))
+    ARITHMETIC(SubtractFrom, addWithCarry(~gpr[op->a], gpr[op->b], 1))
+    ARITHMETIC(SubtractFromExtended, addWithCarry(~gpr[op->a], gpr[op->b], carryIn(cpu)))
+    ARITHMETIC(SubtractFromImmediate, addWithCarry(~gpr[op->a], static_cast<uint32_t>(op->imm), 1))
+    ARITHMETIC(SubtractFromMinusOne, addWithCarry(~gpr[op->a], 0xffffffff, carryIn(cpu)))
+    ARITHMETIC(SubtractFromZero, addWithCarry(~gpr[op->a], 0, carryIn(cpu)))
+    ARITHMETIC(Negate, (Sum{0u - gpr[op->a], false, gpr[op->a] == 0x80000000}))
+#undef ARITHMETIC
+
+AddImmediate:
+    gpr[op->d] = RA_OR_ZERO + static_cast<uint32_t>(op->imm);
+    NEXT();
+MultiplyLow: {
+    const int64_t product = int64_t(static_cast<int32_t>(gpr[op->a])) * static_cast<int32_t>(gpr[op->b]);
+    const auto value = static_cast<uint32_t>(product);
+    gpr[op->d] = value;
+    if (op->flags != 0) recordFlags(cpu, op->flags, value, false, product != static_cast<int32_t>(value));
+    NEXT();
+}
+MultiplyLowImmediate:
+    gpr[op->d] = static_cast<uint32_t>(int64_t(static_cast<int32_t>(gpr[op->a])) * op->imm);
+    NEXT();
+MultiplyHigh: {
+    const int64_t product = int64_t(static_cast<int32_t>(gpr[op->a])) * static_cast<int32_t>(gpr[op->b]);
+    gpr[op->d] = static_cast<uint32_t>(static_cast<uint64_t>(product) >> 32);
+    if (op->flags != 0) recordFlags(cpu, op->flags, gpr[op->d], false, false);
+    NEXT();
+}
+MultiplyHighUnsigned:
+    gpr[op->d] = static_cast<uint32_t>(uint64_t(gpr[op->a]) * gpr[op->b] >> 32);
+    if (op->flags != 0) recordFlags(cpu, op->flags, gpr[op->d], false, false);
+    NEXT();
+// The quotient of an invalid division is undefined; we give zero.
+Divide: {
+    const auto dividend = static_cast<int32_t>(gpr[op->a]);
+    const auto divisor = static_cast<int32_t>(gpr[op->b]);
+    const bool overflow = divisor == 0 || (dividend == INT32_MIN && divisor == -1);
+    gpr[op->d] = overflow ? 0 : static_cast<uint32_t>(dividend / divisor);
+    if (op->flags != 0) recordFlags(cpu, op->flags, gpr[op->d], false, overflow);
+    NEXT();
+}
+DivideUnsigned: {
+    const bool overflow = gpr[op->b] == 0;
+    gpr[op->d] = overflow ? 0 : gpr[op->a] / gpr[op->b];
+    if (op->flags != 0) recordFlags(cpu, op->flags, gpr[op->d], false, overflow);
+    NEXT();
+}
+
+Compare:
+    setConditionField(cpu, op->d, compareBits(static_cast<int32_t>(gpr[op->a]), static_cast<int32_t>(gpr[op->b])) |
+                                  summaryOverflow(cpu));
+    NEXT();
+CompareImmediate:
+    setConditionField(cpu, op->d, compareBits(static_cast<int32_t>(gpr[op->a]), op->imm) | summaryOverflow(cpu));
+    NEXT();
+CompareLogical:
+    setConditionField(cpu, op->d, compareBits(gpr[op->a], gpr[op->b]) | summaryOverflow(cpu));
+    NEXT();
+CompareLogicalImmediate:
+    setConditionField(cpu, op->d, compareBits(gpr[op->a], static_cast<uint32_t>(op->imm)) | summaryOverflow(cpu));
+    NEXT();
+
+// rA ← f(rS, rB), recording CR0 when Rc is set.
+#define LOGICAL(name, expression) \
+    name: \
+        gpr[op->a] = (expression); \
+        if (op->flags != 0) recordResult(cpu, gpr[op->a]); \
+        NEXT();
+    LOGICAL(And, gpr[op->d] & gpr[op->b])
+    LOGICAL(AndComplement, gpr[op->d] & ~gpr[op->b])
+    LOGICAL(AndImmediate, gpr[op->d] & static_cast<uint32_t>(op->imm))
+    LOGICAL(CountLeadingZeros, gpr[op->d] == 0 ? 32 : static_cast<uint32_t>(__builtin_clz(gpr[op->d])))
+    LOGICAL(Equivalent, ~(gpr[op->d] ^ gpr[op->b]))
+    LOGICAL(ExtendSignByte, static_cast<uint32_t>(static_cast<int8_t>(gpr[op->d])))
+    LOGICAL(ExtendSignHalf, static_cast<uint32_t>(static_cast<int16_t>(gpr[op->d])))
+    LOGICAL(Nand, ~(gpr[op->d] & gpr[op->b]))
+    LOGICAL(Nor, ~(gpr[op->d] | gpr[op->b]))
+    LOGICAL(Or, gpr[op->d] | gpr[op->b])
+    LOGICAL(OrComplement, gpr[op->d] | ~gpr[op->b])
+    LOGICAL(OrImmediate, gpr[op->d] | static_cast<uint32_t>(op->imm))
+    LOGICAL(Xor, gpr[op->d] ^ gpr[op->b])
+    LOGICAL(XorImmediate, gpr[op->d] ^ static_cast<uint32_t>(op->imm))
+    LOGICAL(RotateInsert, (rotateLeft(gpr[op->d], op->b) & static_cast<uint32_t>(op->imm)) |
+                          (gpr[op->a] & ~static_cast<uint32_t>(op->imm)))
+    LOGICAL(RotateAndMask, rotateLeft(gpr[op->d], op->b) & static_cast<uint32_t>(op->imm))
+    LOGICAL(RotateRegisterAndMask, rotateLeft(gpr[op->d], gpr[op->b]) & static_cast<uint32_t>(op->imm))
+    LOGICAL(ShiftLeft, (gpr[op->b] & 32) != 0 ? 0 : gpr[op->d] << (gpr[op->b] & 31))
+    LOGICAL(ShiftRight, (gpr[op->b] & 32) != 0 ? 0 : gpr[op->d] >> (gpr[op->b] & 31))
+#undef LOGICAL
+
+ShiftRightAlgebraic:
+    gpr[op->a] = shiftRightAlgebraic(cpu, gpr[op->d], gpr[op->b] & 63);
+    if ((op->flags & FLAG_RC) != 0) recordResult(cpu, gpr[op->a]);
+    NEXT();
+ShiftRightAlgebraicImmediate:
+    gpr[op->a] = shiftRightAlgebraic(cpu, gpr[op->d], op->b);
+    if ((op->flags & FLAG_RC) != 0) recordResult(cpu, gpr[op->a]);
+    NEXT();
+
+// Addressing: d(rA|0), d(rA) with update, (rA|0)+rB and rA+rB with update.
+#define EA_D (RA_OR_ZERO + static_cast<uint32_t>(op->imm))
+#define EA_DU (gpr[op->a] + static_cast<uint32_t>(op->imm))
+#define EA_X (RA_OR_ZERO + gpr[op->b])
+#define EA_XU (gpr[op->a] + gpr[op->b])
+#define LOAD(name, address, type, extend, update) \
+    name: { \
+        const uint32_t ea = (address); \
+        CHECK(ea, sizeof(type)); \
+        gpr[op->d] = static_cast<uint32_t>(static_cast<extend>(loadAs<type>(memory + ea, swap))); \
+        if (update) gpr[op->a] = ea; \
+        NEXT(); \
+    }
+#define STORE(name, address, type, update) \
+    name: { \
+        const uint32_t ea = (address); \
+        CHECK(ea, sizeof(type)); \
+        storeAs<type>(memory + ea, static_cast<type>(gpr[op->d]), swap); \
+        stored(ea, sizeof(type)); \
+        if (update) gpr[op->a] = ea; \
+        NEXT(); \
+    }
+#define LOADS(name, type, extend) \
+    LOAD(name, EA_D, type, extend, false) \
+    LOAD(name##Update, EA_DU, type, extend, true) \
+    LOAD(name##Indexed, EA_X, type, extend, false) \
+    LOAD(name##UpdateIndexed, EA_XU, type, extend, true)
+#define STORES(name, type) \
+    STORE(name, EA_D, type, false) \
+    STORE(name##Update, EA_DU, type, true) \
+    STORE(name##Indexed, EA_X, type, false) \
+    STORE(name##UpdateIndexed, EA_XU, type, true)
+    LOADS(LoadByte, uint8_t, uint8_t)
+    LOADS(LoadHalf, uint16_t, uint16_t)
+    LOADS(LoadHalfAlgebraic, uint16_t, int16_t)
+    LOADS(LoadWord, uint32_t, uint32_t)
+    STORES(StoreByte, uint8_t)
+    STORES(StoreHalf, uint16_t)
+    STORES(StoreWord, uint32_t)
+#undef LOADS
+#undef STORES
+#undef LOAD
+#undef STORE
+
+LoadHalfReversed: {
+    const uint32_t ea = EA_X;
+    CHECK(ea, 2);
+    gpr[op->d] = loadAs<uint16_t>(memory + ea, !swap);
+    NEXT();
+}
+LoadWordReversed: {
+    const uint32_t ea = EA_X;
+    CHECK(ea, 4);
+    gpr[op->d] = loadAs<uint32_t>(memory + ea, !swap);
+    NEXT();
+}
+StoreHalfReversed: {
+    const uint32_t ea = EA_X;
+    CHECK(ea, 2);
+    storeAs<uint16_t>(memory + ea, static_cast<uint16_t>(gpr[op->d]), !swap);
+    stored(ea, 2);
+    NEXT();
+}
+StoreWordReversed: {
+    const uint32_t ea = EA_X;
+    CHECK(ea, 4);
+    storeAs<uint32_t>(memory + ea, gpr[op->d], !swap);
+    stored(ea, 4);
+    NEXT();
+}
+LoadReserve: {
+    const uint32_t ea = EA_X;
+    CHECK(ea, 4);
+    gpr[op->d] = loadAs<uint32_t>(memory + ea, swap);
+    cpu.reserved = true;
+    cpu.reservation = ea;
+    NEXT();
+}
+StoreConditional: {
+    const uint32_t ea = EA_X;
+    CHECK(ea, 4);
+    const bool success = cpu.reserved && cpu.reservation == ea;
+    if (success) {
+        storeAs<uint32_t>(memory + ea, gpr[op->d], swap);
+        stored(ea, 4);
+    }
+    cpu.reserved = false;
+    setConditionField(cpu, 0, (success ? crbit::EQ : 0) | summaryOverflow(cpu));
+    NEXT();
+}
+LoadMultiple: {
+    uint32_t ea = EA_D;
+    CHECK(ea, 4 * (32 - op->d));
+    for (unsigned reg = op->d; reg < 32; reg++, ea += 4) gpr[reg] = loadAs<uint32_t>(memory + ea, swap);
+    NEXT();
+}
+StoreMultiple: {
+    const uint32_t first = EA_D;
+    CHECK(first, 4 * (32 - op->d));
+    uint32_t ea = first;
+    for (unsigned reg = op->d; reg < 32; reg++, ea += 4) storeAs<uint32_t>(memory + ea, gpr[reg], swap);
+    stored(first, 4 * (32 - op->d));
+    NEXT();
+}
+LoadStringImmediate: {
+    const uint32_t ea = RA_OR_ZERO;
+    const unsigned count = op->b == 0 ? 32 : op->b;
+    CHECK(ea, count);
+    loadString(cpu, memory, ea, op->d, count);
+    NEXT();
+}
+LoadStringIndexed: {
+    const uint32_t ea = EA_X;
+    const unsigned count = cpu.xer & xer::BYTE_COUNT;
+    if (count != 0) CHECK(ea, count);
+    loadString(cpu, memory, ea, op->d, count);
+    NEXT();
+}
+StoreStringImmediate: {
+    const uint32_t ea = RA_OR_ZERO;
+    const unsigned count = op->b == 0 ? 32 : op->b;
+    CHECK(ea, count);
+    storeString(cpu, memory, ea, op->d, count);
+    stored(ea, count);
+    NEXT();
+}
+StoreStringIndexed: {
+    const uint32_t ea = EA_X;
+    const unsigned count = cpu.xer & xer::BYTE_COUNT;
+    if (count != 0) {
+        CHECK(ea, count);
+        storeString(cpu, memory, ea, op->d, count);
+        stored(ea, count);
+    }
+    NEXT();
+}
+
+Branch:
+    if ((op->flags & FLAG_LK) != 0) cpu.lr = CIA + 4;
+    JUMP(static_cast<uint32_t>(op->imm));
+// BO: 16 ignore the condition, 8 the value it must have, 4 leave CTR
+// alone, 2 branch on CTR = 0 instead of CTR ≠ 0.
+BranchConditional: {
+    const unsigned bo = op->d;
+    if ((bo & 4) == 0) cpu.ctr--;
+    const bool counted = (bo & 4) != 0 || ((cpu.ctr != 0) != ((bo & 2) != 0));
+    const bool condition = (bo & 16) != 0 || ((cpu.cr >> (31 - op->a) & 1) == (bo >> 3 & 1));
+    if ((op->flags & FLAG_LK) != 0) cpu.lr = CIA + 4;
+    if (counted && condition) JUMP(static_cast<uint32_t>(op->imm));
+    NEXT();
+}
+BranchConditionalToLink: {
+    const unsigned bo = op->d;
+    const uint32_t target = cpu.lr & ~3u;
+    if ((bo & 4) == 0) cpu.ctr--;
+    const bool counted = (bo & 4) != 0 || ((cpu.ctr != 0) != ((bo & 2) != 0));
+    const bool condition = (bo & 16) != 0 || ((cpu.cr >> (31 - op->a) & 1) == (bo >> 3 & 1));
+    if ((op->flags & FLAG_LK) != 0) cpu.lr = CIA + 4;
+    if (counted && condition) JUMP(target);
+    NEXT();
+}
+BranchConditionalToCount: {
+    const unsigned bo = op->d;
+    const bool condition = (bo & 16) != 0 || ((cpu.cr >> (31 - op->a) & 1) == (bo >> 3 & 1));
+    if ((op->flags & FLAG_LK) != 0) cpu.lr = CIA + 4;
+    if (condition) JUMP(cpu.ctr & ~3u);
+    NEXT();
+}
+SystemCall:
+    remaining--;
+    HALT(StopReason::SystemCall, CIA + 4);
+
+ConditionLogical: {
+    const unsigned index = (cpu.cr >> (31 - op->a) & 1) << 1 | (cpu.cr >> (31 - op->b) & 1);
+    const uint32_t bit = 1u << (31 - op->d);
+    cpu.cr = (static_cast<uint32_t>(op->imm) >> index & 1) != 0 ? cpu.cr | bit : cpu.cr & ~bit;
+    NEXT();
+}
+MoveConditionField:
+    setConditionField(cpu, op->d, crField(cpu.cr, op->a));
+    NEXT();
+Trap:
+    if (trapMatches(op->d, gpr[op->a], gpr[op->b])) HALT(StopReason::Trap, CIA);
+    NEXT();
+TrapImmediate:
+    if (trapMatches(op->d, gpr[op->a], static_cast<uint32_t>(op->imm))) HALT(StopReason::Trap, CIA);
+    NEXT();
+MoveConditionFromXer:
+    setConditionField(cpu, op->d, cpu.xer >> 28);
+    cpu.xer &= 0x0fffffff;
+    NEXT();
+MoveFromCondition:
+    gpr[op->d] = cpu.cr;
+    NEXT();
+MoveToConditionFields:
+    cpu.cr = (gpr[op->d] & static_cast<uint32_t>(op->imm)) | (cpu.cr & ~static_cast<uint32_t>(op->imm));
+    NEXT();
+MoveFromXer:
+    gpr[op->d] = cpu.xer;
+    NEXT();
+MoveFromLink:
+    gpr[op->d] = cpu.lr;
+    NEXT();
+MoveFromCount:
+    gpr[op->d] = cpu.ctr;
+    NEXT();
+MoveToXer:
+    cpu.xer = gpr[op->d];
+    NEXT();
+MoveToLink:
+    cpu.lr = gpr[op->d];
+    NEXT();
+MoveToCount:
+    cpu.ctr = gpr[op->d];
+    NEXT();
+// The time base counts retired instructions.
+MoveFromTimeBase:
+    gpr[op->d] = static_cast<uint32_t>(retired + (limit - remaining));
+    NEXT();
+MoveFromTimeBaseUpper:
+    gpr[op->d] = static_cast<uint32_t>((retired + (limit - remaining)) >> 32);
+    NEXT();
+Nop:
+    NEXT();
+ZeroBlock: {
+    const uint32_t ea = EA_X & ~(CACHE_BLOCK - 1);
+    CHECK(ea, CACHE_BLOCK);
+    std::memset(memory + ea, 0, CACHE_BLOCK);
+    stored(ea, CACHE_BLOCK);
+    NEXT();
+}
+InvalidateBlock: {
+    const uint32_t ea = EA_X & ~(CACHE_BLOCK - 1);
+    if (inside(ea, CACHE_BLOCK)) invalidate(ea, CACHE_BLOCK);
+    NEXT();
+}
+
+stop:
+    retired += limit - remaining;
+    graveyard.clear();
+    return reason;
+
+#undef CIA
+#undef NEXT
+#undef JUMP
+#undef HALT
+#undef CHECK
+#undef RA_OR_ZERO
+#undef EA_D
+#undef EA_DU
+#undef EA_X
+#undef EA_XU
+}
@@ -0,0 +1,221 @@
+#ifndef PPCASM_POWERPCSIMULATOR_H
+#define PPCASM_POWERPCSIMULATOR_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "PowerPCEncoder.h"
+
+
+// User-mode register file. CR, XER and the branch registers are kept in
+// their architected layout, so mfcr/mfxer see what the hardware would.
+struct CpuState {
+    std::array<uint32_t, 32> gpr{};
+    uint32_t cr = 0;
+    uint32_t xer = 0;
+    uint32_t lr = 0;
+    uint32_t ctr = 0;
+    uint32_t pc = 0;
+    // Reservation taken by lwarx, checked by stwcx.
+    bool reserved = false;
+    uint32_t reservation = 0;
+};
+
+namespace xer {
+inline constexpr uint32_t SO = 0x80000000;
+inline constexpr uint32_t OV = 0x40000000;
+inline constexpr uint32_t CA = 0x20000000;
+inline constexpr uint32_t BYTE_COUNT = 0x7f;
+}
+
+// Bits of one 4-bit CR field.
+namespace crbit {
+inline constexpr uint32_t LT = 8;
+inline constexpr uint32_t GT = 4;
+inline constexpr uint32_t EQ = 2;
+inline constexpr uint32_t SO = 1;
+}
+
+inline uint32_t crField(uint32_t cr, unsigned field) {
+    return cr >> (28 - 4 * field) & 0xf;
+}
+
+
+enum class StopReason : uint8_t {
+    Returned,           // branched to RETURN_ADDRESS
+    Limit,              // the instruction budget ran out
+    SystemCall,         // pc is past the sc
+    Trap,               // pc is at the trapping instruction
+    IllegalInstruction, // not a valid word, or an SPR we do not model
+    Unimplemented,      // valid, but not simulated (floating point)
+    MemoryFault         // faultAddress() is the bad access or fetch
+};
+
+const char* stopReasonName(StopReason reason);
+
+
+struct BlockCacheStats {
+    size_t built = 0;
+    size_t dropped = 0;         // by stores into their code
+    size_t instructions = 0;    // translated
+    size_t elidedFlags = 0;     // CR0 or XER[CA] updates left out as dead
+};
+
+
+// Interprets 32-bit user-level code over a flat memory starting at address
+// zero. Words are decoded once, on first execution, into a 16-byte record
+// holding the address of their handler and the operands that handler needs
+// (register numbers, a pre-shifted immediate, a rotate mask, an absolute
+// branch target); after that each instruction is one indirect jump. The
+// records are kept per 4 KiB page, and a word is decoded again after a
+// store, dcbz, icbi or load() has written over it.
+//
+// Which handler a word gets, and whether it records CR0, sets OV or sets CA,
+// comes from the instruction table: the syntax variant gives Rc/OE/LK/AA
+// and RegisterEffects says whether XER[CA] is written. Floating-point
+// instructions stop with Unimplemented.
+//
+// On top of that sits a block cache (SimulatorBlocks.cpp): a straight-line
+// run of code that branches land on HOT_THRESHOLD times is translated into a
+// chain of handlers specialized for its operands and flags. Blocks are
+// chained to their successors and leave out CR0 and XER[CA] updates that
+// a later instruction of the block overwrites unread (FlagLiveness.h). The
+// updates that remain are kept lazily, as the result or the addition that
+// produced them, and only turned into CR and XER bits when block code reads
+// them or control goes back to the interpreter.
+class PowerPCSimulator {
+public:
+    static constexpr unsigned PAGE_SHIFT = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_SHIFT;
+    // Branching here ends the run with StopReason::Returned; call() puts it
+    // into LR. It lies above any memory the simulator can have.
+    static constexpr uint32_t RETURN_ADDRESS = 0xfffffffc;
+    static constexpr size_t MAX_MEMORY = RETURN_ADDRESS & ~(PAGE_SIZE - 1);
+
+    // `memorySize` is rounded up to a whole page; throws std::length_error
+    // above MAX_MEMORY.
+    explicit PowerPCSimulator(size_t memorySize, Endian endian = Endian::Big);
+    ~PowerPCSimulator();
+
+    PowerPCSimulator(const PowerPCSimulator&) = delete;
+    PowerPCSimulator& operator=(const PowerPCSimulator&) = delete;
+
+    Endian getEndian() const { return endian; }
+    CpuState& state() { return cpu; }
+    const CpuState& state() const { return cpu; }
+    uint8_t* memory() { return bytes.data(); }
+    size_t memorySize() const { return bytes.size(); }
+
+    // Host access to guest memory in target byte order; these throw
+    // std::out_of_range outside memory. load() and write() drop any decoded
+    // code they overwrite.
+    void load(uint32_t address, const void* data, size_t count);
+    uint64_t read(uint32_t address, size_t size) const;
+    void write(uint32_t address, uint64_t value, size_t size);
+
+    // Executes from state().pc until something stops it or `limit`
+    // instructions have run.
+    StopReason run(uint64_t limit = UINT64_MAX);
+    // Runs the function at `entry` until it returns through LR.
+    StopReason call(uint32_t entry, uint64_t limit = UINT64_MAX);
+
+    // Instructions retired over the simulator's lifetime; mftb reads it.
+    uint64_t executed() const { return retired; }
+    uint32_t faultAddress() const { return fault; }
+
+    // Forgets the decoded words overlapping [address, address + count).
+    void invalidate(uint32_t address, size_t count);
+
+    // Without the block cache everything is interpreted; for measuring.
+    void setBlockCache(bool enabled) { blockCache = enabled; }
+    const BlockCacheStats& blockStats() const { return stats; }
+
+private:
+    friend struct BlockOps;
+    struct MicroOp;
+    struct Block;
+
+    static constexpr uint16_t HOT_THRESHOLD = 16;
+
+    struct DecodedOp {
+        const void* handler;
+        int32_t imm;
+        uint8_t d;
+        uint8_t a;
+        uint8_t b;
+        uint8_t flags;
+    };
+
+    struct CodePage {
+        // One record per word and a last one that moves on to the next page.
+        std::array<DecodedOp, PAGE_SIZE / 4 + 1> ops;
+        // Per word: the block starting there and how often a branch landed
+        // there while it had none.
+        std::array<Block*, PAGE_SIZE / 4> blocks{};
+        std::array<uint16_t, PAGE_SIZE / 4> heat{};
+        std::vector<std::unique_ptr<Block>> owned;
+    };
+
+    CodePage* page(uint32_t address);
+    void reset(CodePage& code);
+    void translate(uint32_t address, DecodedOp& op) const;
+
+    Block* buildBlock(uint32_t address, CodePage& code);
+    // Runs `block` and the blocks it chains to while the budget lasts.
+    // Returns false on a memory fault, with cpu.pc and `fault` set;
+    // otherwise `next` is where the interpreter takes over.
+    bool runBlocks(Block* block, uint64_t& remaining, uint32_t& next);
+    Block* follow(Block& from, uint32_t target);
+    void dropBlocks(CodePage& code, uint32_t begin, uint32_t end);
+
+    bool inside(uint32_t address, size_t size) const {
+        return address < bytes.size() && size <= bytes.size() - address;
+    }
+    // Drops decoded code under a guest store; cheap when nothing there has
+    // been executed.
+    void stored(uint32_t address, size_t size) {
+        if (pages[address >> PAGE_SHIFT] || pages[(address + size - 1) >> PAGE_SHIFT]) {
+            invalidate(address, size);
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    std::vector<std::unique_ptr<CodePage>> pages;
+    CpuState cpu;
+    Endian endian;
+    bool swap;
+    uint64_t retired = 0;
+    uint32_t fault = 0;
+    // Handler addresses of run(), filled in on its first call.
+    const void* const* handlers = nullptr;
+
+    bool blockCache = true;
+    // Set when a store drops a block, so the running one stops after it.
+    bool blockDropped = false;
+    // Bumped whenever a block is dropped; links made before are stale.
+    uint64_t epoch = 0;
+    const Block* activeBlock = nullptr;
+    // Dropped blocks live until run() returns, as one may still be running.
+    std::vector<std::unique_ptr<Block>> graveyard;
+    BlockCacheStats stats;
+
+    // CR0 and XER[CA] as block code last recorded them, not yet in `cpu`.
+    struct LazyFlags {
+        bool cr0 = false;
+        bool ca = false;
+        // CR0 compares `result` with zero and copies XER[SO] as it was then.
+        uint32_t result = 0;
+        uint32_t so = 0;
+        // XER[CA] is the carry out of x + y + carryIn.
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t carryIn = 0;
+    };
+    LazyFlags lazy;
+};
+
+
+#endif //PPCASM_POWERPCSIMULATOR_H
@@ -0,0 +1,132 @@
+#ifndef PPCASM_POWERPCSYNTAX_H
+#define PPCASM_POWERPCSYNTAX_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include "PowerPCInstruction.h"
+#include "PowerPCInstructionTable.h"
+#include "PowerPCOperand.h"
+
+
+// Operand matching programs compiled from the syntax strings of the
+// instruction table. A program lists, for each written operand, the operand
+// kinds it accepts and the encoding fields its value goes to, so binding
+// operands is one loop over a table entry picked by instruction id and
+// variant, whatever the instruction.
+namespace syntax {
+
+inline constexpr size_t MAX_OPERANDS = 5;
+
+struct OperandSlot {
+    uint8_t accepts = 0;                        // bit set of OperandKind
+    OperandKind expected = OperandKind::GPR;    // named in diagnostics
+    int8_t field = -1;                          // index into encoding.fields
+    int8_t second = -1;                         // base of d(rA), or the copy in "rS|rB"
+};
+
+struct OperandProgram {
+    uint8_t count = 0;
+    std::array<OperandSlot, MAX_OPERANDS> slots{};
+};
+
+constexpr uint8_t kindBit(OperandKind kind) {
+    return static_cast<uint8_t>(1u << static_cast<unsigned>(kind));
+}
+
+inline constexpr uint8_t IMMEDIATE = kindBit(OperandKind::SignedImmediate) | kindBit(OperandKind::UnsignedImmediate);
+
+constexpr OperandSlot slotFor(std::string_view operand) {
+    OperandSlot slot{};
+    if (operand.size() == 2 && operand[0] == 'r') {
+        slot.expected = OperandKind::GPR;
+        slot.accepts = kindBit(OperandKind::GPR);
+    } else if (operand.size() == 3 && operand.substr(0, 2) == "fr") {
+        slot.expected = OperandKind::FPR;
+        slot.accepts = kindBit(OperandKind::FPR);
+    } else if (operand == "crfD" || operand == "crfS") {
+        slot.expected = OperandKind::CRField;
+        slot.accepts = kindBit(OperandKind::CRField);
+    } else if (operand == "SPR" || operand == "TBR") {
+        slot.expected = OperandKind::SPR;
+        slot.accepts = kindBit(OperandKind::SPR) | kindBit(OperandKind::UnsignedImmediate);
+    } else if (operand == "SIMM" || operand == "d") {
+        slot.expected = OperandKind::SignedImmediate;
+        slot.accepts = IMMEDIATE;
+    } else if (operand == "target_addr") {
+        slot.expected = OperandKind::Label;
+        slot.accepts = kindBit(OperandKind::Label) | IMMEDIATE;
+    } else {
+        slot.expected = OperandKind::UnsignedImmediate;
+        slot.accepts = kindBit(OperandKind::UnsignedImmediate);
+    }
+    return slot;
+}
+
+constexpr int8_t fieldOf(const PowerPCInstruction& instr, std::string_view operand) {
+    const int index = instr.encoding.fieldIndex(isa::operandField(operand, instr.form).name);
+    if (index < 0) throw std::logic_error("syntax operand without a field");
+    return static_cast<int8_t>(index);
+}
+
+// "rD,d(rA)" is two operands, the second a Displacement filling d and A;
+// "rA,rS|rB" writes its second operand to both S and B.
+constexpr OperandProgram compile(const PowerPCInstruction& instr, std::string_view text) {
+    OperandProgram program{};
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string_view::npos) end = text.size();
+        const std::string_view operand = text.substr(start, end - start);
+        const size_t paren = operand.find('(');
+        const size_t bar = operand.find('|');
+
+        OperandSlot slot{};
+        if (paren != std::string_view::npos) {
+            slot.expected = OperandKind::Displacement;
+            slot.accepts = kindBit(OperandKind::Displacement);
+            slot.field = fieldOf(instr, operand.substr(0, paren));
+            slot.second = fieldOf(instr, operand.substr(paren + 1, operand.size() - paren - 2));
+        } else if (bar != std::string_view::npos) {
+            slot = slotFor(operand.substr(0, bar));
+            slot.field = fieldOf(instr, operand.substr(0, bar));
+            slot.second = fieldOf(instr, operand.substr(bar + 1));
+        } else {
+            slot = slotFor(operand);
+            slot.field = fieldOf(instr, operand);
+        }
+
+        if (program.count == MAX_OPERANDS) throw std::logic_error("too many operands in syntax string");
+        program.slots[program.count++] = slot;
+        start = end + 1;
+    }
+    return program;
+}
+
+using VariantPrograms = std::array<OperandProgram, 4>;
+
+constexpr std::array<VariantPrograms, INSTRUCTION_COUNT> build() {
+    std::array<VariantPrograms, INSTRUCTION_COUNT> result{};
+    for (size_t id = 0; id < INSTRUCTION_COUNT; id++) {
+        const PowerPCInstruction& instr = isa::TABLE[id];
+        for (size_t i = 0; i < instr.syntax_variants.size(); i++) {
+            result[id][i] = compile(instr, instr.syntax_variants[i].syntax);
+        }
+    }
+    return result;
+}
+
+inline constexpr std::array<VariantPrograms, INSTRUCTION_COUNT> PROGRAMS = build();
+
+}
+
+
+constexpr const syntax::OperandProgram& operandProgram(InstructionId id, size_t variant) {
+    return syntax::PROGRAMS[static_cast<size_t>(id)][variant];
+}
+
+
+#endif //PPCASM_POWERPCSYNTAX_H
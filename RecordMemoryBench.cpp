@@ -0,0 +1,88 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "BenchCorpus.h"
+#include "lexer.h"
+#include "PowerPCDecoder.h"
+#include "PowerPCParser.h"
+
+// Memory per parsed instruction, before and after InstructionRecord, on
+// about 1M generated instructions (the optional argument changes the
+// count). "After" is what parse() returns. "Before" rebuilds the output the
+// parser used to hand out from the same parse: a per-field instruction
+// with its address, label and a pointer to the operands as written, which
+// were copied into an arena.
+
+namespace {
+
+// The per-instruction output of the parser before InstructionRecord.
+struct LegacyInstruction {
+    const PowerPCInstruction* instruction;
+    const PowerPCInstruction::SyntaxVariant* variant;
+    uint32_t line;
+    std::array<int32_t, PowerPCInstruction::Encoding::MAX_FIELDS> operands{};
+    uint32_t address = 0;
+    uint32_t symbol = SymbolTable::NONE;
+    const Operand* operandList = nullptr;
+    uint8_t operandCount = 0;
+};
+
+}
+
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 1000000;
+    const std::string source = "loop:\n" + bench::generateLines(count, bench::LINES, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<InstructionRecord> records;
+    {
+        Lexer lexer(source);
+        SymbolTable symbols;
+        DiagnosticBuffer diagnostics;
+        PowerPCParser parser(lexer, symbols, diagnostics);
+        records = parser.parse();
+    }
+    const double recordTime = bench::seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<LegacyInstruction> legacy;
+    Arena arena;
+    {
+        Lexer lexer(source);
+        SymbolTable symbols;
+        DiagnosticBuffer diagnostics;
+        PowerPCParser parser(lexer, symbols, diagnostics);
+        InstructionRecord record;
+        ParsedInstruction fields;
+        while (parser.next(record)) {
+            LegacyInstruction instruction;
+            if (PowerPCDecoder::decode(record.word, fields)) instruction.operands = fields.operands;
+            instruction.instruction = &record.definition();
+            instruction.variant = &record.syntax();
+            instruction.line = record.line;
+            instruction.address = static_cast<uint32_t>(legacy.size() * 4);
+            instruction.symbol = record.symbol;
+            instruction.operandList = arena.copy(parser.getOperands(), parser.getOperandCount());
+            instruction.operandCount = static_cast<uint8_t>(parser.getOperandCount());
+            legacy.push_back(instruction);
+        }
+    }
+    const double legacyTime = bench::seconds(start);
+
+    const size_t n = records.size();
+    if (n == 0) return 0;
+    const double after = double(records.capacity() * sizeof(InstructionRecord)) / n;
+    const double before = double(legacy.capacity() * sizeof(LegacyInstruction) + arena.bytesReserved()) / n;
+    std::cout << n << " instructions" << std::endl;
+    std::cout << "before: " << sizeof(LegacyInstruction) << " B per instruction + "
+              << double(arena.bytesUsed()) / n << " B of operands = " << before << " B/instr held, "
+              << before * n / 1e6 << " MB (" << legacyTime * 1000 << " ms to build)" << std::endl;
+    std::cout << "after:  " << sizeof(InstructionRecord) << " B per instruction = " << after << " B/instr held, "
+              << after * n / 1e6 << " MB (" << recordTime * 1000 << " ms for parse())" << std::endl;
+    return legacy.size() == n ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "SectionBuffer.h"
+#include <cstring>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SectionBuffer::~SectionBuffer() {
+    release();
+}
+
+SectionBuffer::SectionBuffer(SectionBuffer&& other) noexcept
+        : address(std::exchange(other.address, nullptr)),
+          length(std::exchange(other.length, 0)),
+          reserved(std::exchange(other.reserved, 0)) {}
+
+SectionBuffer& SectionBuffer::operator=(SectionBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        address = std::exchange(other.address, nullptr);
+        length = std::exchange(other.length, 0);
+        reserved = std::exchange(other.reserved, 0);
+    }
+    return *this;
+}
+
+uint8_t* SectionBuffer::extend(size_t count) {
+    if (length + count > reserved) reserve(length + count);
+    uint8_t* start = address + length;
+    length += count;
+    return start;
+}
+
+void SectionBuffer::append(const void* bytes, size_t count) {
+    if (count != 0) std::memcpy(extend(count), bytes, count);
+}
+
+void SectionBuffer::align(size_t alignment) {
+    extend((alignment - length % alignment) % alignment);
+}
+
+// Doubles the mapping at least, so appending stays amortized constant time.
+void SectionBuffer::reserve(size_t count) {
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t wanted = reserved == 0 ? page : reserved * 2;
+    while (wanted < count) wanted *= 2;
+
+    void* mapped = address == nullptr
+            ? ::mmap(nullptr, wanted, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+            : ::mremap(address, reserved, wanted, MREMAP_MAYMOVE);
+    if (mapped == MAP_FAILED) throw std::bad_alloc();
+    address = static_cast<uint8_t*>(mapped);
+    reserved = wanted;
+}
+
+void SectionBuffer::release() {
+    if (address != nullptr) {
+        ::munmap(address, reserved);
+        address = nullptr;
+        length = 0;
+        reserved = 0;
+    }
+}
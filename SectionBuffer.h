@@ -0,0 +1,54 @@
+#ifndef PPCASM_SECTIONBUFFER_H
+#define PPCASM_SECTIONBUFFER_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Output sections an assembler fills.
+enum class SectionId : uint8_t {
+    Text,
+    Data
+};
+
+inline constexpr size_t SECTION_COUNT = 2;
+
+
+// Contents of an output section, in anonymous page-aligned memory. Growing
+// remaps the pages rather than copying them, new bytes read as zero, and the
+// object writer hands the memory to writev() as it is. Move-only.
+class SectionBuffer {
+public:
+    SectionBuffer() = default;
+    ~SectionBuffer();
+
+    SectionBuffer(SectionBuffer&& other) noexcept;
+    SectionBuffer& operator=(SectionBuffer&& other) noexcept;
+    SectionBuffer(const SectionBuffer&) = delete;
+    SectionBuffer& operator=(const SectionBuffer&) = delete;
+
+    // Appends `count` zero bytes and returns where they start. Pointers into
+    // the buffer are invalidated by the next call.
+    uint8_t* extend(size_t count);
+    void append(const void* bytes, size_t count);
+    // Pads with zeros up to a multiple of `alignment`.
+    void align(size_t alignment);
+
+    uint8_t* data() { return address; }
+    const uint8_t* data() const { return address; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    uint8_t operator[](size_t offset) const { return address[offset]; }
+
+private:
+    void reserve(size_t count);
+    void release();
+
+    uint8_t* address = nullptr;
+    size_t length = 0;
+    size_t reserved = 0;
+};
+
+
+#endif //PPCASM_SECTIONBUFFER_H
@@ -0,0 +1,74 @@
+#ifndef PPCASM_SECTIONS_H
+#define PPCASM_SECTIONS_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "PowerPCEncoder.h"
+#include "SectionBuffer.h"
+
+
+// A data value naming a symbol, as in ".long table+8": the `size` bytes at
+// `offset` in `section` hold zero, and the object writer turns the record
+// into a relocation for the symbol's address plus `addend`.
+struct DataRelocation {
+    SectionId section;
+    uint8_t size;
+    uint32_t offset;
+    uint32_t symbol;
+    int32_t addend;
+};
+
+
+// The output sections of one translation unit, all in one byte order. The
+// parser stores data directives here and the assembler the instructions.
+class Sections {
+public:
+    explicit Sections(Endian endian = Endian::Big) : endian(endian) {}
+
+    Endian getEndian() const { return endian; }
+    SectionBuffer& operator[](SectionId id) { return buffers[static_cast<size_t>(id)]; }
+    const SectionBuffer& operator[](SectionId id) const { return buffers[static_cast<size_t>(id)]; }
+
+    void addRelocation(const DataRelocation& relocation) { relocations.push_back(relocation); }
+    const std::vector<DataRelocation>& getRelocations() const { return relocations; }
+
+    // Writes the low `size` bytes of `value` (1, 2, 4 or 8) in target order.
+    void store(uint64_t value, size_t size, uint8_t* out) const {
+        const bool swap = (endian == Endian::Big) != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+        switch (size) {
+            case 1: {
+                out[0] = static_cast<uint8_t>(value);
+                break;
+            }
+            case 2: {
+                auto v = static_cast<uint16_t>(value);
+                if (swap) v = __builtin_bswap16(v);
+                std::memcpy(out, &v, sizeof(v));
+                break;
+            }
+            case 4: {
+                auto v = static_cast<uint32_t>(value);
+                if (swap) v = __builtin_bswap32(v);
+                std::memcpy(out, &v, sizeof(v));
+                break;
+            }
+            default: {
+                if (swap) value = __builtin_bswap64(value);
+                std::memcpy(out, &value, sizeof(value));
+                break;
+            }
+        }
+    }
+
+private:
+    std::array<SectionBuffer, SECTION_COUNT> buffers;
+    std::vector<DataRelocation> relocations;
+    Endian endian;
+};
+
+
+#endif //PPCASM_SECTIONS_H
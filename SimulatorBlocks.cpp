@@ -0,0 +1,570 @@
+#include <algorithm>
+#include "PowerPCSimulator.h"
+#include "FlagLiveness.h"
+#include "PowerPCDecoder.h"
+#include "SimulatorSemantics.h"
+
+using namespace sim;
+
+
+namespace {
+
+enum class Addressing : uint8_t {
+    Absolute,       // d(0)
+    Displacement,   // d(rA)
+    Update,         // d(rA), rA ← EA
+    Indexed         // (rA|0) + rB
+};
+
+// How a bc tests its condition, fixed by BO when the block is translated.
+enum class BranchTest : uint8_t {
+    Always,
+    Count,          // only CTR
+    Condition,      // only a CR bit
+    Both
+};
+
+struct Instruction {
+    uint32_t word;
+    Semantics semantics;
+    ParsedInstruction parsed;
+
+    const PowerPCInstruction& definition() const { return *parsed.instruction; }
+    int32_t operand(std::string_view name) const {
+        const int index = definition().encoding.fieldIndex(name);
+        return index < 0 ? 0 : parsed.operands[index];
+    }
+    unsigned d() const { return word >> 21 & 31; }
+    unsigned a() const { return word >> 16 & 31; }
+    unsigned b() const { return word >> 11 & 31; }
+};
+
+bool isTerminator(Op op) {
+    return op == Op::Branch || op == Op::BranchConditional || op == Op::BranchConditionalToLink ||
+           op == Op::BranchConditionalToCount;
+}
+
+// Whether the instruction can end the block before the next one runs: a
+// load or store may fault, and a store may drop the block. SIMULATOR_OPS
+// lists them together, from LoadByte to StoreStringIndexed.
+bool mayLeaveEarly(Op op) {
+    return op >= Op::LoadByte && op <= Op::StoreStringIndexed;
+}
+
+}
+
+
+// The micro-op handlers. Everything the decoder leaves to run time in the
+// interpreter (which flags to record, whether rA is r0, how BO tests) is a
+// template parameter here.
+struct BlockOps {
+    using MicroOp = PowerPCSimulator::MicroOp;
+    using Exit = MicroOp::Exit;
+
+    static uint32_t address(const PowerPCSimulator& simulator, const MicroOp* op) {
+        return simulator.activeBlock->start + 4u * op->index;
+    }
+
+    static Exit next(PowerPCSimulator& simulator, const MicroOp* op) {
+        return op[1].handler(simulator, op + 1);
+    }
+
+    static Exit fault(PowerPCSimulator& simulator, const MicroOp* op, uint32_t ea) {
+        simulator.fault = ea;
+        return {address(simulator, op), op->index, true};
+    }
+
+    // CR0 and XER[CA] are recorded lazily: Rc keeps the result and XER[SO],
+    // CA the operands of the addition. A reader settles them first.
+    static void record(PowerPCSimulator& simulator, uint32_t value) {
+        PowerPCSimulator::LazyFlags& lazy = simulator.lazy;
+        lazy.cr0 = true;
+        lazy.result = value;
+        lazy.so = summaryOverflow(simulator.cpu);
+    }
+
+    static void carry(PowerPCSimulator& simulator, uint32_t x, uint32_t y, uint32_t carryIn) {
+        PowerPCSimulator::LazyFlags& lazy = simulator.lazy;
+        lazy.ca = true;
+        lazy.x = x;
+        lazy.y = y;
+        lazy.carryIn = carryIn;
+    }
+
+    static void settleRecord(PowerPCSimulator& simulator) {
+        PowerPCSimulator::LazyFlags& lazy = simulator.lazy;
+        if (!lazy.cr0) return;
+        CpuState& cpu = simulator.cpu;
+        cpu.cr = (cpu.cr & 0x0fffffff) | (compareBits(static_cast<int32_t>(lazy.result), 0) | lazy.so) << 28;
+        lazy.cr0 = false;
+    }
+
+    static void settleCarry(PowerPCSimulator& simulator) {
+        PowerPCSimulator::LazyFlags& lazy = simulator.lazy;
+        if (!lazy.ca) return;
+        CpuState& cpu = simulator.cpu;
+        const bool carried = addWithCarry(lazy.x, lazy.y, lazy.carryIn).carry;
+        cpu.xer = carried ? cpu.xer | xer::CA : cpu.xer & ~xer::CA;
+        lazy.ca = false;
+    }
+
+    static void settle(PowerPCSimulator& simulator) {
+        settleRecord(simulator);
+        settleCarry(simulator);
+    }
+
+    template <Op Kind, uint8_t Flags>
+    static Exit arithmetic(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        auto& gpr = cpu.gpr;
+        constexpr bool extended = Kind == Op::AddExtended || Kind == Op::SubtractFromExtended;
+        if constexpr (extended) settleCarry(simulator);
+        const bool complement = Kind == Op::SubtractFrom || Kind == Op::SubtractFromExtended;
+        const uint32_t x = complement ? ~gpr[op->a] : gpr[op->a];
+        const uint32_t y = Kind == Op::AddImmediateCarrying ? static_cast<uint32_t>(op->imm) : gpr[op->b];
+        const uint32_t c = extended ? carryIn(cpu) : Kind == Op::SubtractFrom ? 1 : 0;
+        const Sum sum = addWithCarry(x, y, c);
+        gpr[op->d] = sum.value;
+        // OV and the sticky SO stay eager; CR0 copies the SO set here.
+        if constexpr ((Flags & FLAG_OE) != 0) recordFlags(cpu, FLAG_OE, sum.value, sum.carry, sum.overflow);
+        if constexpr ((Flags & FLAG_CA) != 0) carry(simulator, x, y, c);
+        if constexpr ((Flags & FLAG_RC) != 0) record(simulator, sum.value);
+        return next(simulator, op);
+    }
+
+    template <bool ZeroBase>
+    static Exit addImmediate(PowerPCSimulator& simulator, const MicroOp* op) {
+        auto& gpr = simulator.cpu.gpr;
+        gpr[op->d] = (ZeroBase ? 0 : gpr[op->a]) + static_cast<uint32_t>(op->imm);
+        return next(simulator, op);
+    }
+
+    template <Op Kind, bool Record>
+    static Exit logical(PowerPCSimulator& simulator, const MicroOp* op) {
+        auto& gpr = simulator.cpu.gpr;
+        const uint32_t s = gpr[op->d];
+        const auto imm = static_cast<uint32_t>(op->imm);
+        uint32_t value = 0;
+        if constexpr (Kind == Op::And) value = s & gpr[op->b];
+        if constexpr (Kind == Op::Or) value = s | gpr[op->b];
+        if constexpr (Kind == Op::Xor) value = s ^ gpr[op->b];
+        if constexpr (Kind == Op::AndImmediate) value = s & imm;
+        if constexpr (Kind == Op::OrImmediate) value = s | imm;
+        if constexpr (Kind == Op::XorImmediate) value = s ^ imm;
+        if constexpr (Kind == Op::RotateAndMask) value = rotateLeft(s, op->b) & imm;
+        if constexpr (Kind == Op::ShiftLeft) value = (gpr[op->b] & 32) != 0 ? 0 : s << (gpr[op->b] & 31);
+        if constexpr (Kind == Op::ShiftRight) value = (gpr[op->b] & 32) != 0 ? 0 : s >> (gpr[op->b] & 31);
+        gpr[op->a] = value;
+        if constexpr (Record) record(simulator, value);
+        return next(simulator, op);
+    }
+
+    template <bool Record>
+    static Exit multiplyLow(PowerPCSimulator& simulator, const MicroOp* op) {
+        auto& gpr = simulator.cpu.gpr;
+        gpr[op->d] = gpr[op->a] * gpr[op->b];
+        if constexpr (Record) record(simulator, gpr[op->d]);
+        return next(simulator, op);
+    }
+
+    template <bool Signed, bool Immediate>
+    static Exit compare(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        const uint32_t a = cpu.gpr[op->a];
+        const uint32_t b = Immediate ? static_cast<uint32_t>(op->imm) : cpu.gpr[op->b];
+        const uint32_t bits = Signed ? compareBits(static_cast<int32_t>(a), static_cast<int32_t>(b))
+                                     : compareBits(a, b);
+        if (op->d == 0) simulator.lazy.cr0 = false;
+        setConditionField(cpu, op->d, bits | summaryOverflow(cpu));
+        return next(simulator, op);
+    }
+
+    template <Addressing Mode>
+    static uint32_t effectiveAddress(const PowerPCSimulator& simulator, const MicroOp* op) {
+        const auto& gpr = simulator.cpu.gpr;
+        if constexpr (Mode == Addressing::Absolute) return static_cast<uint32_t>(op->imm);
+        if constexpr (Mode == Addressing::Indexed) return (op->a == 0 ? 0 : gpr[op->a]) + gpr[op->b];
+        return gpr[op->a] + static_cast<uint32_t>(op->imm);
+    }
+
+    template <class T, class Extend, Addressing Mode>
+    static Exit load(PowerPCSimulator& simulator, const MicroOp* op) {
+        const uint32_t ea = effectiveAddress<Mode>(simulator, op);
+        if (!simulator.inside(ea, sizeof(T))) return fault(simulator, op, ea);
+        auto& gpr = simulator.cpu.gpr;
+        gpr[op->d] = static_cast<uint32_t>(static_cast<Extend>(loadAs<T>(simulator.bytes.data() + ea, simulator.swap)));
+        if constexpr (Mode == Addressing::Update) gpr[op->a] = ea;
+        return next(simulator, op);
+    }
+
+    // A store into the block itself drops it; the rest of the block is then
+    // stale, so execution leaves it right after the store.
+    template <class T, Addressing Mode>
+    static Exit store(PowerPCSimulator& simulator, const MicroOp* op) {
+        const uint32_t ea = effectiveAddress<Mode>(simulator, op);
+        if (!simulator.inside(ea, sizeof(T))) return fault(simulator, op, ea);
+        auto& gpr = simulator.cpu.gpr;
+        storeAs<T>(simulator.bytes.data() + ea, static_cast<T>(gpr[op->d]), simulator.swap);
+        if constexpr (Mode == Addressing::Update) gpr[op->a] = ea;
+        simulator.stored(ea, sizeof(T));
+        if (simulator.blockDropped) return {address(simulator, op) + 4, static_cast<uint16_t>(op->index + 1), false};
+        return next(simulator, op);
+    }
+
+    template <Op Kind>
+    static Exit move(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        if constexpr (Kind == Op::MoveToCount) cpu.ctr = cpu.gpr[op->d];
+        if constexpr (Kind == Op::MoveToLink) cpu.lr = cpu.gpr[op->d];
+        if constexpr (Kind == Op::MoveFromCount) cpu.gpr[op->d] = cpu.ctr;
+        if constexpr (Kind == Op::MoveFromLink) cpu.gpr[op->d] = cpu.lr;
+        return next(simulator, op);
+    }
+
+    // Leaves the block before an instruction it does not cover.
+    static Exit fallThrough(PowerPCSimulator&, const MicroOp* op) {
+        return {static_cast<uint32_t>(op->imm), op->index, false};
+    }
+
+    static Exit taken(const MicroOp* op, uint32_t target) {
+        return {target, static_cast<uint16_t>(op->index + 1), false};
+    }
+
+    template <bool Link>
+    static Exit branch(PowerPCSimulator& simulator, const MicroOp* op) {
+        if constexpr (Link) simulator.cpu.lr = address(simulator, op) + 4;
+        return taken(op, static_cast<uint32_t>(op->imm));
+    }
+
+    // BO and BI as in the interpreter: d holds BO, a holds BI.
+    template <BranchTest Test>
+    static bool conditionHolds(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        const unsigned bo = op->d;
+        bool counted = true;
+        bool condition = true;
+        if constexpr (Test == BranchTest::Count || Test == BranchTest::Both) {
+            cpu.ctr--;
+            counted = (cpu.ctr != 0) != ((bo & 2) != 0);
+        }
+        if constexpr (Test == BranchTest::Condition || Test == BranchTest::Both) {
+            if (op->a < 4) settleRecord(simulator);
+            condition = (cpu.cr >> (31 - op->a) & 1) == (bo >> 3 & 1);
+        }
+        return counted && condition;
+    }
+
+    template <BranchTest Test, bool Link>
+    static Exit branchConditional(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        const bool take = conditionHolds<Test>(simulator, op);
+        const uint32_t following = address(simulator, op) + 4;
+        if constexpr (Link) cpu.lr = following;
+        return taken(op, take ? static_cast<uint32_t>(op->imm) : following);
+    }
+
+    template <BranchTest Test, bool Link>
+    static Exit branchToLink(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        const uint32_t target = cpu.lr & ~3u;
+        const bool take = conditionHolds<Test>(simulator, op);
+        const uint32_t following = address(simulator, op) + 4;
+        if constexpr (Link) cpu.lr = following;
+        return taken(op, take ? target : following);
+    }
+
+    // bcctr never decrements CTR.
+    template <BranchTest Test, bool Link>
+    static Exit branchToCount(PowerPCSimulator& simulator, const MicroOp* op) {
+        CpuState& cpu = simulator.cpu;
+        constexpr BranchTest Cond = Test == BranchTest::Condition || Test == BranchTest::Both ? BranchTest::Condition
+                                                                                            : BranchTest::Always;
+        const bool take = conditionHolds<Cond>(simulator, op);
+        const uint32_t following = address(simulator, op) + 4;
+        if constexpr (Link) cpu.lr = following;
+        return taken(op, take ? cpu.ctr & ~3u : following);
+    }
+
+    template <Op Kind>
+    static MicroOp::Handler arithmeticHandler(uint8_t flags) {
+        switch (flags & (FLAG_RC | FLAG_OE | FLAG_CA)) {
+            case 0: return arithmetic<Kind, 0>;
+            case FLAG_RC: return arithmetic<Kind, FLAG_RC>;
+            case FLAG_OE: return arithmetic<Kind, FLAG_OE>;
+            case FLAG_CA: return arithmetic<Kind, FLAG_CA>;
+            case FLAG_RC | FLAG_OE: return arithmetic<Kind, FLAG_RC | FLAG_OE>;
+            case FLAG_RC | FLAG_CA: return arithmetic<Kind, FLAG_RC | FLAG_CA>;
+            case FLAG_OE | FLAG_CA: return arithmetic<Kind, FLAG_OE | FLAG_CA>;
+            default: return arithmetic<Kind, FLAG_RC | FLAG_OE | FLAG_CA>;
+        }
+    }
+
+    template <Op Kind>
+    static MicroOp::Handler logicalHandler(uint8_t flags) {
+        return (flags & FLAG_RC) != 0 ? logical<Kind, true> : logical<Kind, false>;
+    }
+
+    template <class T, class Extend>
+    static MicroOp::Handler loadHandler(Addressing mode) {
+        switch (mode) {
+            case Addressing::Absolute: return load<T, Extend, Addressing::Absolute>;
+            case Addressing::Displacement: return load<T, Extend, Addressing::Displacement>;
+            case Addressing::Update: return load<T, Extend, Addressing::Update>;
+            default: return load<T, Extend, Addressing::Indexed>;
+        }
+    }
+
+    template <class T>
+    static MicroOp::Handler storeHandler(Addressing mode) {
+        switch (mode) {
+            case Addressing::Absolute: return store<T, Addressing::Absolute>;
+            case Addressing::Displacement: return store<T, Addressing::Displacement>;
+            case Addressing::Update: return store<T, Addressing::Update>;
+            default: return store<T, Addressing::Indexed>;
+        }
+    }
+
+    template <template <BranchTest, bool> class Family>
+    static MicroOp::Handler branchHandler(BranchTest test, bool link) {
+        switch (test) {
+            case BranchTest::Always: return link ? Family<BranchTest::Always, true>::get() : Family<BranchTest::Always, false>::get();
+            case BranchTest::Count: return link ? Family<BranchTest::Count, true>::get() : Family<BranchTest::Count, false>::get();
+            case BranchTest::Condition:
+                return link ? Family<BranchTest::Condition, true>::get() : Family<BranchTest::Condition, false>::get();
+            default: return link ? Family<BranchTest::Both, true>::get() : Family<BranchTest::Both, false>::get();
+        }
+    }
+
+    template <BranchTest Test, bool Link>
+    struct Conditional {
+        static MicroOp::Handler get() { return branchConditional<Test, Link>; }
+    };
+    template <BranchTest Test, bool Link>
+    struct ToLink {
+        static MicroOp::Handler get() { return branchToLink<Test, Link>; }
+    };
+    template <BranchTest Test, bool Link>
+    struct ToCount {
+        static MicroOp::Handler get() { return branchToCount<Test, Link>; }
+    };
+
+    // The handler for one instruction with the flags it still has to
+    // record, or nullptr if blocks do not cover it.
+    static MicroOp::Handler select(const Instruction& instruction, uint8_t flags) {
+        const unsigned bo = instruction.d();
+        const BranchTest test = (bo & 20) == 20 ? BranchTest::Always
+                                : (bo & 16) != 0 ? BranchTest::Count
+                                : (bo & 4) != 0 ? BranchTest::Condition
+                                : BranchTest::Both;
+        const bool link = (flags & FLAG_LK) != 0;
+        const Addressing displaced = instruction.a() == 0 ? Addressing::Absolute : Addressing::Displacement;
+
+        switch (instruction.semantics.op) {
+            case Op::Add: return arithmeticHandler<Op::Add>(flags);
+            case Op::AddExtended: return arithmeticHandler<Op::AddExtended>(flags);
+            case Op::SubtractFrom: return arithmeticHandler<Op::SubtractFrom>(flags);
+            case Op::SubtractFromExtended: return arithmeticHandler<Op::SubtractFromExtended>(flags);
+            case Op::AddImmediateCarrying: return arithmeticHandler<Op::AddImmediateCarrying>(flags);
+            case Op::AddImmediate: return instruction.a() == 0 ? addImmediate<true> : addImmediate<false>;
+            case Op::MultiplyLow:
+                if ((flags & FLAG_OE) != 0) return nullptr;
+                return (flags & FLAG_RC) != 0 ? multiplyLow<true> : multiplyLow<false>;
+            case Op::And: return logicalHandler<Op::And>(flags);
+            case Op::Or: return logicalHandler<Op::Or>(flags);
+            case Op::Xor: return logicalHandler<Op::Xor>(flags);
+            case Op::AndImmediate: return logicalHandler<Op::AndImmediate>(flags);
+            case Op::OrImmediate: return logicalHandler<Op::OrImmediate>(flags);
+            case Op::XorImmediate: return logicalHandler<Op::XorImmediate>(flags);
+            case Op::RotateAndMask: return logicalHandler<Op::RotateAndMask>(flags);
+            case Op::ShiftLeft: return logicalHandler<Op::ShiftLeft>(flags);
+            case Op::ShiftRight: return logicalHandler<Op::ShiftRight>(flags);
+            case Op::Compare: return compare<true, false>;
+            case Op::CompareImmediate: return compare<true, true>;
+            case Op::CompareLogical: return compare<false, false>;
+            case Op::CompareLogicalImmediate: return compare<false, true>;
+
+            case Op::LoadByte: return loadHandler<uint8_t, uint8_t>(displaced);
+            case Op::LoadHalf: return loadHandler<uint16_t, uint16_t>(displaced);
+            case Op::LoadHalfAlgebraic: return loadHandler<uint16_t, int16_t>(displaced);
+            case Op::LoadWord: return loadHandler<uint32_t, uint32_t>(displaced);
+            case Op::LoadWordUpdate: return loadHandler<uint32_t, uint32_t>(Addressing::Update);
+            case Op::LoadWordIndexed: return loadHandler<uint32_t, uint32_t>(Addressing::Indexed);
+            case Op::StoreByte: return storeHandler<uint8_t>(displaced);
+            case Op::StoreHalf: return storeHandler<uint16_t>(displaced);
+            case Op::StoreWord: return storeHandler<uint32_t>(displaced);
+            case Op::StoreWordUpdate: return storeHandler<uint32_t>(Addressing::Update);
+            case Op::StoreWordIndexed: return storeHandler<uint32_t>(Addressing::Indexed);
+
+            case Op::MoveToXer:
+            case Op::MoveFromXer:
+                switch (instruction.operand("SPR")) {
+                    case 8: return instruction.semantics.op == Op::MoveToXer ? move<Op::MoveToLink> : move<Op::MoveFromLink>;
+                    case 9: return instruction.semantics.op == Op::MoveToXer ? move<Op::MoveToCount> : move<Op::MoveFromCount>;
+                    default: return nullptr;
+                }
+
+            case Op::Branch: return link ? branch<true> : branch<false>;
+            case Op::BranchConditional: return branchHandler<Conditional>(test, link);
+            case Op::BranchConditionalToLink: return branchHandler<ToLink>(test, link);
+            case Op::BranchConditionalToCount: return branchHandler<ToCount>(test, link);
+            default: return nullptr;
+        }
+    }
+
+    // Operand fields of the micro-op; the immediate forms match the
+    // interpreter's DecodedOp.
+    static MicroOp operands(const Instruction& instruction, uint32_t address, uint8_t index) {
+        const PowerPCInstruction& definition = instruction.definition();
+        const bool absolute = instruction.parsed.variant->aa;
+        MicroOp op{nullptr, 0, static_cast<uint8_t>(instruction.d()), static_cast<uint8_t>(instruction.a()),
+                   static_cast<uint8_t>(instruction.b()), index};
+        switch (definition.form) {
+            case InstructionForm::D:
+                op.imm = static_cast<int32_t>(static_cast<uint32_t>(instruction.operand("SIMM") |
+                                                                    instruction.operand("UIMM") |
+                                                                    instruction.operand("d"))
+                                              << instruction.semantics.detail);
+                if (definition.encoding.fieldIndex("crfD") >= 0) op.d = static_cast<uint8_t>(instruction.operand("crfD"));
+                break;
+            case InstructionForm::I:
+                op.imm = static_cast<int32_t>((absolute ? 0 : address) + instruction.operand("LI"));
+                break;
+            case InstructionForm::B:
+                op.imm = static_cast<int32_t>((absolute ? 0 : address) + instruction.operand("BD"));
+                break;
+            case InstructionForm::M:
+                op.imm = static_cast<int32_t>(rotateMask(instruction.operand("MB"), instruction.operand("ME")));
+                break;
+            default:
+                if (definition.encoding.fieldIndex("crfD") >= 0) op.d = static_cast<uint8_t>(instruction.operand("crfD"));
+                break;
+        }
+        return op;
+    }
+};
+
+
+// Decodes up to the first branch, the end of the page, MAX_LENGTH
+// instructions or an instruction blocks do not cover. Liveness runs
+// backwards from the end of the block, where every flag counts as live, as
+// it does before an instruction that may leave the block early.
+PowerPCSimulator::Block* PowerPCSimulator::buildBlock(uint32_t address, CodePage& code) {
+    const uint32_t pageEnd = (address | (PAGE_SIZE - 1)) + 1;
+    std::vector<Instruction> instructions;
+    uint32_t pc = address;
+    while (pc < pageEnd && instructions.size() < Block::MAX_LENGTH) {
+        Instruction instruction{};
+        instruction.word = loadAs<uint32_t>(bytes.data() + pc, swap);
+        if (!PowerPCDecoder::decode(instruction.word, instruction.parsed)) break;
+        instruction.semantics = SEMANTICS[instruction.parsed.instruction - isa::TABLE];
+        instructions.push_back(instruction);
+        pc += 4;
+        if (isTerminator(instruction.semantics.op)) break;
+    }
+
+    // The block ends before the first instruction it cannot run. Whether it
+    // can does not depend on the flags left out, as OE is never left out.
+    std::vector<uint8_t> flags(instructions.size());
+    std::vector<FlagEffects> effects;
+    size_t count = 0;
+    for (const Instruction& instruction : instructions) {
+        const PowerPCInstruction::SyntaxVariant& variant = *instruction.parsed.variant;
+        flags[count] = static_cast<uint8_t>((variant.rc ? FLAG_RC : 0) | (variant.oe ? FLAG_OE : 0) |
+                                            (instruction.definition().effects.xer_ca ? FLAG_CA : 0) |
+                                            (variant.lk ? FLAG_LK : 0));
+        if (BlockOps::select(instruction, flags[count]) == nullptr) break;
+        effects.push_back(flagEffects(instruction.definition(), variant, instruction.word));
+        if (mayLeaveEarly(instruction.semantics.op)) effects.back().uses |= flags::ALL;
+        count++;
+    }
+    const std::vector<FlagSet> live = liveFlags(effects);
+
+    std::vector<MicroOp> ops(count);
+    for (size_t i = 0; i < count; i++) {
+        if ((flags[i] & FLAG_RC) != 0 && (live[i] & flags::crField(0)) == 0) {
+            flags[i] &= ~FLAG_RC;
+            stats.elidedFlags++;
+        }
+        if ((flags[i] & FLAG_CA) != 0 && (live[i] & flags::CA) == 0) {
+            flags[i] &= ~FLAG_CA;
+            stats.elidedFlags++;
+        }
+        ops[i] = BlockOps::operands(instructions[i], address + 4 * static_cast<uint32_t>(i), static_cast<uint8_t>(i));
+        ops[i].handler = BlockOps::select(instructions[i], flags[i]);
+    }
+    if (count == 0) return nullptr;
+
+    auto block = std::make_unique<Block>();
+    block->start = address;
+    block->length = static_cast<uint32_t>(count);
+    block->ops = std::move(ops);
+    if (!isTerminator(instructions[count - 1].semantics.op) || count < instructions.size()) {
+        const uint32_t following = address + 4 * static_cast<uint32_t>(count);
+        block->ops.push_back(MicroOp{BlockOps::fallThrough, static_cast<int32_t>(following), 0, 0, 0,
+                                     static_cast<uint8_t>(count)});
+    }
+
+    stats.built++;
+    stats.instructions += count;
+    Block* raw = block.get();
+    code.blocks[(address & (PAGE_SIZE - 1)) >> 2] = raw;
+    code.owned.push_back(std::move(block));
+    return raw;
+}
+
+
+bool PowerPCSimulator::runBlocks(Block* block, uint64_t& remaining, uint32_t& next) {
+    do {
+        activeBlock = block;
+        blockDropped = false;
+        const MicroOp::Exit exit = block->ops[0].handler(*this, block->ops.data());
+        remaining -= exit.retired;
+        if (exit.fault) {
+            BlockOps::settle(*this);
+            cpu.pc = exit.pc;
+            return false;
+        }
+        next = exit.pc;
+        block = follow(*block, next);
+    } while (block != nullptr && block->length <= remaining);
+    // The interpreter, and whoever called run(), see only `cpu`.
+    BlockOps::settle(*this);
+    return true;
+}
+
+
+PowerPCSimulator::Block* PowerPCSimulator::follow(Block& from, uint32_t target) {
+    for (const Block::Link& link : from.links) {
+        if (link.block != nullptr && link.target == target && link.epoch == epoch) return link.block;
+    }
+    if ((target & 3) != 0 || !inside(target, 4)) return nullptr;
+    CodePage* code = pages[target >> PAGE_SHIFT].get();
+    Block* found = code == nullptr ? nullptr : code->blocks[(target & (PAGE_SIZE - 1)) >> 2];
+    if (found != nullptr) {
+        Block::Link& slot = from.links[0].epoch == epoch && from.links[0].block != nullptr ? from.links[1]
+                                                                                            : from.links[0];
+        slot = Block::Link{target, found, epoch};
+    }
+    return found;
+}
+
+
+void PowerPCSimulator::dropBlocks(CodePage& code, uint32_t begin, uint32_t end) {
+    auto& owned = code.owned;
+    for (size_t i = 0; i < owned.size();) {
+        Block& block = *owned[i];
+        if (block.start >= end || block.start + 4 * block.length <= begin) {
+            i++;
+            continue;
+        }
+        const size_t index = (block.start & (PAGE_SIZE - 1)) >> 2;
+        code.blocks[index] = nullptr;
+        code.heat[index] = 0;
+        graveyard.push_back(std::move(owned[i]));
+        owned[i] = std::move(owned.back());
+        owned.pop_back();
+        stats.dropped++;
+        epoch++;
+        blockDropped = true;
+    }
+}
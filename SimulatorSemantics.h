@@ -0,0 +1,337 @@
+#ifndef PPCASM_SIMULATORSEMANTICS_H
+#define PPCASM_SIMULATORSEMANTICS_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "PowerPCInstructionTable.h"
+#include "PowerPCSimulator.h"
+
+// What the simulator's handlers compute, shared by the interpreter in
+// PowerPCSimulator.cpp and the block translator in SimulatorBlocks.cpp.
+
+namespace sim {
+
+// Every handler of run(), in the order of its label table.
+#define SIMULATOR_OPS(X) \
+    X(Decode) X(NextPage) X(Illegal) X(Unimplemented) \
+    X(Add) X(AddExtended) X(AddImmediate) X(AddImmediateCarrying) X(AddMinusOne) X(AddZero) \
+    X(SubtractFrom) X(SubtractFromExtended) X(SubtractFromImmediate) X(SubtractFromMinusOne) \
+    X(SubtractFromZero) X(Negate) X(MultiplyLow) X(MultiplyLowImmediate) X(MultiplyHigh) \
+    X(MultiplyHighUnsigned) X(Divide) X(DivideUnsigned) \
+    X(Compare) X(CompareImmediate) X(CompareLogical) X(CompareLogicalImmediate) \
+    X(And) X(AndComplement) X(AndImmediate) X(CountLeadingZeros) X(Equivalent) X(ExtendSignByte) \
+    X(ExtendSignHalf) X(Nand) X(Nor) X(Or) X(OrComplement) X(OrImmediate) X(Xor) X(XorImmediate) \
+    X(RotateInsert) X(RotateAndMask) X(RotateRegisterAndMask) \
+    X(ShiftLeft) X(ShiftRight) X(ShiftRightAlgebraic) X(ShiftRightAlgebraicImmediate) \
+    X(LoadByte) X(LoadByteUpdate) X(LoadByteIndexed) X(LoadByteUpdateIndexed) \
+    X(LoadHalf) X(LoadHalfUpdate) X(LoadHalfIndexed) X(LoadHalfUpdateIndexed) \
+    X(LoadHalfAlgebraic) X(LoadHalfAlgebraicUpdate) X(LoadHalfAlgebraicIndexed) X(LoadHalfAlgebraicUpdateIndexed) \
+    X(LoadWord) X(LoadWordUpdate) X(LoadWordIndexed) X(LoadWordUpdateIndexed) \
+    X(StoreByte) X(StoreByteUpdate) X(StoreByteIndexed) X(StoreByteUpdateIndexed) \
+    X(StoreHalf) X(StoreHalfUpdate) X(StoreHalfIndexed) X(StoreHalfUpdateIndexed) \
+    X(StoreWord) X(StoreWordUpdate) X(StoreWordIndexed) X(StoreWordUpdateIndexed) \
+    X(LoadHalfReversed) X(LoadWordReversed) X(StoreHalfReversed) X(StoreWordReversed) \
+    X(LoadReserve) X(StoreConditional) X(LoadMultiple) X(StoreMultiple) \
+    X(LoadStringImmediate) X(LoadStringIndexed) X(StoreStringImmediate) X(StoreStringIndexed) \
+    X(Branch) X(BranchConditional) X(BranchConditionalToCount) X(BranchConditionalToLink) X(SystemCall) \
+    X(ConditionLogical) X(MoveConditionField) X(Trap) X(TrapImmediate) \
+    X(MoveConditionFromXer) X(MoveFromCondition) X(MoveToConditionFields) \
+    X(MoveFromXer) X(MoveFromLink) X(MoveFromCount) X(MoveToXer) X(MoveToLink) X(MoveToCount) \
+    X(MoveFromTimeBase) X(MoveFromTimeBaseUpper) X(Nop) X(ZeroBlock) X(InvalidateBlock)
+
+#define SIMULATOR_OP_ENUM(name) name,
+enum class Op : uint8_t {
+    SIMULATOR_OPS(SIMULATOR_OP_ENUM)
+};
+#undef SIMULATOR_OP_ENUM
+
+enum OpFlags : uint8_t {
+    FLAG_RC = 1 << 0,   // record CR0
+    FLAG_OE = 1 << 1,   // record XER[OV] and XER[SO]
+    FLAG_CA = 1 << 2,   // record XER[CA]
+    FLAG_LK = 1 << 3    // write LR
+};
+
+// What an instruction table entry executes as. `detail` is the shift applied
+// to the immediate (16 for addis, oris, ...) or, for the CR logical
+// instructions, the result for each (crbA, crbB) pair as a 4-bit table.
+struct Semantics {
+    Op op = Op::Unimplemented;
+    uint8_t detail = 0;
+};
+
+constexpr Semantics semanticsOf(std::string_view m) {
+    if (m == "add" || m == "addc") return {Op::Add};
+    if (m == "adde") return {Op::AddExtended};
+    if (m == "addi") return {Op::AddImmediate};
+    if (m == "addis") return {Op::AddImmediate, 16};
+    if (m == "addic" || m == "addic.") return {Op::AddImmediateCarrying};
+    if (m == "addme") return {Op::AddMinusOne};
+    if (m == "addze") return {Op::AddZero};
+    if (m == "subf" || m == "subfc") return {Op::SubtractFrom};
+    if (m == "subfe") return {Op::SubtractFromExtended};
+    if (m == "subfic") return {Op::SubtractFromImmediate};
+    if (m == "subfme") return {Op::SubtractFromMinusOne};
+    if (m == "subfze") return {Op::SubtractFromZero};
+    if (m == "neg") return {Op::Negate};
+    if (m == "mullw") return {Op::MultiplyLow};
+    if (m == "mulli") return {Op::MultiplyLowImmediate};
+    if (m == "mulhw") return {Op::MultiplyHigh};
+    if (m == "mulhwu") return {Op::MultiplyHighUnsigned};
+    if (m == "divw") return {Op::Divide};
+    if (m == "divwu") return {Op::DivideUnsigned};
+
+    if (m == "cmp") return {Op::Compare};
+    if (m == "cmpi") return {Op::CompareImmediate};
+    if (m == "cmpl") return {Op::CompareLogical};
+    if (m == "cmpli") return {Op::CompareLogicalImmediate};
+
+    if (m == "and") return {Op::And};
+    if (m == "andc") return {Op::AndComplement};
+    if (m == "andi.") return {Op::AndImmediate};
+    if (m == "andis.") return {Op::AndImmediate, 16};
+    if (m == "cntlzw") return {Op::CountLeadingZeros};
+    if (m == "eqv") return {Op::Equivalent};
+    if (m == "extsb") return {Op::ExtendSignByte};
+    if (m == "extsh") return {Op::ExtendSignHalf};
+    if (m == "nand") return {Op::Nand};
+    if (m == "nor") return {Op::Nor};
+    if (m == "or") return {Op::Or};
+    if (m == "orc") return {Op::OrComplement};
+    if (m == "ori") return {Op::OrImmediate};
+    if (m == "oris") return {Op::OrImmediate, 16};
+    if (m == "xor") return {Op::Xor};
+    if (m == "xori") return {Op::XorImmediate};
+    if (m == "xoris") return {Op::XorImmediate, 16};
+
+    if (m == "rlwimi") return {Op::RotateInsert};
+    if (m == "rlwinm") return {Op::RotateAndMask};
+    if (m == "rlwnm") return {Op::RotateRegisterAndMask};
+    if (m == "slw") return {Op::ShiftLeft};
+    if (m == "srw") return {Op::ShiftRight};
+    if (m == "sraw") return {Op::ShiftRightAlgebraic};
+    if (m == "srawi") return {Op::ShiftRightAlgebraicImmediate};
+
+    if (m == "lbz") return {Op::LoadByte};
+    if (m == "lbzu") return {Op::LoadByteUpdate};
+    if (m == "lbzx") return {Op::LoadByteIndexed};
+    if (m == "lbzux") return {Op::LoadByteUpdateIndexed};
+    if (m == "lhz") return {Op::LoadHalf};
+    if (m == "lhzu") return {Op::LoadHalfUpdate};
+    if (m == "lhzx") return {Op::LoadHalfIndexed};
+    if (m == "lhzux") return {Op::LoadHalfUpdateIndexed};
+    if (m == "lha") return {Op::LoadHalfAlgebraic};
+    if (m == "lhau") return {Op::LoadHalfAlgebraicUpdate};
+    if (m == "lhax") return {Op::LoadHalfAlgebraicIndexed};
+    if (m == "lhaux") return {Op::LoadHalfAlgebraicUpdateIndexed};
+    if (m == "lwz") return {Op::LoadWord};
+    if (m == "lwzu") return {Op::LoadWordUpdate};
+    if (m == "lwzx") return {Op::LoadWordIndexed};
+    if (m == "lwzux") return {Op::LoadWordUpdateIndexed};
+    if (m == "stb") return {Op::StoreByte};
+    if (m == "stbu") return {Op::StoreByteUpdate};
+    if (m == "stbx") return {Op::StoreByteIndexed};
+    if (m == "stbux") return {Op::StoreByteUpdateIndexed};
+    if (m == "sth") return {Op::StoreHalf};
+    if (m == "sthu") return {Op::StoreHalfUpdate};
+    if (m == "sthx") return {Op::StoreHalfIndexed};
+    if (m == "sthux") return {Op::StoreHalfUpdateIndexed};
+    if (m == "stw") return {Op::StoreWord};
+    if (m == "stwu") return {Op::StoreWordUpdate};
+    if (m == "stwx") return {Op::StoreWordIndexed};
+    if (m == "stwux") return {Op::StoreWordUpdateIndexed};
+    if (m == "lhbrx") return {Op::LoadHalfReversed};
+    if (m == "lwbrx") return {Op::LoadWordReversed};
+    if (m == "sthbrx") return {Op::StoreHalfReversed};
+    if (m == "stwbrx") return {Op::StoreWordReversed};
+    if (m == "lwarx") return {Op::LoadReserve};
+    if (m == "stwcx.") return {Op::StoreConditional};
+    if (m == "lmw") return {Op::LoadMultiple};
+    if (m == "stmw") return {Op::StoreMultiple};
+    if (m == "lswi") return {Op::LoadStringImmediate};
+    if (m == "lswx") return {Op::LoadStringIndexed};
+    if (m == "stswi") return {Op::StoreStringImmediate};
+    if (m == "stswx") return {Op::StoreStringIndexed};
+
+    if (m == "b") return {Op::Branch};
+    if (m == "bc") return {Op::BranchConditional};
+    if (m == "bcctr") return {Op::BranchConditionalToCount};
+    if (m == "bclr") return {Op::BranchConditionalToLink};
+    if (m == "sc") return {Op::SystemCall};
+
+    //                                           (A,B) = 11 10 01 00
+    if (m == "crand") return {Op::ConditionLogical, 0b1000};
+    if (m == "crandc") return {Op::ConditionLogical, 0b0100};
+    if (m == "creqv") return {Op::ConditionLogical, 0b1001};
+    if (m == "crnand") return {Op::ConditionLogical, 0b0111};
+    if (m == "crnor") return {Op::ConditionLogical, 0b0001};
+    if (m == "cror") return {Op::ConditionLogical, 0b1110};
+    if (m == "crorc") return {Op::ConditionLogical, 0b1101};
+    if (m == "crxor") return {Op::ConditionLogical, 0b0110};
+    if (m == "mcrf") return {Op::MoveConditionField};
+
+    if (m == "tw") return {Op::Trap};
+    if (m == "twi") return {Op::TrapImmediate};
+    if (m == "mcrxr") return {Op::MoveConditionFromXer};
+    if (m == "mfcr") return {Op::MoveFromCondition};
+    if (m == "mtcrf") return {Op::MoveToConditionFields};
+    // The SPR number picks the handler.
+    if (m == "mfspr") return {Op::MoveFromXer};
+    if (m == "mtspr") return {Op::MoveToXer};
+    if (m == "mftb") return {Op::MoveFromTimeBase};
+
+    if (m == "sync" || m == "isync" || m == "eieio" || m == "dcbf" || m == "dcbst" || m == "dcbt" ||
+        m == "dcbtst") {
+        return {Op::Nop};
+    }
+    if (m == "dcbz") return {Op::ZeroBlock};
+    if (m == "icbi") return {Op::InvalidateBlock};
+    return {};
+}
+
+constexpr std::array<Semantics, INSTRUCTION_COUNT> buildSemantics() {
+    std::array<Semantics, INSTRUCTION_COUNT> table{};
+    for (size_t i = 0; i < INSTRUCTION_COUNT; i++) {
+        table[i] = semanticsOf(isa::TABLE[i].primary_mnemonic);
+    }
+    return table;
+}
+
+inline constexpr std::array<Semantics, INSTRUCTION_COUNT> SEMANTICS = buildSemantics();
+
+inline constexpr uint32_t CACHE_BLOCK = 32;
+
+// MASK(mb, me) with bit 0 the most significant; wraps when mb > me.
+constexpr uint32_t rotateMask(unsigned mb, unsigned me) {
+    const uint32_t begin = 0xffffffffu >> mb;
+    const uint32_t end = 0xffffffffu << (31 - me);
+    return mb <= me ? begin & end : begin | end;
+}
+
+inline uint32_t rotateLeft(uint32_t value, unsigned count) {
+    count &= 31;
+    return count == 0 ? value : value << count | value >> (32 - count);
+}
+
+inline uint8_t byteSwap(uint8_t value) { return value; }
+inline uint16_t byteSwap(uint16_t value) { return __builtin_bswap16(value); }
+inline uint32_t byteSwap(uint32_t value) { return __builtin_bswap32(value); }
+
+template <class T>
+inline T loadAs(const uint8_t* bytes, bool swap) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return swap ? byteSwap(value) : value;
+}
+
+template <class T>
+inline void storeAs(uint8_t* bytes, T value, bool swap) {
+    if (swap) value = byteSwap(value);
+    std::memcpy(bytes, &value, sizeof(value));
+}
+
+struct Sum {
+    uint32_t value;
+    bool carry;
+    bool overflow;
+};
+
+// x + y + carry with the carry out of bit 0 and signed overflow, which is
+// what XER[CA] and XER[OV] record for every add and subtract-from.
+inline Sum addWithCarry(uint32_t x, uint32_t y, uint32_t carry) {
+    const uint64_t wide = uint64_t(x) + y + carry;
+    const auto value = static_cast<uint32_t>(wide);
+    return {value, (wide >> 32) != 0, (((x ^ value) & (y ^ value)) >> 31) != 0};
+}
+
+inline uint32_t carryIn(const CpuState& cpu) {
+    return cpu.xer >> 29 & 1;
+}
+
+template <class T>
+inline uint32_t compareBits(T a, T b) {
+    return a < b ? crbit::LT : a > b ? crbit::GT : crbit::EQ;
+}
+
+inline void setConditionField(CpuState& cpu, unsigned field, uint32_t bits) {
+    const unsigned shift = 28 - 4 * field;
+    cpu.cr = (cpu.cr & ~(0xfu << shift)) | bits << shift;
+}
+
+inline uint32_t summaryOverflow(const CpuState& cpu) {
+    return (cpu.xer & xer::SO) != 0 ? crbit::SO : 0;
+}
+
+inline void recordResult(CpuState& cpu, uint32_t value) {
+    cpu.cr = (cpu.cr & 0x0fffffff) |
+             (compareBits(static_cast<int32_t>(value), 0) | summaryOverflow(cpu)) << 28;
+}
+
+// XER and CR0 updates of an arithmetic instruction, in the order the
+// architecture defines them: CR0[SO] sees the SO this instruction sets.
+inline void recordFlags(CpuState& cpu, uint8_t flags, uint32_t value, bool carry, bool overflow) {
+    if ((flags & FLAG_CA) != 0) cpu.xer = carry ? cpu.xer | xer::CA : cpu.xer & ~xer::CA;
+    if ((flags & FLAG_OE) != 0) cpu.xer = overflow ? cpu.xer | xer::OV | xer::SO : cpu.xer & ~xer::OV;
+    if ((flags & FLAG_RC) != 0) recordResult(cpu, value);
+}
+
+// Counts of 32 to 63 fill with the sign. CA is set when a negative value
+// loses one bits.
+inline uint32_t shiftRightAlgebraic(CpuState& cpu, uint32_t value, unsigned count) {
+    const uint32_t lost = count >= 32 ? value : value & ((1u << count) - 1);
+    const bool carry = static_cast<int32_t>(value) < 0 && lost != 0;
+    cpu.xer = carry ? cpu.xer | xer::CA : cpu.xer & ~xer::CA;
+    return static_cast<uint32_t>(static_cast<int32_t>(value) >> (count >= 32 ? 31 : count));
+}
+
+inline bool trapMatches(unsigned to, uint32_t a, uint32_t b) {
+    const auto sa = static_cast<int32_t>(a);
+    const auto sb = static_cast<int32_t>(b);
+    return ((to & 16) != 0 && sa < sb) || ((to & 8) != 0 && sa > sb) || ((to & 4) != 0 && a == b) ||
+           ((to & 2) != 0 && a < b) || ((to & 1) != 0 && a > b);
+}
+
+}
+
+
+// One instruction of a translated block. Each handler ends by calling the
+// next one's, which the compiler turns into a jump; the last one returns
+// where to go on.
+struct PowerPCSimulator::MicroOp {
+    struct Exit {
+        uint32_t pc;
+        uint16_t retired;   // instructions of the block that completed
+        bool fault;
+    };
+    using Handler = Exit (*)(PowerPCSimulator& simulator, const MicroOp* op);
+
+    Handler handler;
+    int32_t imm;
+    uint8_t d;
+    uint8_t a;
+    uint8_t b;
+    uint8_t index;          // of the instruction within its block
+};
+
+struct PowerPCSimulator::Block {
+    static constexpr size_t MAX_LENGTH = 64;
+
+    // Successors already looked up, valid while `epoch` is current.
+    struct Link {
+        uint32_t target;
+        Block* block;
+        uint64_t epoch;
+    };
+
+    uint32_t start;
+    uint32_t length;        // instructions, including a final branch
+    std::array<Link, 2> links{};
+    std::vector<MicroOp> ops;
+};
+
+
+#endif //PPCASM_SIMULATORSEMANTICS_H
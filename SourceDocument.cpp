@@ -0,0 +1,228 @@
+#include "SourceDocument.h"
+#include <algorithm>
+#include <stdexcept>
+#include "lexer.h"
+#include "PowerPCParser.h"
+
+namespace {
+
+// Lexer that notes the labels the parser will try to define: those ahead of
+// the mnemonic or directive of the line. Anything after it is an operand, or
+// dropped with the rest of a malformed line.
+class LabelRecorder final : public TokenSource {
+public:
+    explicit LabelRecorder(std::string_view line) : lexer(line) {}
+
+    bool next(Token& token) override {
+        if (!lexer.next(token)) return false;
+        if (token.getType() == TokenType::INSTRUCTION || token.getType() == TokenType::DIRECTIVE) {
+            statement = true;
+        } else if (token.getType() == TokenType::LABEL && !statement) {
+            std::string_view name = lexer.text(token);
+            name.remove_suffix(1);
+            labels.push_back(name);
+        }
+        return true;
+    }
+
+    std::string_view text(const Token& token) const override { return lexer.text(token); }
+
+    std::vector<std::string_view> labels;
+
+private:
+    Lexer lexer;
+    bool statement = false;
+};
+
+bool contains(const std::vector<uint32_t>& ids, uint32_t id) {
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+}
+
+
+SourceDocument::SourceDocument(std::string source) : text(std::move(source)) {
+    starts.push_back(0);
+    for (size_t p = text.find('\n'); p != std::string::npos; p = text.find('\n', p + 1)) {
+        starts.push_back(static_cast<uint32_t>(p + 1));
+    }
+    lines.resize(starts.size());
+    labelled.resize(starts.size());
+    for (size_t i = 0; i < lines.size(); i++) {
+        parseLine(i, nullptr);
+    }
+}
+
+
+std::string_view SourceDocument::lineText(size_t index) const {
+    return std::string_view(text).substr(starts[index], lineEnd(index) - starts[index]);
+}
+
+
+size_t SourceDocument::lineAt(size_t offset) const {
+    return static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin()) - 1;
+}
+
+
+// Offset of the newline ending the line, or the end of the text.
+size_t SourceDocument::lineEnd(size_t index) const {
+    return index + 1 < starts.size() ? starts[index + 1] - 1 : text.size();
+}
+
+
+LineChange SourceDocument::apply(const TextEdit& edit) {
+    if (edit.offset > text.size() || edit.removed > text.size() - edit.offset) {
+        throw std::out_of_range("edit past the end of the text");
+    }
+
+    const size_t first = lineAt(edit.offset);
+    const size_t last = lineAt(edit.offset + edit.removed);
+    const size_t regionStart = starts[first];
+    const size_t regionEnd = lineEnd(last) - edit.removed + edit.inserted.size();
+    const uint32_t delta = static_cast<uint32_t>(edit.inserted.size() - edit.removed);
+    text.replace(edit.offset, edit.removed, edit.inserted);
+
+    std::vector<uint32_t> touched;
+    for (size_t i = first; i <= last; i++) {
+        release(lines[i], touched);
+    }
+
+    std::vector<uint32_t> fresh{static_cast<uint32_t>(regionStart)};
+    for (size_t p = text.find('\n', regionStart); p < regionEnd; p = text.find('\n', p + 1)) {
+        fresh.push_back(static_cast<uint32_t>(p + 1));
+    }
+
+    const size_t oldCount = last - first + 1;
+    if (fresh.size() > oldCount) {
+        lines.insert(lines.begin() + static_cast<ptrdiff_t>(last + 1), fresh.size() - oldCount, Line{});
+        starts.insert(starts.begin() + static_cast<ptrdiff_t>(last + 1), fresh.size() - oldCount, 0);
+        labelled.insert(labelled.begin() + static_cast<ptrdiff_t>(last + 1), fresh.size() - oldCount, 0);
+    } else if (fresh.size() < oldCount) {
+        lines.erase(lines.begin() + static_cast<ptrdiff_t>(first + fresh.size()),
+                    lines.begin() + static_cast<ptrdiff_t>(last + 1));
+        starts.erase(starts.begin() + static_cast<ptrdiff_t>(first + fresh.size()),
+                     starts.begin() + static_cast<ptrdiff_t>(last + 1));
+        labelled.erase(labelled.begin() + static_cast<ptrdiff_t>(first + fresh.size()),
+                       labelled.begin() + static_cast<ptrdiff_t>(last + 1));
+    }
+    std::copy(fresh.begin(), fresh.end(), starts.begin() + static_cast<ptrdiff_t>(first));
+    // Unsigned wrap-around makes this a subtraction for shrinking edits.
+    for (size_t i = first + fresh.size(); i < starts.size(); i++) {
+        starts[i] += delta;
+    }
+    if (refusals > 0 && fresh.size() != oldCount) {
+        renumberOwners(first + fresh.size(), last, fresh.size() - oldCount);
+    }
+
+    for (size_t i = first; i < first + fresh.size(); i++) {
+        parseLine(i, &touched);
+    }
+
+    LineChange change{first, oldCount, fresh.size(), {}};
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (uint32_t label : touched) {
+        if (conflicts[label] > 0) relabel(label, change);
+    }
+    std::sort(change.relabeled.begin(), change.relabeled.end());
+    change.relabeled.erase(std::unique(change.relabeled.begin(), change.relabeled.end()), change.relabeled.end());
+    return change;
+}
+
+
+// Lexes and parses one line on its own. Labels the line was refused go to
+// `touched`, since the line holding them may come after this one.
+void SourceDocument::parseLine(size_t index, std::vector<uint32_t>* touched) {
+    Line& line = lines[index];
+    line = Line{};
+    scratch.clear();
+
+    LabelRecorder lexer(lineText(index));
+    PowerPCParser parser(lexer, symbols, scratch);
+    while (parser.next(line.instruction)) {
+        std::copy(parser.getOperands(), parser.getOperands() + parser.getOperandCount(), line.operands.begin());
+        line.operandCount = static_cast<uint8_t>(parser.getOperandCount());
+        line.hasInstruction = true;
+    }
+
+    line.diagnostics = scratch.getRecords();
+    for (std::string_view name : lexer.labels) {
+        line.labels.push_back(symbols.find(name));
+    }
+    if (conflicts.size() < symbols.size()) conflicts.resize(symbols.size());
+    for (Diagnostic& diagnostic : line.diagnostics) {
+        if (diagnostic.code != DiagnosticCode::DuplicateSymbol) continue;
+        const uint32_t id = symbols.find(diagnostic.detail);
+        line.labels.erase(std::find(line.labels.begin(), line.labels.end(), id));
+        line.duplicates.push_back(id);
+        // The parser saw only this line, so it names line 1.
+        diagnostic.arg0 = static_cast<int32_t>(owner(index, id) + 1);
+        conflicts[id]++;
+        refusals++;
+        if (touched != nullptr) touched->push_back(id);
+    }
+    labelled[index] = !line.labels.empty() || !line.duplicates.empty();
+}
+
+
+// Takes back what the line defined. Labels it owned that other lines were
+// refused go to `touched`.
+void SourceDocument::release(const Line& line, std::vector<uint32_t>& touched) {
+    for (uint32_t id : line.duplicates) {
+        conflicts[id]--;
+        refusals--;
+    }
+    for (uint32_t id : line.labels) {
+        symbols.undefine(id);
+        if (conflicts[id] > 0) touched.push_back(id);
+    }
+}
+
+
+// Parses every line naming `label` again, in order, so the first one owns it.
+// Only needed around duplicate definitions, so a scan of the whole document
+// is fine, as long as it skips lines without labels cheaply.
+void SourceDocument::relabel(uint32_t label, LineChange& change) {
+    std::vector<size_t> involved;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (labelled[i] && (contains(lines[i].labels, label) || contains(lines[i].duplicates, label))) {
+            involved.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> ignored;
+    for (size_t i : involved) {
+        release(lines[i], ignored);
+    }
+    for (size_t i : involved) {
+        parseLine(i, nullptr);
+        if (i < change.first || i >= change.first + change.inserted) change.relabeled.push_back(i);
+    }
+}
+
+
+// Line before `index` that owns `label`. The first definition wins, so it
+// is the nearest earlier one still listing the label.
+size_t SourceDocument::owner(size_t index, uint32_t label) const {
+    while (index-- > 0) {
+        if (labelled[index] && contains(lines[index].labels, label)) return index;
+    }
+    return 0;
+}
+
+
+// Moves the first-definition line numbers of the lines from `from` on, which
+// still point at lines as they were numbered before the edit, by `shift` when
+// that line came after `last`, the last line the edit replaced. Owners inside
+// the edit were released, and the lines they refused are parsed again.
+void SourceDocument::renumberOwners(size_t from, size_t last, size_t shift) {
+    for (size_t i = from; i < lines.size(); i++) {
+        if (!labelled[i] || lines[i].duplicates.empty()) continue;
+        for (Diagnostic& diagnostic : lines[i].diagnostics) {
+            if (diagnostic.code == DiagnosticCode::DuplicateSymbol && size_t(diagnostic.arg0) > last + 1) {
+                // Unsigned wrap-around again, for edits that remove lines.
+                diagnostic.arg0 = static_cast<int32_t>(size_t(diagnostic.arg0) + shift);
+            }
+        }
+    }
+}
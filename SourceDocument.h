@@ -0,0 +1,104 @@
+#ifndef PPCASM_SOURCEDOCUMENT_H
+#define PPCASM_SOURCEDOCUMENT_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Diagnostics.h"
+#include "InstructionRecord.h"
+#include "PowerPCOperand.h"
+#include "PowerPCSyntax.h"
+#include "SymbolTable.h"
+
+
+// Replace `removed` bytes at `offset` with `inserted`.
+struct TextEdit {
+    size_t offset;
+    size_t removed;
+    std::string_view inserted;
+};
+
+// Lines [first, first + removed) of the old text became [first, first +
+// inserted) of the new one. `relabeled` lists other lines that were parsed
+// again because a label they define, or fail to define, changed hands.
+struct LineChange {
+    size_t first;
+    size_t removed;
+    size_t inserted;
+    std::vector<size_t> relabeled;
+};
+
+
+// Source text kept lexed and parsed across edits, for editors. The lexer
+// starts afresh at every newline, so the tokens of a line depend on its text
+// alone: an edit re-lexes and re-parses only the lines it touches, the token
+// stream is back in step at the next line, and every other line keeps its
+// results. Those results are relative to their line, which is what lets
+// them survive edits above it: tokens, diagnostics and the instruction of a
+// line carry line number 1 and offsets from the start of the line, and the
+// index of the line is its real position. The exception is arg0 of a
+// DuplicateSymbol diagnostic, the real line number of the first definition,
+// which is kept current. Addresses are not assigned and sections are not
+// followed: every line is parsed as if it were in .text.
+//
+// A label belongs to the first line defining it, as in a full parse; later
+// definitions get a DuplicateSymbol diagnostic. Removing or adding one of
+// several definitions re-parses the lines defining that label, so the
+// diagnostics move to where a full parse would put them.
+class SourceDocument {
+public:
+    struct Line {
+        std::vector<uint32_t> labels;        // defined here
+        std::vector<uint32_t> duplicates;    // defined earlier elsewhere
+        bool hasInstruction = false;
+        InstructionRecord instruction{};
+        // As written.
+        std::array<Operand, syntax::MAX_OPERANDS> operands{};
+        uint8_t operandCount = 0;
+        std::vector<Diagnostic> diagnostics;
+    };
+
+    explicit SourceDocument(std::string text);
+
+    SourceDocument(const SourceDocument&) = delete;
+    SourceDocument& operator=(const SourceDocument&) = delete;
+
+    // Throws std::out_of_range if the edit reaches past the end of the text.
+    LineChange apply(const TextEdit& edit);
+
+    const std::string& getText() const { return text; }
+    size_t lineCount() const { return lines.size(); }
+    const Line& line(size_t index) const { return lines[index]; }
+    std::string_view lineText(size_t index) const;
+    // Line holding the byte at `offset`.
+    size_t lineAt(size_t offset) const;
+    const SymbolTable& getSymbols() const { return symbols; }
+
+private:
+    size_t lineEnd(size_t index) const;
+    void parseLine(size_t index, std::vector<uint32_t>* touched);
+    void release(const Line& line, std::vector<uint32_t>& touched);
+    void relabel(uint32_t label, LineChange& change);
+    size_t owner(size_t index, uint32_t label) const;
+    void renumberOwners(size_t from, size_t last, size_t shift);
+
+    std::string text;
+    // Kept apart from `lines` so that shifting them after an edit walks a
+    // dense array.
+    std::vector<uint32_t> starts;
+    std::vector<Line> lines;
+    // Whether each line names a label, for the scan in relabel().
+    std::vector<uint8_t> labelled;
+    SymbolTable symbols;
+    // Number of lines refused each label, by symbol id.
+    std::vector<uint32_t> conflicts;
+    size_t refusals = 0;
+    DiagnosticBuffer scratch;
+};
+
+
+#endif //PPCASM_SOURCEDOCUMENT_H
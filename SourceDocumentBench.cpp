@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include "BenchCorpus.h"
+#include "SourceDocument.h"
+
+// Times single-character edits to a generated file of 100k lines (the
+// optional argument changes the count): typing a character and deleting it
+// again at random places, and at the top, middle and end of the file. Also
+// times the full lex and parse the edits save. At the end the edited
+// document is compared with one built from scratch from the same text.
+
+namespace {
+
+// Types a digit at `offset` and takes it out again; the average of the two.
+double typeAt(SourceDocument& document, size_t offset) {
+    const double typed = bench::microseconds([&] { document.apply({offset, 0, "7"}); });
+    const double erased = bench::microseconds([&] { document.apply({offset, 1, ""}); });
+    return (typed + erased) / 2;
+}
+
+bool sameAsFresh(const SourceDocument& document) {
+    SourceDocument fresh(document.getText());
+    if (fresh.lineCount() != document.lineCount()) return false;
+    for (size_t i = 0; i < fresh.lineCount(); i++) {
+        const SourceDocument::Line& a = document.line(i);
+        const SourceDocument::Line& b = fresh.line(i);
+        if (a.hasInstruction != b.hasInstruction || a.instruction.word != b.instruction.word ||
+            a.labels != b.labels || a.diagnostics.size() != b.diagnostics.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 100000;
+    const std::string text = bench::generateLines(count);
+
+    const double full = bench::best([&] { SourceDocument scratch(text); }, 3);
+    std::cout << count << " lines, " << text.size() << " bytes; full lex+parse " << full * 1000 << " ms" << std::endl;
+
+    SourceDocument document(text);
+    std::mt19937 rng(7);
+    constexpr int EDITS = 2000;
+    double total = 0;
+    for (int edit = 0; edit < EDITS; edit++) {
+        total += typeAt(document, rng() % document.getText().size());
+    }
+    std::cout << "random single-character edits: " << total / EDITS << " us average" << std::endl;
+
+    // Offsets inside an instruction line near each place.
+    const size_t size = document.getText().size();
+    const struct {
+        const char* name;
+        size_t offset;
+    } PLACES[] = {{"top", 20}, {"middle", document.getText().find('\n', size / 2) + 8}, {"end", size - 4}};
+    for (const auto& place : PLACES) {
+        double best = 0;
+        for (int run = 0; run < 50; run++) {
+            const double time = typeAt(document, place.offset);
+            best = run == 0 ? time : std::min(best, time);
+        }
+        std::cout << "edit at the " << place.name << ": " << best << " us" << std::endl;
+    }
+
+    if (!sameAsFresh(document)) {
+        std::cout << "edited document differs from a fresh parse" << std::endl;
+        return 1;
+    }
+    return 0;
+}
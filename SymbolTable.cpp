@@ -0,0 +1,73 @@
+#include "SymbolTable.h"
+#include "PerfectHash.h"
+
+static constexpr size_t INITIAL_SLOTS = 256;
+
+static uint32_t hashName(std::string_view name) {
+    return static_cast<uint32_t>(perfect_hash::hash(name));
+}
+
+
+StringInterner::StringInterner() : slots(INITIAL_SLOTS, Slot{0, NONE}) {}
+
+// Index of the slot holding `name`, or of the empty slot where it belongs.
+size_t StringInterner::probe(std::string_view name, uint32_t hash) const {
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].id != NONE) {
+        if (slots[i].hash == hash && names[slots[i].id] == name) break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+uint32_t StringInterner::intern(std::string_view name) {
+    const uint32_t hash = hashName(name);
+    size_t i = probe(name, hash);
+    if (slots[i].id != NONE) return slots[i].id;
+
+    if ((names.size() + 1) * 2 > slots.size()) {
+        grow();
+        i = probe(name, hash);
+    }
+    const auto id = static_cast<uint32_t>(names.size());
+    names.push_back(arena.copy(name));
+    slots[i] = Slot{hash, id};
+    return id;
+}
+
+uint32_t StringInterner::find(std::string_view name) const {
+    return slots[probe(name, hashName(name))].id;
+}
+
+void StringInterner::grow() {
+    std::vector<Slot> old(slots.size() * 2, Slot{0, NONE});
+    old.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == NONE) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].id != NONE) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+
+uint32_t SymbolTable::reference(std::string_view name, uint32_t line) {
+    uint32_t id = names.intern(name);
+    if (id == symbols.size()) {
+        symbols.push_back(Symbol{0, line, false, false, SectionId::Text});
+    }
+    return id;
+}
+
+uint32_t SymbolTable::define(std::string_view name, uint32_t address, uint32_t line, SectionId section) {
+    uint32_t id = reference(name, line);
+    Symbol& symbol = symbols[id];
+    if (symbol.defined) return NONE;
+    symbol.address = address;
+    symbol.line = line;
+    symbol.defined = true;
+    symbol.section = section;
+    return id;
+}
@@ -0,0 +1,78 @@
+#ifndef PPCASM_SYMBOLTABLE_H
+#define PPCASM_SYMBOLTABLE_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+#include "SectionBuffer.h"
+
+
+// Maps names to dense ids. The hash table is open-addressed with linear
+// probing over (hash, id) pairs, kept at most half full, and the names are
+// copied into an arena, so interning a name costs no allocation of its own
+// and the names outlive the source buffer they came from.
+class StringInterner {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    StringInterner();
+
+    uint32_t intern(std::string_view name);
+    uint32_t find(std::string_view name) const;
+    std::string_view name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;
+    };
+
+    size_t probe(std::string_view name, uint32_t hash) const;
+    void grow();
+
+    std::vector<Slot> slots;
+    std::vector<std::string_view> names;
+    Arena arena;
+};
+
+
+struct Symbol {
+    uint32_t address;
+    uint32_t line;      // of the definition, or of the first reference
+    bool defined;
+    bool global;
+    SectionId section;
+};
+
+
+// Labels of one translation unit. A symbol exists as soon as it is
+// referenced; define() gives it an address.
+class SymbolTable {
+public:
+    static constexpr uint32_t NONE = StringInterner::NONE;
+
+    uint32_t reference(std::string_view name, uint32_t line);
+    // Returns NONE, leaving the symbol as it was, if it already has an address.
+    uint32_t define(std::string_view name, uint32_t address, uint32_t line, SectionId section = SectionId::Text);
+    void markGlobal(uint32_t id) { symbols[id].global = true; }
+    // Forgets the address, as when the line defining the label is edited.
+    void undefine(uint32_t id) { symbols[id].defined = false; }
+    // Gives a defined symbol a new address, as when code before it shrinks.
+    void move(uint32_t id, uint32_t address) { symbols[id].address = address; }
+
+    uint32_t find(std::string_view name) const { return names.find(name); }
+    const Symbol& at(uint32_t id) const { return symbols[id]; }
+    std::string_view name(uint32_t id) const { return names.name(id); }
+    size_t size() const { return symbols.size(); }
+
+private:
+    StringInterner names;
+    std::vector<Symbol> symbols;
+};
+
+
+#endif //PPCASM_SYMBOLTABLE_H
@@ -0,0 +1,51 @@
+#ifndef PPCASM_THREADPOOL_H
+#define PPCASM_THREADPOOL_H
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size pool of worker threads fed from a single FIFO queue.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    template <class F>
+    std::future<std::invoke_result_t<F>> submit(F task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    // Runs body(0) .. body(count - 1) on the pool and the calling thread and
+    // returns once all of them have finished. Exceptions are rethrown.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+};
+
+
+#endif //PPCASM_THREADPOOL_H
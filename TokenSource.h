@@ -0,0 +1,45 @@
+#ifndef PPCASM_TOKENSOURCE_H
+#define PPCASM_TOKENSOURCE_H
+
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "token.h"
+
+
+// Pull interface between the lexers and the parser. text() must work for
+// every token of the line most recently returned by next(); consumers that
+// keep text longer copy it.
+class TokenSource {
+public:
+    virtual ~TokenSource() = default;
+
+    // Produces the next token. Returns false at the end of input.
+    virtual bool next(Token& token) = 0;
+    virtual std::string_view text(const Token& token) const = 0;
+};
+
+
+// Replays an already materialized token vector.
+class TokenVector final : public TokenSource {
+public:
+    TokenVector(const std::vector<Token>& tokens, std::string_view source)
+            : tokens(tokens), source(source), position(0) {}
+
+    bool next(Token& token) override {
+        if (position >= tokens.size()) return false;
+        token = tokens[position++];
+        return true;
+    }
+
+    std::string_view text(const Token& token) const override { return token.getValue(source); }
+
+private:
+    const std::vector<Token>& tokens;
+    std::string_view source;
+    size_t position;
+};
+
+
+#endif //PPCASM_TOKENSOURCE_H
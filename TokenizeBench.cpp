@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BenchCorpus.h"
+#include "lexer.h"
+#include "ThreadPool.h"
+
+// Tokenizes one input serially and on thread pools of 1, 2, 4, 8 and 16
+// workers, reports the throughput of each, and checks that every pooled
+// run produces exactly the tokens of the serial tokenize(). The input is the
+// file named by the argument, or about 8 MB of generated assembly.
+
+namespace {
+
+bool same(const std::vector<Token>& a, const std::vector<Token>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Token& x, const Token& y) {
+        return x.getType() == y.getType() && x.getOffset() == y.getOffset() && x.getLength() == y.getLength() &&
+               x.getLine() == y.getLine() && x.getColumn() == y.getColumn() && x.getAux() == y.getAux() &&
+               x.getFlags() == y.getFlags();
+    });
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    MappedFile file;
+    std::string generated;
+    std::string_view source;
+    if (argc > 1) {
+        try {
+            file = MappedFile(argv[1]);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        source = file.view();
+    } else {
+        generated = bench::generateBytes(8 << 20);
+        source = generated;
+    }
+    const double megabytes = source.size() / 1e6;
+
+    std::vector<Token> serial;
+    const double serialTime = bench::best([&] { serial = Lexer(source).tokenize(); });
+    std::cout << source.size() << " bytes, " << serial.size() << " tokens, " << std::thread::hardware_concurrency()
+              << " hardware threads" << std::endl;
+    std::cout << "serial: " << serialTime * 1000 << " ms, " << megabytes / serialTime << " MB/s" << std::endl;
+
+    bool mismatch = false;
+    for (unsigned threads : {1, 2, 4, 8, 16}) {
+        ThreadPool pool(threads);
+        std::vector<Token> pooled;
+        const double time = bench::best([&] { pooled = Lexer(source).tokenize(pool); });
+        const bool identical = same(serial, pooled);
+        mismatch = mismatch || !identical;
+        std::cout << threads << (threads == 1 ? " thread: " : " threads: ") << time * 1000 << " ms, "
+                  << megabytes / time << " MB/s, " << serialTime / time << "x serial"
+                  << (identical ? "" : ", TOKENS DIFFER") << std::endl;
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+#ifndef PPCASM_TRIVIASCAN_H
+#define PPCASM_TRIVIASCAN_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+// Classification of source text into whitespace, newlines and comments, 64
+// bytes at a time, in the manner of simdjson's first stage: each class is a
+// bitmask over the block, built with AVX2 or SSE2 compares when the target
+// has them. Lexers skip trivia by finding the first clear bit instead of
+// testing byte after byte. Without vector instructions the blocks are
+// built with a byte loop and the scanner walks bytes as lexers used to. Header-only so
+// that the standalone NFA lexer can use it too.
+namespace trivia {
+
+constexpr size_t BLOCK_SIZE = 64;
+#if defined(__AVX2__) || defined(__SSE2__)
+constexpr bool VECTOR = true;
+#else
+constexpr bool VECTOR = false;
+#endif
+
+// Bit i describes byte i of the block.
+struct Block {
+    uint64_t space;     // ' ', \t, \v, \f, \r
+    uint64_t newline;
+    uint64_t comment;   // from a '#' up to the newline that ends it
+};
+
+
+inline void classifyBytes(const char* p, uint64_t& space, uint64_t& newline, uint64_t& hash) {
+#if defined(__AVX2__)
+    for (size_t half = 0; half < 2; half++) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * half));
+        // \t..\r are 9..13; subtracting 9 brings them to 0..4.
+        const __m256i control = _mm256_sub_epi8(bytes, _mm256_set1_epi8(9));
+        const __m256i lowControl = _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8(4)), control);
+        const __m256i blank = _mm256_or_si256(lowControl, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')));
+        const auto shift = static_cast<unsigned>(32 * half);
+        space |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(blank))) << shift;
+        newline |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))))) << shift;
+        hash |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('#'))))) << shift;
+    }
+    space &= ~newline;
+#elif defined(__SSE2__)
+    for (size_t quarter = 0; quarter < 4; quarter++) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * quarter));
+        const __m128i control = _mm_sub_epi8(bytes, _mm_set1_epi8(9));
+        const __m128i lowControl = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(4)), control);
+        const __m128i blank = _mm_or_si128(lowControl, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+        const auto shift = static_cast<unsigned>(16 * quarter);
+        space |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(blank))) << shift;
+        newline |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))))) << shift;
+        hash |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('#'))))) << shift;
+    }
+    space &= ~newline;
+#else
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        const auto c = static_cast<unsigned char>(p[i]);
+        space |= uint64_t(c == ' ' || (c >= '\t' && c <= '\r' && c != '\n')) << i;
+        newline |= uint64_t(c == '\n') << i;
+        hash |= uint64_t(c == '#') << i;
+    }
+#endif
+}
+
+
+// Classifies the `n` bytes at `p`, at most a block; missing bytes count as
+// neither trivia nor newline. `inComment` says whether a comment is still
+// open from the block before.
+inline Block classify(const char* p, size_t n, bool inComment) {
+    char padded[BLOCK_SIZE];
+    if (n < BLOCK_SIZE) {
+        std::memset(padded, 0, sizeof(padded));
+        std::memcpy(padded, p, n);
+        p = padded;
+    }
+
+    Block block{0, 0, 0};
+    uint64_t hashes = 0;
+    classifyBytes(p, block.space, block.newline, hashes);
+
+    // Each '#' outside a comment opens one that runs to the next newline, or
+    // past the block. One step per comment, not per byte.
+    if (inComment) {
+        const uint64_t end = block.newline & (0 - block.newline);
+        block.comment = end != 0 ? end - 1 : ~uint64_t(0);
+        hashes &= ~block.comment;
+    }
+    while (hashes != 0) {
+        const uint64_t start = hashes & (0 - hashes);
+        const uint64_t after = block.newline & (0 - start);
+        const uint64_t span = after != 0 ? (after & (0 - after)) - start : 0 - start;
+        block.comment |= span;
+        hashes &= ~span;
+    }
+    return block;
+}
+
+
+// Walks a buffer block by block, keeping the block it is in. The position
+// handed to skip() must not be inside a comment, which holds for a lexer
+// that always skips comments whole.
+class Scanner {
+public:
+    Scanner() = default;
+    explicit Scanner(std::string_view text) : text(text) {}
+
+    void reset(std::string_view newText) {
+        text = newText;
+        base = NONE;
+    }
+
+    // The first byte at or after `pos` that is neither whitespace nor in a
+    // comment: a newline, the start of a token, or the end of the text.
+    size_t skip(size_t pos) {
+        // Most gaps between tokens are empty or a single blank; only longer
+        // runs and comments are worth a look at the block.
+        if (pos < text.size() && !isTrivia(text[pos])) return pos;
+        if (pos + 1 < text.size() && text[pos] != '#' && !isTrivia(text[pos + 1])) return pos + 1;
+        // Classifying a block byte by byte costs more than it saves.
+        if constexpr (!VECTOR) return skipBytes(pos);
+
+        while (pos < text.size()) {
+            const size_t start = pos - pos % BLOCK_SIZE;
+            if (start != base) {
+                const bool inComment = start == base + BLOCK_SIZE && (block.comment >> 63) != 0;
+                const size_t n = text.size() - start < BLOCK_SIZE ? text.size() - start : BLOCK_SIZE;
+                block = classify(text.data() + start, n, inComment);
+                base = start;
+            }
+            const uint64_t stops = ~(block.space | block.comment) & (~uint64_t(0) << (pos - start));
+            if (stops != 0) {
+                const size_t found = start + static_cast<size_t>(__builtin_ctzll(stops));
+                return found < text.size() ? found : text.size();
+            }
+            pos = start + BLOCK_SIZE;
+        }
+        return text.size();
+    }
+
+private:
+    static constexpr size_t NONE = SIZE_MAX - BLOCK_SIZE;
+
+    static bool isTrivia(char c) {
+        return c == ' ' || c == '#' || (c >= '\t' && c <= '\r' && c != '\n');
+    }
+
+    size_t skipBytes(size_t pos) const {
+        while (pos < text.size() && text[pos] != '\n' && isTrivia(text[pos])) {
+            if (text[pos] == '#') {
+                while (pos < text.size() && text[pos] != '\n') pos++;
+            } else {
+                pos++;
+            }
+        }
+        return pos;
+    }
+
+    std::string_view text;
+    size_t base = NONE;
+    Block block{0, 0, 0};
+};
+
+
+// Offset just past the last newline in the `n` bytes at `p`, or 0 if there
+// is none. Reads whole blocks from the end.
+inline size_t afterLastNewline(const char* p, size_t n) {
+    size_t end = n;
+    while (end != 0) {
+        const size_t start = end > BLOCK_SIZE ? end - BLOCK_SIZE : 0;
+        uint64_t space = 0, newline = 0, hash = 0;
+        if (end - start == BLOCK_SIZE) {
+            classifyBytes(p + start, space, newline, hash);
+        } else {
+            newline = classify(p + start, end - start, false).newline;
+        }
+        if (newline != 0) return start + 64 - static_cast<size_t>(__builtin_clzll(newline));
+        end = start;
+    }
+    return 0;
+}
+
+}
+
+
+#endif //PPCASM_TRIVIASCAN_H
@@ -1,110 +1,339 @@
 #include "lexer.h"
+#include "ThreadPool.h"
+#include "PowerPCKeywords.h"
+#include "NumberLiteral.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
+#include <utility>
+#include <unistd.h>
+
+namespace {
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+inline bool isIdentStart(char c) { return isAlpha(c) || c == '_'; }
+inline bool isWordChar(char c) { return isIdentStart(c) || isDigit(c) || c == '.'; }
 
-Lexer::Lexer(const std::string& source)
-        : source(source), pos(0), line(1), column(1) {
-    initializePatterns();
 }
 
-void Lexer::initializePatterns() {
+Lexer::Lexer(std::string_view source)
+        : source(source), pos(0), line(1), column(1), scanner(source) {
+    if (source.length() > Token::MAX_OFFSET) {
+        throw std::runtime_error("Source is too large to tokenize");
+    }
+}
 
-    tokenPatterns.push_back({std::regex("^r[0-9]+"), TokenType::REGISTER});
-    tokenPatterns.push_back({std::regex("^cr[0-7]"), TokenType::REGISTER});
-    tokenPatterns.push_back({std::regex("^lr"), TokenType::REGISTER});
-    tokenPatterns.push_back({std::regex("^ctr"), TokenType::REGISTER});
-    tokenPatterns.push_back({std::regex("^xer"), TokenType::REGISTER});
+Lexer::Lexer(MappedFile file)
+        : mapping(std::move(file)), source(mapping.view()), pos(0), line(1), column(1), scanner(source) {
+    if (source.length() > Token::MAX_OFFSET) {
+        throw std::runtime_error("Source is too large to tokenize");
+    }
+}
 
+std::vector<Token> Lexer::tokenize() {
+    std::vector<Token> tokens;
+    tokens.reserve(source.length() / 4 + 16);
 
-    tokenPatterns.push_back({std::regex("^0[xX][0-9a-fA-F]+"), TokenType::NUMBER});
-    tokenPatterns.push_back({std::regex("^[+-]?[0-9]+"), TokenType::NUMBER});
+    Token token;
+    while (next(token)) {
+        tokens.push_back(token);
+    }
 
+    tokens.push_back(endOfInput());
+    return tokens;
+}
 
-    tokenPatterns.push_back({std::regex("^addi?"), TokenType::INSTRUCTION});
-    tokenPatterns.push_back({std::regex("^lwz"), TokenType::INSTRUCTION});
-    tokenPatterns.push_back({std::regex("^stw"), TokenType::INSTRUCTION});
-    tokenPatterns.push_back({std::regex("^b(l?r?)"), TokenType::INSTRUCTION});
-    tokenPatterns.push_back({std::regex("^cmp"), TokenType::INSTRUCTION});
-    tokenPatterns.push_back({std::regex("^m[tf]lr"), TokenType::INSTRUCTION});
+// Splits the remaining input after newlines and lexes the pieces on the pool.
+// The lexer state resets at every newline, so each piece can be lexed on its
+// own; offsets are already absolute and only line numbers need to be shifted
+// by the number of lines in the pieces before it. The result is identical to
+// tokenize().
+std::vector<Token> Lexer::tokenize(ThreadPool& pool) {
+    static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
 
+    const size_t remaining = source.length() - pos;
+    const size_t wanted = std::min<size_t>(size_t(pool.size()) * 4, remaining / MIN_CHUNK_SIZE);
+    if (wanted <= 1) {
+        return tokenize();
+    }
 
+    std::vector<size_t> bounds{pos};
+    for (size_t k = 1; k < wanted; k++) {
+        size_t split = std::max(pos + remaining / wanted * k, bounds.back());
+        size_t newline = source.find('\n', split);
+        if (newline == std::string_view::npos) break;
+        if (newline + 1 > bounds.back()) bounds.push_back(newline + 1);
+    }
+    if (bounds.back() != source.length()) bounds.push_back(source.length());
 
-    tokenPatterns.push_back({std::regex("^\\.[a-zA-Z]+"), TokenType::DIRECTIVE});
+    struct Chunk {
+        std::vector<Token> tokens;
+        size_t endLine;
+        size_t endColumn;
+        size_t lineBase;
+    };
+    const size_t chunkCount = bounds.size() - 1;
+    std::vector<Chunk> chunks(chunkCount);
 
+    pool.parallelFor(chunkCount, [&](size_t k) {
+        Lexer piece(source.substr(0, bounds[k + 1]));
+        piece.pos = bounds[k];
+        if (k == 0) {
+            piece.line = line;
+            piece.column = column;
+        }
 
-    tokenPatterns.push_back({std::regex("^[a-zA-Z_][a-zA-Z0-9_]*:"), TokenType::LABEL});
+        Chunk& chunk = chunks[k];
+        chunk.tokens.reserve((bounds[k + 1] - bounds[k]) / 4 + 16);
+        Token token;
+        while (piece.next(token)) {
+            chunk.tokens.push_back(token);
+        }
+        chunk.endLine = piece.line;
+        chunk.endColumn = piece.column;
+    });
 
+    size_t total = 0;
+    for (size_t k = 0; k < chunkCount; k++) {
+        chunks[k].lineBase = k == 0 ? 0 : chunks[k - 1].lineBase + chunks[k - 1].endLine - 1;
+        total += chunks[k].tokens.size();
+    }
+
+    std::vector<Token> tokens(total);
+    std::vector<size_t> starts(chunkCount, 0);
+    for (size_t k = 1; k < chunkCount; k++) {
+        starts[k] = starts[k - 1] + chunks[k - 1].tokens.size();
+    }
 
-    tokenPatterns.push_back({std::regex("^,"), TokenType::COMMA});
-    tokenPatterns.push_back({std::regex("^\\("), TokenType::LPAREN});
-    tokenPatterns.push_back({std::regex("^\\)"), TokenType::RPAREN});
-    tokenPatterns.push_back({std::regex("^\\+"), TokenType::PLUS});
-    tokenPatterns.push_back({std::regex("^-"), TokenType::MINUS});
-    tokenPatterns.push_back({std::regex("^:"), TokenType::COLON});
+    pool.parallelFor(chunkCount, [&](size_t k) {
+        const Chunk& chunk = chunks[k];
+        Token* out = tokens.data() + starts[k];
+        for (const Token& token : chunk.tokens) {
+            *out++ = token.relocated(token.getOffset(), token.getLine() + chunk.lineBase);
+        }
+    });
+
+    const Chunk& last = chunks.back();
+    pos = source.length();
+    line = last.endLine + last.lineBase;
+    column = last.endColumn;
+
+    tokens.push_back(endOfInput());
+    return tokens;
 }
 
-std::vector<Token> Lexer::tokenize() {
-    std::vector<Token> tokens;
+bool Lexer::next(Token& token) {
+    skipWhitespaceAndComments();
+    if (pos >= source.length()) return false;
 
-    while (pos < source.length()) {
-        skipWhitespaceAndComments();
-        if (pos >= source.length()) break;
+    if (source[pos] == '\n') {
+        token = Token(TokenType::EOL, pos, 1, line, column);
+        pos++;
+        line++;
+        column = 1;
+        return true;
+    }
 
-        Token token(TokenType::UNKNOWN, "", line, column);
-        if (tryMatchPattern(token)) {
-            tokens.push_back(token);
-        } else {
+    if (!tryMatchPattern(token)) {
 
-            std::string value(1, source[pos]);
-            tokens.emplace_back(TokenType::UNKNOWN, value, line, column);
-            pos++;
-            column++;
-        }
+        token = Token(TokenType::UNKNOWN, pos, 1, line, column);
+        pos++;
+        column++;
     }
+    return true;
+}
 
-    tokens.emplace_back(TokenType::EOL, "", line, column);
-    return tokens;
+Token Lexer::endOfInput() const {
+    return Token(TokenType::EOL, pos, 0, line, column);
+}
+
+// Points the lexer at the next chunk of a stream. Chunks always start at the
+// beginning of a line, so only the line counter carries over.
+void Lexer::reset(std::string_view window) {
+    source = window;
+    scanner.reset(window);
+    pos = 0;
+    column = 1;
 }
 
+// Stops at a newline, which next() turns into an EOL token. The scanner
+// finds the stop in the classification of the current 64-byte block.
 void Lexer::skipWhitespaceAndComments() {
-    while (pos < source.length()) {
-        if (isspace(source[pos])) {
-            if (source[pos] == '\n') {
-                line++;
-                column = 1;
-            } else {
-                column++;
-            }
-            pos++;
-        } else if (source[pos] == '#') {
-
-            while (pos < source.length() && source[pos] != '\n') {
-                pos++;
-                column++;
-            }
+    const size_t stop = scanner.skip(pos);
+    column += stop - pos;
+    pos = stop;
+}
+
+bool Lexer::tryMatchPattern(Token& token) {
+    TokenType type = TokenType::UNKNOWN;
+    uint16_t aux = 0;
+    uint8_t flags = 0;
+    size_t length = matchLength(type, aux, flags);
+    if (length == 0) {
+        return false;
+    }
+
+    if (length > Token::MAX_LENGTH) {
+        throw std::runtime_error("Token too long at line " + std::to_string(line));
+    }
+
+    token = Token(type, pos, length, line, column, aux, flags);
+    pos += length;
+    column += length;
+    return true;
+}
+
+// Single-pass scanner. Words are read as a whole and classified with one
+// perfect-hash lookup instead of being matched against each mnemonic:
+//
+//   [+-]?(0[xX][0-9a-fA-F]+|0[bB][01]+|[0-9]+)  NUMBER
+//   [a-zA-Z_][a-zA-Z0-9_.]*:                    LABEL
+//   [a-zA-Z_][a-zA-Z0-9_.]*                     INSTRUCTION, REGISTER or IDENTIFIER
+//   \.[a-zA-Z][a-zA-Z0-9_.]*                    DIRECTIVE
+//   , ( ) + - :                                 punctuation
+//
+// Every rule looks at a fixed number of bytes or consumes the run it scans,
+// so each byte is examined a constant number of times. Numbers are
+// converted as they are scanned, see NumberLiteral.h.
+size_t Lexer::matchLength(TokenType& type, uint16_t& aux, uint8_t& flags) {
+    const char* p = source.data() + pos;
+    const size_t n = source.length() - pos;
+    auto at = [p, n](size_t i) { return i < n ? p[i] : '\0'; };
+    auto run = [p, n](size_t i, bool (*pred)(char)) {
+        while (i < n && pred(p[i])) i++;
+        return i;
+    };
+
+    const char c = p[0];
+
+    type = TokenType::NUMBER;
+    if (isDigit(c) || ((c == '+' || c == '-') && isDigit(at(1)))) {
+        NumberValue value{};
+        NumberStatus status = NumberStatus::Ok;
+        const size_t length = number::scan(std::string_view(p, n), value, status);
+        if (status == NumberStatus::Ok && value.magnitude <= UINT16_MAX) {
+            aux = static_cast<uint16_t>(value.magnitude);
+            flags = Token::NUMBER_KNOWN;
+        }
+        if (value.negative) flags |= Token::NUMBER_NEGATIVE;
+        return length;
+    }
+
+    if (isIdentStart(c)) {
+        size_t length = run(1, isWordChar);
+        if (at(length) == ':') {
+            type = TokenType::LABEL;
+            return length + 1;
+        }
+
+        int keyword = findKeyword(std::string_view(p, length));
+        if (keyword < 0) {
+            type = TokenType::IDENTIFIER;
         } else {
-            break;
+            type = keywordAt(keyword).kind == KeywordKind::Mnemonic ? TokenType::INSTRUCTION : TokenType::REGISTER;
+            aux = static_cast<uint16_t>(keyword);
         }
+        return length;
     }
-}
 
-bool Lexer::tryMatchPattern(Token& token) {
-    std::string remaining = source.substr(pos);
-    std::smatch match;
+    type = TokenType::DIRECTIVE;
+    if (c == '.' && isAlpha(at(1))) return run(1, isWordChar);
 
-    for (const auto& pattern : tokenPatterns) {
-        if (std::regex_search(remaining, match, pattern.pattern,
-                              std::regex_constants::match_continuous)) {
-            std::string value = match.str();
-            token = Token(pattern.type, value, line, column);
+    switch (c) {
+        case ',': type = TokenType::COMMA; return 1;
+        case '(': type = TokenType::LPAREN; return 1;
+        case ')': type = TokenType::RPAREN; return 1;
+        case '+': type = TokenType::PLUS; return 1;
+        case '-': type = TokenType::MINUS; return 1;
+        case ':': type = TokenType::COLON; return 1;
+        default: break;
+    }
 
+    type = TokenType::UNKNOWN;
+    return 0;
+}
 
-            pos += value.length();
-            column += value.length();
+StreamLexer::StreamLexer(std::istream& in, size_t chunkSize)
+        : in(&in), fd(-1), buffer(chunkSize == 0 ? 1 : chunkSize), filled(0), windowEnd(0),
+          bufferBase(0), eof(false), done(false), lexer(std::string_view()) {}
 
+StreamLexer::StreamLexer(int fd, size_t chunkSize)
+        : in(nullptr), fd(fd), buffer(chunkSize == 0 ? 1 : chunkSize), filled(0), windowEnd(0),
+          bufferBase(0), eof(false), done(false), lexer(std::string_view()) {}
+
+bool StreamLexer::next(Token& token) {
+    if (done) return false;
+
+    while (!lexer.next(token)) {
+        if (!refill()) {
+            Token end = lexer.endOfInput();
+            token = Token(TokenType::EOL, bufferBase, 0, end.getLine(), end.getColumn());
+            done = true;
             return true;
         }
     }
 
-    return false;
+    token = token.relocated(bufferBase + token.getOffset(), token.getLine());
+    return true;
+}
+
+std::string_view StreamLexer::text(const Token& token) const {
+    uint32_t offset = static_cast<uint32_t>(token.getOffset()) - static_cast<uint32_t>(bufferBase);
+    return std::string_view(buffer.data() + offset, token.getLength());
+}
+
+// Moves the unlexed tail of the buffer to the front, reads up to a full
+// buffer and hands everything up to the last newline to the lexer.
+bool StreamLexer::refill() {
+    size_t carry = filled - windowEnd;
+    std::memmove(buffer.data(), buffer.data() + windowEnd, carry);
+    bufferBase += windowEnd;
+    filled = carry;
+    windowEnd = 0;
+
+    size_t cut = 0;
+    size_t searchFrom = carry;
+    while (true) {
+        while (!eof && filled < buffer.size()) {
+            size_t count = readSome(buffer.data() + filled, buffer.size() - filled);
+            if (count == 0) eof = true;
+            filled += count;
+        }
+
+        const size_t last = trivia::afterLastNewline(buffer.data() + searchFrom, filled - searchFrom);
+        if (last != 0) cut = searchFrom + last;
+
+        if (cut != 0) break;
+        if (eof) {
+            cut = filled;
+            break;
+        }
+
+        searchFrom = filled;
+        buffer.resize(buffer.size() * 2);
+    }
+
+    if (cut == 0) return false;
+
+    windowEnd = cut;
+    lexer.reset(std::string_view(buffer.data(), cut));
+    return true;
+}
+
+size_t StreamLexer::readSome(char* dst, size_t count) {
+    if (in != nullptr) {
+        in->read(dst, static_cast<std::streamsize>(count));
+        return static_cast<size_t>(in->gcount());
+    }
+
+    while (true) {
+        ssize_t n = ::read(fd, dst, count);
+        if (n >= 0) return static_cast<size_t>(n);
+        if (errno != EINTR) {
+            throw std::runtime_error(std::string("Read failed: ") + std::strerror(errno));
+        }
+    }
 }
@@ -4,29 +4,87 @@
 
 #include <vector>
 #include <string>
-#include <regex>
+#include <string_view>
+#include <istream>
 #include "token.h"
+#include "TokenSource.h"
+#include "MappedFile.h"
+#include "TriviaScan.h"
 
-class Lexer {
+class ThreadPool;
+
+// The lexer does not copy its input: tokens refer to `source` by offset, so
+// the buffer must stay alive as long as the tokens are in use. A lexer built
+// from a MappedFile owns the mapping itself. Every newline becomes an EOL
+// token, and tokenize() ends with one more at the end of the input.
+class Lexer final : public TokenSource {
 public:
-    Lexer(const std::string& source);
+    Lexer(std::string_view source);
+    Lexer(std::string&&) = delete;
+    explicit Lexer(MappedFile file);
+
     std::vector<Token> tokenize();
+    std::vector<Token> tokenize(ThreadPool& pool);
+    bool next(Token& token) override;
+    std::string_view text(const Token& token) const override { return token.getValue(source); }
+    Token endOfInput() const;
+
+    std::string_view getSource() const { return source; }
 
 private:
-    struct TokenPattern {
-        std::regex pattern;
-        TokenType type;
-    };
+    friend class StreamLexer;
 
-    void initializePatterns();
+    void reset(std::string_view window);
     void skipWhitespaceAndComments();
     bool tryMatchPattern(Token& token);
+    size_t matchLength(TokenType& type, uint16_t& aux, uint8_t& flags);
 
-    const std::string source;
+    MappedFile mapping;
+    std::string_view source;
     size_t pos;
     size_t line;
     size_t column;
-    std::vector<TokenPattern> tokenPatterns;
+    trivia::Scanner scanner;
+};
+
+
+// Tokenizes an istream or file descriptor in chunks with bounded memory. The
+// buffer is only ever cut after a newline, and the lexer resets at every
+// newline, so the tokens (with their line, column and absolute offset) are
+// the same as Lexer::tokenize() over the whole input. The buffer grows only
+// if a single line is longer than the chunk size. Offsets are stream offsets
+// truncated to 32 bits, which is enough for text() to find the current chunk.
+class StreamLexer final : public TokenSource {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    explicit StreamLexer(std::istream& in, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    explicit StreamLexer(int fd, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    StreamLexer(const StreamLexer&) = delete;
+    StreamLexer& operator=(const StreamLexer&) = delete;
+
+    // Produces the next token; the last one is EOL. Returns false afterwards.
+    bool next(Token& token) override;
+
+    // Text of a token of the current chunk, which always holds the whole
+    // line of the token most recently returned by next(). Tokens from earlier
+    // chunks are no longer backed by the buffer.
+    std::string_view text(const Token& token) const override;
+
+private:
+    bool refill();
+    size_t readSome(char* dst, size_t count);
+
+    std::istream* in;
+    int fd;
+    std::vector<char> buffer;
+    size_t filled;
+    size_t windowEnd;
+    size_t bufferBase;
+    bool eof;
+    bool done;
+    Lexer lexer;
 };
 
 
@@ -1,16 +1,26 @@
+#include <iomanip>
+#include <iostream>
 #include <string>
+#include <stdexcept>
 #include "lexer.h"
-#include "PowerPCInstruction.h"
-#include "PowerPCParser"
+#include "Assembler.h"
+#include "ElfWriter.h"
 
-int main() {
+// With an argument, also writes the demo as a relocatable object there.
+int main(int argc, char** argv) {
 
     std::string sourceCode = R"(
         .text
         .global _start
     _start:
         add r3, r1, r2
-        addi r4, r0, 0x100
+        b next
+    loop:
+        add r4, r4, r3
+        bdnz loop
+    next:
+        beq cr1, loop
+        bl _start
     )";
 
 
@@ -18,14 +28,31 @@ int main() {
     auto tokens = lexer.tokenize();
 
 
-    PowerPCParser parser(tokens);
-    auto instructions = parser.parse();
+    Assembler assembler;
+    size_t errors = assembler.assemble(tokens, sourceCode);
+    assembler.getDiagnostics().print(std::cerr);
 
+    const auto& code = assembler.code();
+    for (size_t offset = 0; offset < code.size(); offset += 4) {
+        uint32_t word = uint32_t(code[offset]) << 24 | uint32_t(code[offset + 1]) << 16 |
+                        uint32_t(code[offset + 2]) << 8 | code[offset + 3];
+        std::cout << std::hex << std::setw(4) << std::setfill('0') << offset << ": 0x" << std::setw(8) << word
+                  << std::dec << std::endl;
+    }
+
+    const auto& symbols = assembler.getSymbols();
+    for (uint32_t id = 0; id < symbols.size(); id++) {
+        std::cout << symbols.name(id) << " = " << symbols.at(id).address << std::endl;
+    }
 
-    for (const auto& instr : instructions) {
-        std::cout << "Parsed instruction: " << instr.primary_mnemonic << std::endl;
-        std::cout << "  " << instr.pseudocode << std::endl;
+    if (argc > 1) {
+        try {
+            ElfWriter().write(assembler, argv[1]);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
     }
 
-    return 0;
-}
\ No newline at end of file
+    return errors == 0 ? 0 : 1;
+}
@@ -1,22 +1,17 @@
 #include "token.h"
 #include <stdexcept>
 
-Token::Token(TokenType type, const std::string& value, size_t line, size_t column)
-        : type(type), value(value), line(line), column(column) {}
-
-TokenType Token::getType() const { return type; }
-const std::string& Token::getValue() const { return value; }
-size_t Token::getLine() const { return line; }
-size_t Token::getColumn() const { return column; }
-
-std::ostream& operator<<(std::ostream& os, const Token& token) {
-    const char* typeNames[] = {
+const char* tokenTypeName(TokenType type) {
+    static const char* const typeNames[] = {
             "INSTRUCTION", "REGISTER", "DIRECTIVE", "LABEL",
-            "NUMBER", "COMMA", "LPAREN", "RPAREN",
+            "IDENTIFIER", "NUMBER", "COMMA", "LPAREN", "RPAREN",
             "PLUS", "MINUS", "COLON", "EOL", "UNKNOWN"
     };
+    return typeNames[static_cast<int>(type)];
+}
 
+std::ostream& operator<<(std::ostream& os, const Token& token) {
     os << "Line " << token.line << ", Col " << token.column << ": "
-       << typeNames[static_cast<int>(token.type)] << " '" << token.value << "'";
+       << tokenTypeName(token.type) << " @" << token.offset << "+" << token.length;
     return os;
 }
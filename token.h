@@ -1,16 +1,18 @@
-
 #ifndef PPCASM_TOKEN_H
 #define PPCASM_TOKEN_H
 
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 #include <ostream>
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     INSTRUCTION,
     REGISTER,
     DIRECTIVE,
     LABEL,
+    IDENTIFIER,
     NUMBER,
     COMMA,
     LPAREN,
@@ -22,23 +24,63 @@ enum class TokenType {
     UNKNOWN
 };
 
+const char* tokenTypeName(TokenType type);
+
+// A token is a view into the source buffer it was lexed from: it stores the
+// byte offset and length of the lexeme, not a copy of it. The buffer must
+// outlive the tokens; getValue() takes it explicitly. Columns past
+// MAX_COLUMN are clamped. `aux` carries what the lexer already knows about
+// the lexeme: the keyword index for INSTRUCTION and REGISTER tokens, and
+// for NUMBER tokens the magnitude when it fits, with NUMBER_KNOWN set in
+// `flags`, so that the parser need not read the digits again.
 class Token {
 public:
-    Token(TokenType type, const std::string& value, size_t line, size_t column);
+    static constexpr size_t MAX_OFFSET = UINT32_MAX;
+    static constexpr size_t MAX_LENGTH = UINT16_MAX;
+    static constexpr size_t MAX_COLUMN = UINT16_MAX;
+
+    static constexpr uint8_t NUMBER_KNOWN = 1 << 0;
+    static constexpr uint8_t NUMBER_NEGATIVE = 1 << 1;
+
+    Token() = default;
+    Token(TokenType type, size_t offset, size_t length, size_t line, size_t column, uint16_t aux = 0,
+          uint8_t flags = 0)
+            : offset(static_cast<uint32_t>(offset)), line(static_cast<uint32_t>(line)),
+              column(static_cast<uint16_t>(column < MAX_COLUMN ? column : MAX_COLUMN)),
+              length(static_cast<uint16_t>(length)), type(type), flags(flags), aux(aux) {}
 
-    TokenType getType() const;
-    const std::string& getValue() const;
-    size_t getLine() const;
-    size_t getColumn() const;
+    TokenType getType() const { return type; }
+    size_t getOffset() const { return offset; }
+    size_t getLength() const { return length; }
+    size_t getLine() const { return line; }
+    size_t getColumn() const { return column; }
+    uint16_t getAux() const { return aux; }
+    uint8_t getFlags() const { return flags; }
+
+    Token relocated(size_t newOffset, size_t newLine) const {
+        Token token = *this;
+        token.offset = static_cast<uint32_t>(newOffset);
+        token.line = static_cast<uint32_t>(newLine);
+        return token;
+    }
+
+    std::string_view getValue(std::string_view source) const {
+        return source.substr(offset, length);
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Token& token);
 
 private:
-    TokenType type;
-    std::string value;
-    size_t line;
-    size_t column;
+    uint32_t offset = 0;
+    uint32_t line = 0;
+    uint16_t column = 0;
+    uint16_t length = 0;
+    TokenType type = TokenType::UNKNOWN;
+    uint8_t flags = 0;
+    uint16_t aux = 0;
 };
 
+static_assert(sizeof(Token) == 16, "Token is meant to stay two words wide");
+
 
 #endif //PPCASM_TOKEN_H